@@ -10,10 +10,36 @@
                 "rpc/mount3_xdr.c",
                 "rpc/nfs3_xdr.c",
                 "src/node_nfsc.cc",
+                "src/node_nfsc_connection.cc",
+                "src/node_nfsc_attrcache.cc",
+                "src/node_nfsc_accesscache.cc",
+                "src/node_nfsc_cachefile.cc",
+                "src/node_nfsc_namecache.cc",
+                "src/node_nfsc_pagecache.cc",
+                "src/node_nfsc_readahead.cc",
+                "src/node_nfsc_writebehind.cc",
                 "src/node_nfsc_errors3.cc",
                 "src/node_nfsc_fattr3.cc",
                 "src/node_nfsc_sattr3.cc",
                 "src/node_nfsc_wcc3.cc",
+                "src/node_nfsc_pool.cc",
+                "src/node_nfsc_resolve.cc",
+                "src/node_nfsc_statpaths.cc",
+                "src/node_nfsc_slab.cc",
+                "src/node_nfsc_zero.cc",
+                "src/node_nfsc_channel.cc",
+                "src/node_nfsc_pipeline.cc",
+                "src/node_nfsc_readfile.cc",
+                "src/node_nfsc_writefile.cc",
+                "src/node_nfsc_transfer.cc",
+                "src/node_nfsc_stream.cc",
+                "src/node_nfsc_copy.cc",
+                "src/node_nfsc_hash.cc",
+                "src/node_nfsc_checksum.cc",
+                "src/node_nfsc_download.cc",
+                "src/node_nfsc_walk.cc",
+                "src/node_nfsc_filter.cc",
+                "src/node_nfsc_removetree.cc",
                 "src/node_nfsc_null3.cc",
                 "src/node_nfsc_mount3.cc",
                 "src/node_nfsc_unmount3.cc",
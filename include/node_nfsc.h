@@ -23,12 +23,19 @@
 #include "mount3.h"
 #include "nfs3.h"
 #include "node_nfsc_port.h"
+#include "node_nfsc_connection.h"
 
-#define NFSC_NOT_MOUNTED "NFSC_NOT_MOUNTED"
-#define NFSC_ALREADY_MOUNTED "NFSC_ALREADY_MOUNTED"
-#define NFSC_UNKNOWN_ERROR "NFSC_UNKNOWN_ERROR"
-#define NFSC_EGETHOSTNAME "NFSC_EGETHOSTNAME"
-#define NFSC_EGETHOSTBYNAME "NFSC_EGETHOSTBYNAME"
+/* client side error codes, see errors/NFSv3.json */
+#define NFSC_NOT_MOUNTED 30001
+#define NFSC_ALREADY_MOUNTED 30002
+#define NFSC_UNKNOWN_ERROR 30003
+#define NFSC_EGETHOSTNAME 30004
+#define NFSC_EGETHOSTBYNAME 30005
+#define NFSC_EINVALIDAUTH 30006
+#define NFSC_ELOOP 30007
+#define NFSC_ECACHEFILE 30008
+#define NFSC_ECANCELED 30009
+#define NFSC_ELOCALWRITE 30010
 #define NFSC_UDP_PACKET_SIZE (1<<16)
 
 namespace NFS {
@@ -54,6 +61,7 @@ public:
 
     static NAN_MODULE_INIT(Init);
 
+    Connection *getConnection();
     CLIENT *getClient();
     void setClient(CLIENT *client_);
     CLIENT *getMountClient();
@@ -70,13 +78,12 @@ public:
     timeval& getTimeout();
     bool isMounted() const;
     void setMounted(bool v = true);
+    /* value is a Client of this JS thread */
+    static bool isInstance(const v8::Local<v8::Value> &value);
 
 private:
-    sem_t sem;
-    CLIENT *client;
-    CLIENT *mntClient;
+    Connection *connection;
     bool mounted;
-    nfs_fh3 *rootFh;
     Nan::Utf8String host;
     Nan::Utf8String exportPath;
     Nan::Utf8String protocol;
@@ -91,7 +98,8 @@ private:
            const v8::Local<v8::Value> &uid_,
            const v8::Local<v8::Value> &gid_,
            const v8::Local<v8::Value> &authenticationMethod_,
-           const v8::Local<v8::Value> &timeout_);
+           const v8::Local<v8::Value> &timeout_,
+           const v8::Local<v8::Value> &options_);
     ~Client() NFSC_OVERRIDE;
 
     static NAN_METHOD(New);
@@ -119,6 +127,31 @@ private:
     static NAN_METHOD(ReadLink3);
     static NAN_METHOD(FsStat3);
 
+    /* local caches */
+    static NAN_METHOD(CachedGetAttr3);
+    static NAN_METHOD(CacheStats);
+    static NAN_METHOD(SaveCache);
+
+    /* compound operations, several RPCs in one threadpool job */
+    static NAN_METHOD(ResolvePath);
+    static NAN_METHOD(StatPaths);
+
+    /* bulk transfers, chunks pipelined over several channels */
+    static NAN_METHOD(ReadFile);
+    static NAN_METHOD(WriteFile);
+    static NAN_METHOD(ReadStream);
+    static NAN_METHOD(Copy);
+    static NAN_METHOD(Checksum);
+    static NAN_METHOD(DownloadToFd);
+
+    /* tree operations, directories listed concurrently */
+    static NAN_METHOD(WalkTree);
+    static NAN_METHOD(RmTree);
+
+    /* write-back */
+    static NAN_METHOD(WriteBehind3);
+    static NAN_METHOD(Flush3);
+
     /*
     static NAN_METHOD(FsInfo);
     static NAN_METHOD(PathConf);
@@ -126,9 +159,7 @@ private:
 
     static NAN_METHOD(Link);
     */
-    static inline Nan::Persistent<v8::Function> & constructor() {
-        static Nan::Persistent<v8::Function> my_constructor;
-        return my_constructor;
-    }
+    /* one per JS thread, the module may be loaded in worker_threads */
+    static Nan::Persistent<v8::Function> &constructor();
 };
 }
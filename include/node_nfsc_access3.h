@@ -28,10 +28,15 @@ namespace NFS {
 
     public:
 
-        Access3Worker(Client *client_,
-                     const v8::Local<v8::Value> &obj_fh_,
-                     const v8::Local<v8::Value> &access_,
-                     Nan::Callback *callback);
+        static const char *poolName() {
+            return "access3";
+        }
+
+        explicit Access3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &obj_fh_,
+                   const v8::Local<v8::Value> &access_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
         clnt_stat xdrProc(ACCESS3args *a, ACCESS3res *r, CLIENT *c) NFSC_OVERRIDE {
@@ -39,6 +44,8 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
+        bool fromCache() NFSC_OVERRIDE;
 
     };
 }
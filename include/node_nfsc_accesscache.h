@@ -0,0 +1,98 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <mutex>
+#include "nfs3.h"
+#include "node_nfsc_cache.h"
+
+/* default lifetime of ACCESS results, in seconds */
+#define NFSC_ACCESS_TIMEOUT 60
+/* maximum number of cached ACCESS results per connection */
+#define NFSC_ACCESS_CACHE_SIZE 65536
+
+namespace NFS {
+
+    /*
+     * ACCESS results keyed by file handle and credentials (uid, gid).
+     *
+     * Results for the bits checked so far are merged in one entry and
+     * expire after a fixed timeout. An entry is dropped as soon as the
+     * attribute cache shows a ctime other than the one seen with the
+     * result, as any change to mode, owner or ACL updates it.
+     */
+    class AccessCache {
+    public:
+        AccessCache();
+
+        /* timeout in seconds, zero disables the cache */
+        void configure(unsigned timeout_);
+        bool isEnabled();
+
+        /*
+         * Rights granted among requested when all of them were checked,
+         * attrs are the fresh attributes of fh when known.
+         */
+        bool get(const nfs_fh3 &fh, uint32_t uid, uint32_t gid,
+                 const fattr3 *attrs, uint32_t requested,
+                 uint32_t *granted);
+        void put(const nfs_fh3 &fh, uint32_t uid, uint32_t gid,
+                 const post_op_attr &attrs, uint32_t requested,
+                 uint32_t granted);
+
+        double getHits() const;
+        double getMisses() const;
+        size_t getSize();
+
+    private:
+        struct Entry {
+            bool hasCtime;
+            nfstime3 ctime;
+            uint32_t checked;
+            uint32_t granted;
+            uint64_t expires;
+        };
+        struct Key {
+            FileHandle fh;
+            uint32_t uid;
+            uint32_t gid;
+
+            bool operator==(const Key &other) const {
+                return uid == other.uid && gid == other.gid &&
+                        fh == other.fh;
+            }
+        };
+        struct KeyHash {
+            size_t operator()(const Key &key) const {
+                return key.fh.getHash() ^
+                        ((uint64_t(key.uid) << 32 | key.gid) *
+                         0x9e3779b97f4a7c15ULL);
+            }
+        };
+
+        std::mutex lock;
+        LruCache<Key, Entry, KeyHash> entries;
+        uint64_t timeout;
+        double hits;
+        double misses;
+
+        AccessCache(const AccessCache &);
+        AccessCache &operator=(const AccessCache &);
+    };
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include "nfs3.h"
+#include "node_nfsc_cache.h"
+
+/* defaults of the Linux client, in seconds */
+#define NFSC_ACREGMIN 3
+#define NFSC_ACREGMAX 60
+#define NFSC_ACDIRMIN 30
+#define NFSC_ACDIRMAX 60
+/* maximum number of cached attributes per connection */
+#define NFSC_ATTR_CACHE_SIZE 65536
+
+namespace NFS {
+
+    /*
+     * File handle to fattr3 cache, fed by every post_op_attr and wcc_data
+     * seen in replies. Attributes with an older ctime than the cached
+     * ones invalidate the entry instead, unless the wcc_data they come
+     * with starts from the cached state.
+     *
+     * Like the Linux client, each entry has its own timeout: it starts
+     * at acregmin (acdirmin for directories), doubles every time the
+     * attributes are refreshed unchanged, up to acregmax (acdirmax), and
+     * falls back to the minimum as soon as they change.
+     */
+    class AttrCache {
+    public:
+        /* entry as kept in the cache file, ttl is its remaining lifetime */
+        struct Saved {
+            FileHandle fh;
+            fattr3 attrs;
+            uint64_t timeo;
+            uint64_t ttl;
+        };
+
+        AttrCache();
+
+        /* timeouts in seconds, a zero maximum disables the cache */
+        void configure(unsigned regmin, unsigned regmax,
+                       unsigned dirmin, unsigned dirmax);
+
+        /* fresh attributes of fh, counted as a hit or a miss */
+        bool get(const nfs_fh3 &fh, fattr3 *attrs);
+
+        void put(const nfs_fh3 &fh, const fattr3 &attrs);
+        void put(const nfs_fh3 &fh, const post_op_attr &attrs);
+        void put(const post_op_fh3 &fh, const post_op_attr &attrs);
+        void put(const nfs_fh3 &fh, const wcc_data &wcc);
+        void invalidate(const nfs_fh3 &fh);
+
+        /* least recently used first, so that restoring keeps the order */
+        void save(std::vector<Saved> *saved);
+        void restore(const Saved &saved);
+
+        double getHits() const;
+        double getMisses() const;
+        size_t getSize();
+
+    private:
+        struct Entry {
+            fattr3 attrs;
+            uint64_t expires;
+            uint64_t timeo;
+        };
+
+        std::mutex lock;
+        LruCache<FileHandle, Entry> entries;
+        uint64_t regmin;
+        uint64_t regmax;
+        uint64_t dirmin;
+        uint64_t dirmax;
+        double hits;
+        double misses;
+
+        /* under lock, follows when attrs are the wcc after of the entry */
+        void store(const FileHandle &key, const fattr3 &attrs, bool follows);
+
+        AttrCache(const AttrCache &);
+        AttrCache &operator=(const AttrCache &);
+    };
+}
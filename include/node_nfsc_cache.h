@@ -0,0 +1,130 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "nfs3.h"
+#include "node_nfsc_fh.h"
+
+namespace NFS {
+
+    /* monotonic clock in nanoseconds, for cache expiry */
+    static inline uint64_t
+    monotonicTime()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+
+    /* cache key of a file handle */
+    static inline FileHandle
+    fhKey(const nfs_fh3 &fh)
+    {
+        return FileHandle(fh);
+    }
+
+    /*
+     * Bounded map that evicts its least recently used entry. Not locked,
+     * the owning cache serializes accesses.
+     */
+    template<typename Key, typename Value,
+             typename Hash = std::hash<Key> >
+    class LruCache {
+        typedef std::list<std::pair<Key, Value> > List;
+        typedef std::unordered_map<Key, typename List::iterator, Hash> Map;
+
+        List order;
+        Map index;
+        size_t capacity;
+
+    public:
+        explicit LruCache(size_t capacity_)
+            : order(), index(), capacity(capacity_) {}
+
+        /* returns NULL when missing, marks the entry as used otherwise */
+        Value *find(const Key &key) {
+            typename Map::iterator it = index.find(key);
+            if (it == index.end())
+                return NULL;
+            order.splice(order.begin(), order, it->second);
+            return &it->second->second;
+        }
+
+        /* returns NULL when missing, leaves the order untouched */
+        const Value *peek(const Key &key) const {
+            typename Map::const_iterator it = index.find(key);
+            return it == index.end() ? NULL : &it->second->second;
+        }
+
+        /* returns the existing or a new value-initialized entry */
+        Value &insert(const Key &key) {
+            Value *value = find(key);
+            if (value)
+                return *value;
+            if (index.size() >= capacity && !order.empty()) {
+                index.erase(order.back().first);
+                order.pop_back();
+            }
+            order.push_front(std::make_pair(key, Value()));
+            index[key] = order.begin();
+            return order.front().second;
+        }
+
+        void erase(const Key &key) {
+            typename Map::iterator it = index.find(key);
+            if (it == index.end())
+                return;
+            order.erase(it->second);
+            index.erase(it);
+        }
+
+        void clear() {
+            index.clear();
+            order.clear();
+        }
+
+        /* change the bound, evicting the least recently used excess */
+        void resize(size_t capacity_) {
+            capacity = capacity_;
+            while (index.size() > capacity) {
+                index.erase(order.back().first);
+                order.pop_back();
+            }
+        }
+
+        size_t size() const {
+            return index.size();
+        }
+
+        /* visit the entries from the least to the most recently used */
+        template<typename Visitor>
+        void forEach(Visitor visit) const {
+            for (typename List::const_reverse_iterator it = order.rbegin() ;
+                 it != order.rend() ;
+                 ++it)
+                visit(it->first, it->second);
+        }
+    };
+}
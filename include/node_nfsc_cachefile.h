@@ -0,0 +1,79 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <nan.h>
+#include "nfs3.h"
+#include "node_nfsc_fh.h"
+#include "node_nfsc_port.h"
+
+/* bumped whenever the layout of the cache file changes */
+#define NFSC_CACHE_FILE_VERSION 1
+
+namespace NFS {
+    class Client;
+    class Connection;
+
+    /*
+     * Attributes and names of a mount kept in a file across restarts.
+     *
+     * The file is written by saveCache() and by the last unmount. When
+     * the same export is mounted again, it is mapped and loaded back
+     * into the caches, unless the root handle or fsid changed since.
+     * Attributes keep the lifetime they had left. Names are revalidated
+     * lazily: they are trusted once a reply shows their directory with
+     * the mtime/ctime it had when saved.
+     */
+    class CacheFile {
+    public:
+        CacheFile();
+
+        /* an empty path disables the cache file */
+        void configure(const std::string &path_);
+        bool isEnabled();
+
+        /* after MNT, rootAttrs are the ones of the new root handle */
+        void load(Connection *connection, const nfs_fh3 &root,
+                  const fattr3 &rootAttrs);
+        /* returns 0 or an errno */
+        int save(Connection *connection);
+
+    private:
+        std::mutex lock;
+        std::string path;
+        FileHandle root;
+        uint64_t fsid;
+
+        CacheFile(const CacheFile &);
+        CacheFile &operator=(const CacheFile &);
+    };
+
+    class SaveCacheWorker : public Nan::AsyncWorker {
+        Client *client;
+        int error;
+
+    public:
+        SaveCacheWorker(Client *client_, Nan::Callback *callback);
+        void Execute() NFSC_OVERRIDE;
+        void HandleOKCallback() NFSC_OVERRIDE;
+    };
+}
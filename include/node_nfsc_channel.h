@@ -0,0 +1,87 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <stddef.h>
+#include <mutex>
+#include <vector>
+#include <gssrpc/rpc.h>
+
+/* extra connections to the server opened for bulk transfers */
+#define NFSC_MAX_CHANNELS 16
+
+namespace NFS {
+    class Client;
+    class Serialize;
+
+    /*
+     * Connections to the NFS server in addition to the one of the
+     * mount, so that bulk transfers keep several RPCs in flight: a
+     * CLIENT handle only carries one call at a time.
+     *
+     * Channels are opened on demand with the parameters of the client,
+     * up to NFSC_MAX_CHANNELS, and kept idle for reuse. When the server
+     * refuses one, the pool stops growing.
+     */
+    class ChannelPool {
+    public:
+        ChannelPool();
+        ~ChannelPool();
+
+        /* an idle or new channel, NULL when none can be had */
+        CLIENT *acquire(Client *client);
+        /* a channel whose last call failed is closed, not reused */
+        void release(CLIENT *channel, bool reusable);
+        /* close the idle channels */
+        void clear();
+
+        size_t getOpen();
+
+    private:
+        std::mutex lock;
+        std::vector<CLIENT *> idle;
+        size_t open;
+        size_t limit;
+
+        ChannelPool(const ChannelPool &);
+        ChannelPool &operator=(const ChannelPool &);
+    };
+
+    /*
+     * A channel of the pool held for a few calls, or the main CLIENT of
+     * the connection under Serialize when the pool has none left.
+     */
+    class Channel {
+        Client *client;
+        CLIENT *channel;
+        Serialize *serialize;
+        bool reusable;
+
+        Channel(const Channel &);
+        Channel &operator=(const Channel &);
+
+    public:
+        explicit Channel(Client *client_);
+        ~Channel();
+
+        CLIENT *get() const;
+        /* returns stat, remembers failures */
+        clnt_stat check(clnt_stat stat);
+    };
+}
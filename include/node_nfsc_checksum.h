@@ -0,0 +1,55 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <nan.h>
+#include "node_nfsc_hash.h"
+#include "node_nfsc_pipeline.h"
+
+namespace NFS {
+    class Client;
+
+    /*
+     * Range of a file read by a Pipeline only to be hashed: each chunk is
+     * added to the Digest by the thread that read it, and the data never
+     * reaches JS, only the digests do.
+     */
+    class ChecksumJob : public Pipeline {
+        FileHandle fh;
+        Digest digest;
+
+    public:
+        ChecksumJob(Client *client_, const v8::Local<v8::Value> &obj_fh_,
+                    uint64_t offset, uint64_t length, uint32_t chunkSize_,
+                    unsigned depth_, unsigned algorithms,
+                    const v8::Local<v8::Value> &callback_);
+
+    protected:
+        void execute(PipelineChunk *chunk) NFSC_OVERRIDE;
+        void done(int error_) NFSC_OVERRIDE;
+    };
+
+    /* NFSC_HASH_* of a name or an array of names, 0 if one is unknown */
+    unsigned checksum_algorithms(const v8::Local<v8::Value> &names);
+
+    /* add what a Pipeline read in chunk to digest. Threadpool only. */
+    void checksum_add(Digest *digest, const PipelineChunk *chunk);
+
+    /* { algorithm: hex digest } of a complete digest */
+    v8::Local<v8::Object> checksum_result(Digest *digest);
+}
@@ -28,17 +28,23 @@ namespace NFS {
 
     public:
 
-        Commit3Worker(Client *client_,
-                      const v8::Local<v8::Value> &obj_fh_,
-                      const v8::Local<v8::Value> &count_,
-                      const v8::Local<v8::Value> &offset_,
-                      Nan::Callback *callback);
+        static const char *poolName() {
+            return "commit3";
+        }
+
+        explicit Commit3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &obj_fh_,
+                   const v8::Local<v8::Value> &count_,
+                   const v8::Local<v8::Value> &offset_,
+                   const v8::Local<v8::Value> &callback_);
     private:
         clnt_stat xdrProc(COMMIT3args *a, COMMIT3res *r, CLIENT *c) NFSC_OVERRIDE {
             return nfsproc3_commit_3(a, r, c);
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
 
     };
 }
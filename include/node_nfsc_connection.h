@@ -0,0 +1,132 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <semaphore.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include "mount3.h"
+#include "nfs3.h"
+#include "node_nfsc_attrcache.h"
+#include "node_nfsc_cachefile.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_accesscache.h"
+#include "node_nfsc_namecache.h"
+#include "node_nfsc_pagecache.h"
+#include "node_nfsc_port.h"
+#include "node_nfsc_readahead.h"
+#include "node_nfsc_writebehind.h"
+
+/* READ/WRITE size used until FSINFO tells the server limits */
+#define NFSC_TRANSFER_SIZE 65536
+/* largest READ/WRITE payload fitting in a UDP datagram with its header */
+#define NFSC_UDP_TRANSFER_SIZE 32768
+
+namespace NFS {
+
+    /*
+     * RPC channels, root file handle and lock of a mounted export.
+     *
+     * Each Client owns a private Connection unless it was created with
+     * the shared option: shared Connections live in a process-wide
+     * registry keyed by the client parameters, so clients created with
+     * the same parameters in any worker thread use the same sockets and
+     * the same mount. The export is mounted by the first client and
+     * unmounted by the last one.
+     *
+     * The CLIENT handles and root file handle must only be used under
+     * Serialize, the caches have their own locks.
+     */
+    class Connection {
+        friend class Serialize;
+    public:
+        static Connection *acquire(const std::string &key, bool shared);
+        static void release(Connection *connection);
+
+        CLIENT *getClient();
+        void setClient(CLIENT *client_);
+        CLIENT *getMountClient();
+        void setMountClient(CLIENT *client_);
+        nfs_fh3 &getRootFh();
+        void freeRootFh();
+        void setRootFh(char *data, size_t len);
+
+        AttrCache &getAttrCache();
+        AccessCache &getAccessCache();
+        NameCache &getNameCache();
+        PageCache &getPageCache();
+        Readahead &getReadahead();
+        WriteBehind &getWriteBehind();
+        CacheFile &getCacheFile();
+        ChannelPool &getChannels();
+
+        /*
+         * Run configure on the first call only. The caches of a shared
+         * Connection are set up by the client that created it, clients
+         * joining later, from any thread, wait for that and keep what the
+         * caches already hold.
+         */
+        template<typename F>
+        void configureOnce(F configure) {
+            NFSC_LOOP_WAIT("configureOnce",
+                           std::call_once(configured, configure));
+        }
+
+        /* largest READ and WRITE payloads of the server, from FSINFO */
+        uint32_t getRtmax() const;
+        uint32_t getWtmax() const;
+        void setTransferSizes(uint32_t rtmax_, uint32_t wtmax_, bool udp);
+
+        /*
+         * number of clients currently mounted through this connection,
+         * atomic as a garbage collected Client drops its mount without
+         * taking the lock
+         */
+        int getMounts() const;
+        void addMount();
+        int removeMount();
+
+    private:
+        sem_t sem;
+        CLIENT *client;
+        CLIENT *mntClient;
+        nfs_fh3 *rootFh;
+        std::atomic<int> mounts;
+        AttrCache attrCache;
+        AccessCache accessCache;
+        NameCache nameCache;
+        PageCache pageCache;
+        Readahead readahead;
+        WriteBehind writeBehind;
+        CacheFile cacheFile;
+        ChannelPool channels;
+        std::atomic<uint32_t> rtmax;
+        std::atomic<uint32_t> wtmax;
+        int refs;
+        bool shared;
+        std::string key;
+        std::once_flag configured;
+
+        Connection(const std::string &key_, bool shared_);
+        ~Connection();
+        Connection(const Connection &);
+        Connection &operator=(const Connection &);
+    };
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <vector>
+#include <nan.h>
+#include "node_nfsc_pipeline.h"
+
+namespace NFS {
+    class Client;
+
+    /*
+     * Range of a file copied to another, possibly through another Client,
+     * by a Pipeline: each chunk is READ into a slab chunk on a channel of
+     * the source, then sent from there as UNSTABLE WRITEs on a channel of
+     * the destination. A single COMMIT ends the copy, chunks the
+     * destination lost by restarting are read and sent again FILE_SYNC.
+     * The attributes of the source may then be set on the destination.
+     *
+     * A sparse copy does not send the blocks that are all zeros, the
+     * destination is grown to the end of the range if they were the last
+     * ones.
+     */
+    class CopyJob : public Pipeline {
+        struct Uncommitted {
+            uint64_t offset;
+            uint32_t len;
+            char verf[NFS3_WRITEVERFSIZE];
+        };
+
+        FileHandle src;
+        Client *destination;
+        FileHandle dst;
+        uint64_t dstStart;
+        bool copyAttrs;
+        bool sparse;
+        double skipped;
+        bool hasAttrs;
+        fattr3 attrs;
+        std::vector<Uncommitted> uncommitted;
+
+        /* WRITE what chunk read, at the matching offset of dst */
+        void write(PipelineChunk *chunk, stable_how stable);
+        int setAttrs();
+
+    public:
+        CopyJob(Client *client_, const v8::Local<v8::Value> &src_fh_,
+                const v8::Local<v8::Value> &destination_,
+                const v8::Local<v8::Value> &dst_fh_, uint64_t offset,
+                uint64_t length, uint64_t dstOffset, uint32_t chunkSize_,
+                unsigned depth_, bool copyAttrs_, bool sparse_,
+                const v8::Local<v8::Value> &callback_);
+
+    protected:
+        void execute(PipelineChunk *chunk) NFSC_OVERRIDE;
+        void deliver(PipelineChunk *chunk) NFSC_OVERRIDE;
+        bool hasFinish() const NFSC_OVERRIDE;
+        int finish() NFSC_OVERRIDE;
+        void done(int error_) NFSC_OVERRIDE;
+    };
+}
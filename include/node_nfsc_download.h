@@ -0,0 +1,57 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <atomic>
+#include <nan.h>
+#include "node_nfsc_pipeline.h"
+
+namespace NFS {
+    class Client;
+
+    /*
+     * Range of a file read by a Pipeline straight into a local file
+     * descriptor: each chunk is READ into a slab chunk, then written with
+     * pwrite() at the matching position by the thread that read it, so
+     * the data never becomes a JS Buffer. The descriptor is only borrowed
+     * and must stay open until the callback runs. The errno of the first
+     * failed pwrite() or fdatasync() goes to the callback with
+     * NFSC_ELOCALWRITE.
+     */
+    class DownloadJob : public Pipeline {
+        FileHandle fh;
+        int fd;
+        uint64_t fdStart;
+        bool sync;
+        std::atomic<int> localErrno;
+
+        int failLocal(int errno_);
+
+    public:
+        DownloadJob(Client *client_, const v8::Local<v8::Value> &obj_fh_,
+                    int fd_, uint64_t offset, uint64_t length,
+                    uint64_t fdOffset, uint32_t chunkSize_, unsigned depth_,
+                    bool sync_, const v8::Local<v8::Value> &callback_);
+
+    protected:
+        void execute(PipelineChunk *chunk) NFSC_OVERRIDE;
+        bool hasFinish() const NFSC_OVERRIDE;
+        int finish() NFSC_OVERRIDE;
+        void done(int error_) NFSC_OVERRIDE;
+    };
+}
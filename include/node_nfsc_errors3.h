@@ -20,6 +20,32 @@
 #include "mount3.h"
 #include "nfs3.h"
 
+/*
+ * Errors are handed to JS as plain integers, mapped back to prebuilt
+ * NFSError templates by lib/errorFactory.js. nfsstat3 values are used
+ * as is, the other status spaces are shifted so they don't overlap.
+ */
+#define NFSC_RPC_ERROR_BASE 20000
+#define NFSC_MNT3_ERROR_BASE 40000
+
+static inline int
+rpc_error_code(clnt_stat stat)
+{
+    return NFSC_RPC_ERROR_BASE + stat;
+}
+
+static inline int
+mnt3_error_code(mountstat3 stat)
+{
+    return NFSC_MNT3_ERROR_BASE + stat;
+}
+
+static inline int
+nfs3_error_code(nfsstat3 stat)
+{
+    return stat;
+}
+
 const char *
 rpc_error(clnt_stat stat);
 
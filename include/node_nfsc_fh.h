@@ -0,0 +1,109 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <functional>
+#include "nfs3.h"
+
+namespace NFS {
+
+    /*
+     * File handle held by value, with inline storage for the largest
+     * NFSv3 handle and its hash computed once, so the native caches key
+     * on it without allocating or hashing the bytes again.
+     *
+     * Handles longer than NFS3_FHSIZE can only come from JS and are
+     * rejected by the server: they keep their length and a hash of all
+     * their bytes, but only the first NFS3_FHSIZE are stored.
+     */
+    class FileHandle {
+        uint32_t len;
+        size_t hash;
+        char data[NFS3_FHSIZE];
+
+    public:
+        FileHandle() : len(0), hash(0) {}
+
+        FileHandle(const char *data_, size_t len_) {
+            assign(data_, len_);
+        }
+
+        explicit FileHandle(const nfs_fh3 &fh) {
+            assign(fh.data.data_val, fh.data.data_len);
+        }
+
+        void assign(const char *data_, size_t len_) {
+            /* FNV-1a */
+            uint64_t h = 14695981039346656037ULL;
+            for (size_t i = 0 ; i < len_ ; ++i)
+                h = (h ^ uint8_t(data_[i])) * 1099511628211ULL;
+            len = len_;
+            hash = size_t(h);
+            memcpy(data, data_, len_ < NFS3_FHSIZE ? len_ : NFS3_FHSIZE);
+        }
+
+        void clear() {
+            len = 0;
+            hash = 0;
+        }
+
+        const char *getData() const {
+            return data;
+        }
+
+        size_t size() const {
+            return len < NFS3_FHSIZE ? len : NFS3_FHSIZE;
+        }
+
+        bool empty() const {
+            return !len;
+        }
+
+        size_t getHash() const {
+            return hash;
+        }
+
+        /* point fh at our bytes, valid as long as we are */
+        void toNfs(nfs_fh3 *fh) const {
+            fh->data.data_val = const_cast<char *>(data);
+            fh->data.data_len = size();
+        }
+
+        bool operator==(const FileHandle &other) const {
+            return hash == other.hash && len == other.len &&
+                    !memcmp(data, other.data, size());
+        }
+
+        bool operator!=(const FileHandle &other) const {
+            return !(*this == other);
+        }
+    };
+}
+
+namespace std {
+    template<>
+    struct hash<NFS::FileHandle> {
+        size_t operator()(const NFS::FileHandle &fh) const {
+            return fh.getHash();
+        }
+    };
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <regex.h>
+#include <string>
+#include <vector>
+#include <nan.h>
+#include "nfs3.h"
+
+namespace NFS {
+
+    /*
+     * Predicate on the entries of a walk, compiled once from its JS spec
+     * and evaluated in the threadpool on the decoded fattr3, so that only
+     * matching entries are ever converted for JS:
+     *
+     *   { names: [glob], regex: string, types: ['NF3REG', ...],
+     *     minSize, maxSize, minMtime, maxMtime, prune: [glob] }
+     *
+     * names globs match the entry name, regex the path relative to the
+     * walked directory, times are in seconds. An entry must pass every
+     * field given; one without attributes fails types, sizes and times.
+     * Directories whose name matches a prune glob are not walked into.
+     */
+    class WalkFilter {
+        std::vector<std::string> names;
+        std::vector<std::string> prune;
+        bool hasRegex;
+        regex_t regex;
+        /* bit (1 << type) for each ftype3 wanted, 0 for any */
+        unsigned types;
+        bool hasAttrPredicate;
+        uint64_t minSize;
+        uint64_t maxSize;
+        double minMtime;
+        double maxMtime;
+
+        WalkFilter(const WalkFilter &);
+        WalkFilter &operator=(const WalkFilter &);
+
+    public:
+        WalkFilter();
+        ~WalkFilter();
+
+        /* false with a message in *error when spec is not valid */
+        bool parse(const v8::Local<v8::Value> &spec, std::string *error);
+
+        /* thread safe once parsed */
+        bool matches(const char *name, const std::string &path,
+                     const fattr3 *attrs) const;
+        bool prunes(const char *name) const;
+    };
+}
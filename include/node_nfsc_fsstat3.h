@@ -28,9 +28,14 @@ namespace NFS {
 
     public:
 
-        FsStat3Worker(Client *client_,
-                      const v8::Local<v8::Value> &obj_fh_,
-                      Nan::Callback *callback);
+        static const char *poolName() {
+            return "fsstat3";
+        }
+
+        explicit FsStat3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &obj_fh_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
         clnt_stat xdrProc(FSSTAT3args *a, FSSTAT3res *r, CLIENT *c) NFSC_OVERRIDE {
@@ -38,5 +43,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
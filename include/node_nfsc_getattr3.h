@@ -28,9 +28,14 @@ namespace NFS {
 
     public:
 
-        GetAttr3Worker(Client *client_,
-                       const v8::Local<v8::Value> &obj_fh_,
-                       Nan::Callback *callback);
+        static const char *poolName() {
+            return "getattr3";
+        }
+
+        explicit GetAttr3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &obj_fh_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -39,5 +44,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <mutex>
+
+#define NFSC_HASH_CRC32C   (1 << 0)
+#define NFSC_HASH_SHA256   (1 << 1)
+#define NFSC_HASH_XXHASH64 (1 << 2)
+/* the longest of the digests */
+#define NFSC_HASH_MAX_SIZE 32
+
+namespace NFS {
+
+    /* Castagnoli CRC, with the SSE4.2 crc32 instruction when available */
+    class Crc32c {
+        uint32_t crc;
+    public:
+        Crc32c() : crc(0xffffffff) {}
+        void update(const char *data, size_t len);
+        /* big endian, 4 bytes */
+        void final(unsigned char *out) const;
+    };
+
+    /* SHA-256, with the SHA extensions when available */
+    class Sha256 {
+        uint32_t state[8];
+        uint64_t length;
+        unsigned char block[64];
+        size_t buffered;
+    public:
+        Sha256();
+        void update(const char *data, size_t len);
+        /* 32 bytes */
+        void final(unsigned char *out);
+    };
+
+    /* XXH64 with a seed of 0 */
+    class XxHash64 {
+        uint64_t acc[4];
+        uint64_t length;
+        unsigned char block[32];
+        size_t buffered;
+    public:
+        XxHash64();
+        void update(const char *data, size_t len);
+        /* canonical, big endian, 8 bytes */
+        void final(unsigned char *out) const;
+    };
+
+    /*
+     * Digests of a byte stream, in any of the algorithms above, fed from
+     * the threadpool by the chunks of a Pipeline as they complete.
+     *
+     * Chunks may arrive in any order: the one that continues the stream
+     * is hashed by the thread that brings it, those ahead are parked and
+     * hashed by the thread that catches up with them. No thread ever
+     * waits for another, and parked chunks are never more than the
+     * pipeline keeps in memory anyway, since it only releases a chunk
+     * once every chunk before it has been added.
+     */
+    class Digest {
+        unsigned algorithms;
+        Crc32c crc32c;
+        Sha256 sha256;
+        XxHash64 xxhash64;
+        std::mutex lock;
+        uint64_t next;
+        bool ended;
+        struct Parked {
+            const char *data;
+            uint32_t len;
+            bool last;
+        };
+        std::map<uint64_t, Parked> parked;
+
+        void update(const char *data, size_t len);
+
+        Digest(const Digest &);
+        Digest &operator=(const Digest &);
+
+    public:
+        Digest(unsigned algorithms_, uint64_t offset);
+
+        /* NFSC_HASH_* of name, 0 if unknown */
+        static unsigned parse(const char *name);
+        static const char *name(unsigned algorithm);
+
+        unsigned getAlgorithms() const;
+
+        /*
+         * Threadpool, the len bytes at offset of the stream, last when
+         * nothing follows them. data must stay valid until every chunk
+         * before offset was added.
+         */
+        void add(uint64_t offset, const char *data, uint32_t len,
+                 bool last);
+
+        /* once every chunk was added, returns the size of the digest */
+        size_t final(unsigned algorithm, unsigned char *out);
+    };
+}
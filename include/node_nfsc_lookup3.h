@@ -19,21 +19,36 @@
 #pragma once
 #include <nan.h>
 #include "node_nfsc_procedure3.h"
+#include "node_nfsc_string.h"
 
 
 namespace NFS {
     class Client;
+    class Connection;
+
+    /* LOOKUP cache handling, shared by every worker that walks names */
+    void lookup3_update_caches(Connection *connection,
+                               const LOOKUP3args &args,
+                               const LOOKUP3res &res);
+    bool lookup3_from_cache(Connection *connection,
+                            const LOOKUP3args &args,
+                            LOOKUP3res *res);
 
     class Lookup3Worker : public Procedure3Worker<LOOKUP3args, LOOKUP3res> {
 
-        Nan::Utf8String name;
+        InlineString<NFSC_INLINE_STRING_SIZE> name;
 
     public:
 
-        Lookup3Worker(Client *client_,
-                      const v8::Local<v8::Value> &parent_fh_,
-                      const v8::Local<v8::Value> &name_,
-                      Nan::Callback *callback);
+        static const char *poolName() {
+            return "lookup3";
+        }
+
+        explicit Lookup3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &parent_fh_,
+                   const v8::Local<v8::Value> &name_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -42,5 +57,7 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
+        bool fromCache() NFSC_OVERRIDE;
     };
 }
@@ -19,6 +19,7 @@
 #pragma once
 #include <nan.h>
 #include "node_nfsc_procedure3.h"
+#include "node_nfsc_string.h"
 
 
 namespace NFS {
@@ -26,15 +27,20 @@ namespace NFS {
 
     class MkDir3Worker : public Procedure3Worker<MKDIR3args, MKDIR3res> {
 
-        Nan::Utf8String name;
+        InlineString<NFSC_INLINE_STRING_SIZE> name;
 
     public:
 
-        MkDir3Worker(Client *client_,
-                     const v8::Local<v8::Value> &parent_fh_,
-                     const v8::Local<v8::Value> &name_,
-                     const v8::Local<v8::Value> &attrs_,
-                     Nan::Callback *callback);
+        static const char *poolName() {
+            return "mkdir3";
+        }
+
+        explicit MkDir3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &parent_fh_,
+                   const v8::Local<v8::Value> &name_,
+                   const v8::Local<v8::Value> &attrs_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -43,5 +49,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
@@ -19,6 +19,7 @@
 #pragma once
 #include <nan.h>
 #include "node_nfsc_procedure3.h"
+#include "node_nfsc_string.h"
 
 
 namespace NFS {
@@ -26,17 +27,21 @@ namespace NFS {
 
     class MkNod3Worker : public Procedure3Worker<MKNOD3args, MKNOD3res> {
 
-        Nan::Utf8String name;
-        Nan::Utf8String type;
+        InlineString<NFSC_INLINE_STRING_SIZE> name;
 
     public:
 
-        MkNod3Worker(Client *client_,
-                     const v8::Local<v8::Value> &parent_fh_,
-                     const v8::Local<v8::Value> &name_,
-                     const v8::Local<v8::Value> &type,
-                     const v8::Local<v8::Value> &mknodData_,
-                     Nan::Callback *callback);
+        static const char *poolName() {
+            return "mknod3";
+        }
+
+        explicit MkNod3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &parent_fh_,
+                   const v8::Local<v8::Value> &name_,
+                   const v8::Local<v8::Value> &type_,
+                   const v8::Local<v8::Value> &mknodData_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -45,5 +50,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
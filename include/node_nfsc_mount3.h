@@ -29,15 +29,17 @@ namespace NFS {
 
         Client *client;
         bool success;
-        char *error;
+        int error;
 
-        AUTH *createUnixAuth(int uid, int gid);
         CLIENT *createMountClient();
-        CLIENT *createNfsClient();
         bool mount();
 
     public:
 
+        /* also used to open the extra channels of bulk transfers */
+        static AUTH *createUnixAuth(int uid, int gid, int *error);
+        static CLIENT *createNfsClient(Client *client, int *error);
+
         Mount3Worker(Client *client_, Nan::Callback *callback);
         ~Mount3Worker() NFSC_OVERRIDE;
         void Execute() NFSC_OVERRIDE;
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include "nfs3.h"
+#include "node_nfsc_cache.h"
+
+/* maximum number of cached names and directories per connection */
+#define NFSC_NAME_CACHE_SIZE 65536
+#define NFSC_NAME_CACHE_DIRS 16384
+
+namespace NFS {
+
+    /*
+     * Directory name lookup cache: (directory, name) to file handle,
+     * with negative entries for names known not to exist.
+     *
+     * Entries of a directory are only trusted while the directory
+     * mtime/ctime, as found in the attribute cache, match the ones seen
+     * when they were added. Our own changes to a directory come with
+     * wcc_data: when the pre-operation attributes match, only the
+     * changed name is updated, otherwise every entry of the directory is
+     * dropped.
+     */
+    class NameCache {
+    public:
+        enum Result {
+            MISS,
+            FOUND,
+            NOT_FOUND
+        };
+
+        /* entries as kept in the cache file */
+        struct SavedDir {
+            FileHandle fh;
+            nfstime3 mtime;
+            nfstime3 ctime;
+        };
+        struct SavedName {
+            FileHandle dir;
+            std::string name;
+            bool negative;
+            FileHandle fh;
+        };
+
+        NameCache();
+
+        void configure(bool enabled);
+
+        /*
+         * Look name up in dir, whose fresh attributes come from the
+         * attribute cache. Stores the handle in fh when FOUND.
+         */
+        Result lookup(const nfs_fh3 &dir, const fattr3 &dirAttrs,
+                      const char *name, FileHandle *fh);
+
+        /* LOOKUP replies */
+        void found(const nfs_fh3 &dir, const post_op_attr &dirAttrs,
+                   const char *name, const nfs_fh3 &fh);
+        void notFound(const nfs_fh3 &dir, const post_op_attr &dirAttrs,
+                      const char *name);
+
+        /* our own directory changes */
+        void modified(const nfs_fh3 &dir, const wcc_data &wcc);
+        void added(const nfs_fh3 &dir, const wcc_data &wcc,
+                   const char *name, const post_op_fh3 &fh);
+        void removed(const nfs_fh3 &dir, const wcc_data &wcc,
+                     const char *name);
+        void renamed(const nfs_fh3 &fromDir, const wcc_data &fromWcc,
+                     const char *fromName,
+                     const nfs_fh3 &toDir, const wcc_data &toWcc,
+                     const char *toName);
+
+        /*
+         * Valid entries, least recently used first. Restored names are
+         * trusted once their directory is seen unchanged.
+         */
+        void save(std::vector<SavedDir> *savedDirs,
+                  std::vector<SavedName> *savedNames);
+        void restore(const SavedDir &saved);
+        void restore(const SavedName &saved);
+
+        double getHits() const;
+        double getNegativeHits() const;
+        double getMisses() const;
+        size_t getSize();
+
+    private:
+        struct Dir {
+            nfstime3 mtime;
+            nfstime3 ctime;
+            uint64_t generation;
+        };
+        struct Name {
+            FileHandle fh;
+            bool negative;
+            uint64_t generation;
+        };
+
+        std::mutex lock;
+        bool enabled;
+        uint64_t nextGeneration;
+        LruCache<FileHandle, Dir> dirs;
+        LruCache<std::string, Name> names;
+        double hits;
+        double negativeHits;
+        double misses;
+
+        Dir *validate(const FileHandle &dir, const fattr3 &attrs);
+        void revalidate(const FileHandle &dir, const wcc_data &wcc);
+        void set(const FileHandle &dir, const char *name,
+                 const FileHandle *fh);
+        void forget(const FileHandle &dir, const char *name);
+
+        NameCache(const NameCache &);
+        NameCache &operator=(const NameCache &);
+    };
+}
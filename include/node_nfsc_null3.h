@@ -33,8 +33,13 @@ namespace NFS {
 
     public:
 
-        Null3Worker(Client *client_,
-                     Nan::Callback *callback);
+        static const char *poolName() {
+            return "null3";
+        }
+
+        explicit Null3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -43,7 +48,7 @@ namespace NFS {
             /* null procedure does nothing, but it still needs a status
              * for the templatized code which relies on it */
             r->status = NFS3_OK;
-            return nfsproc3_symlink_3(0, 0, c);
+            return nfsproc3_null_3(0, 0, c);
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
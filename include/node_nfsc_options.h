@@ -0,0 +1,67 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <string>
+#include <nan.h>
+
+/* readers for the optional settings objects passed from JS */
+
+static inline unsigned
+option_uint(const v8::Local<v8::Value> &options, const char *name,
+            unsigned defaultValue)
+{
+    if (!options->IsObject())
+        return defaultValue;
+    v8::Local<v8::Value> value = v8::Local<v8::Object>::Cast(options)
+            ->Get(Nan::New(name).ToLocalChecked());
+    return value->IsUint32() ? value->Uint32Value() : defaultValue;
+}
+
+static inline bool
+option_bool(const v8::Local<v8::Value> &options, const char *name,
+            bool defaultValue)
+{
+    if (!options->IsObject())
+        return defaultValue;
+    v8::Local<v8::Value> value = v8::Local<v8::Object>::Cast(options)
+            ->Get(Nan::New(name).ToLocalChecked());
+    return value->IsBoolean() ? value->IsTrue() : defaultValue;
+}
+
+static inline double
+option_number(const v8::Local<v8::Value> &options, const char *name,
+              double defaultValue)
+{
+    if (!options->IsObject())
+        return defaultValue;
+    v8::Local<v8::Value> value = v8::Local<v8::Object>::Cast(options)
+            ->Get(Nan::New(name).ToLocalChecked());
+    return value->IsNumber() ? value->NumberValue() : defaultValue;
+}
+
+static inline std::string
+option_string(const v8::Local<v8::Value> &options, const char *name)
+{
+    if (!options->IsObject())
+        return std::string();
+    v8::Local<v8::Value> value = v8::Local<v8::Object>::Cast(options)
+            ->Get(Nan::New(name).ToLocalChecked());
+    return value->IsString() ? std::string(*Nan::Utf8String(value))
+                             : std::string();
+}
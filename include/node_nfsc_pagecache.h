@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <mutex>
+#include "nfs3.h"
+#include "node_nfsc_cache.h"
+
+/* unit of the data cache, file offsets are cached page aligned */
+#define NFSC_PAGE_SIZE 32768
+/* maximum number of files whose pages are tracked per connection */
+#define NFSC_PAGE_CACHE_FILES 16384
+
+namespace NFS {
+
+    /*
+     * File data cache keyed by (file handle, page index), bounded by a
+     * byte budget with LRU eviction. Disabled unless given a budget.
+     *
+     * Pages of a file are only trusted while its mtime/ctime, as found
+     * in the attribute cache, match the ones seen when they were read:
+     * a fresh GETATTR when a file is opened gives close-to-open
+     * consistency. Our own writes update the cached pages in place when
+     * their wcc_data shows nobody else changed the file in between.
+     */
+    class PageCache {
+    public:
+        PageCache();
+
+        void configure(size_t budget);
+        bool isEnabled();
+
+        /*
+         * Copy count bytes at offset of fh, whose fresh attributes come
+         * from the attribute cache, to buf. Fails unless every page
+         * needed is cached.
+         */
+        bool read(const nfs_fh3 &fh, const fattr3 &attrs,
+                  uint64_t offset, uint32_t count,
+                  char *buf, uint32_t *len, bool *eof);
+
+        /* READ replies */
+        void fill(const nfs_fh3 &fh, const post_op_attr &attrs,
+                  uint64_t offset, const char *data, uint32_t len);
+
+        /* our own changes to the file */
+        void written(const nfs_fh3 &fh, const wcc_data &wcc,
+                     uint64_t offset, const char *data, uint32_t len);
+        void invalidate(const nfs_fh3 &fh);
+
+        double getHits() const;
+        double getMisses() const;
+        size_t getSize();
+
+    private:
+        struct File {
+            nfstime3 mtime;
+            nfstime3 ctime;
+            uint64_t generation;
+        };
+        struct Page {
+            std::string data;
+            uint64_t generation;
+        };
+        struct PageKey {
+            FileHandle fh;
+            uint64_t index;
+
+            bool operator==(const PageKey &other) const {
+                return index == other.index && fh == other.fh;
+            }
+        };
+        struct PageKeyHash {
+            size_t operator()(const PageKey &key) const {
+                return key.fh.getHash() ^ (key.index * 0x9e3779b97f4a7c15ULL);
+            }
+        };
+
+        std::mutex lock;
+        bool enabled;
+        uint64_t nextGeneration;
+        LruCache<FileHandle, File> files;
+        LruCache<PageKey, Page, PageKeyHash> pages;
+        double hits;
+        double misses;
+
+        File *validate(const FileHandle &fh, const fattr3 &attrs);
+
+        PageCache(const PageCache &);
+        PageCache &operator=(const PageCache &);
+    };
+}
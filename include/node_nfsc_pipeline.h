@@ -0,0 +1,207 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <nan.h>
+#include "nfs3.h"
+#include "node_nfsc_fh.h"
+#include "node_nfsc_port.h"
+#include "node_nfsc_pool.h"
+#include "node_nfsc_transfer.h"
+
+/* chunks in flight of a bulk transfer, unless asked otherwise */
+#define NFSC_PIPELINE_DEPTH 4
+#define NFSC_PIPELINE_MAX_DEPTH 64
+/* range of a pipeline running up to the end of the file */
+#define NFSC_PIPELINE_TO_EOF UINT64_MAX
+
+namespace NFS {
+    class Channel;
+    class Client;
+    class Pipeline;
+
+    /* one slice of the range of a Pipeline */
+    struct PipelineChunk {
+        uint64_t offset;
+        uint32_t count;
+        /* payload, a slab chunk when capacity is set, borrowed otherwise */
+        char *data;
+        size_t capacity;
+        uint32_t len;
+        /* bytes of len not sent, all-zero blocks of a sparse WRITE */
+        uint32_t skipped;
+        bool eof;
+        bool hasAttrs;
+        fattr3 attrs;
+        /* a WRITE of the chunk was not committed, under verf */
+        bool unstable;
+        char verf[NFS3_WRITEVERFSIZE];
+        int error;
+    };
+
+    /* runs one chunk, or the final step, of a Pipeline in the threadpool */
+    class PipelineWorker : public PooledWorker {
+
+        Pipeline *pipeline;
+        PipelineChunk chunk;
+        bool last;
+
+    public:
+
+        static const char *poolName() {
+            return "pipeline";
+        }
+
+        explicit PipelineWorker(WorkerPoolBase *pool_);
+        void setup(Pipeline *pipeline_, const PipelineChunk &chunk_,
+                   bool last_);
+
+        void Execute() NFSC_OVERRIDE;
+        void WorkComplete() NFSC_OVERRIDE;
+
+    private:
+
+        void recycle() NFSC_OVERRIDE;
+    };
+
+    /*
+     * Bulk transfer over a range of a file in one native call.
+     *
+     * The range is cut in chunks, up to depth of them run at once in the
+     * threadpool, each on its own channel (see node_nfsc_channel.h) so
+     * that their RPCs are in flight together. Scheduling happens on the
+     * main thread: completed chunks are delivered in offset order, and
+     * no chunk is issued more than depth chunks ahead of the last one
+     * delivered, which bounds the memory held.
+     *
+     * A chunk ending short, at the end of the file, ends the range. The
+     * first error stops issuing chunks, the pipeline then waits for the
+     * ones in flight before calling done() and deleting itself.
+     */
+    class Pipeline : public Transferable {
+        friend class PipelineWorker;
+
+    public:
+        virtual ~Pipeline();
+
+        /* main thread, issue the first chunks */
+        void start();
+
+        /* stop and resume issuing and delivering chunks */
+        void pause() NFSC_OVERRIDE;
+        void resume() NFSC_OVERRIDE;
+        /* stop issuing chunks and end with error once idle */
+        void abort(int error_) NFSC_OVERRIDE;
+
+    protected:
+        Client *client;
+        Nan::Callback callback;
+
+        Pipeline(Client *client_, uint64_t offset, uint64_t length,
+                 uint32_t chunkSize_, unsigned depth_,
+                 const v8::Local<v8::Value> &callback_);
+
+        /* keep value alive while the pipeline runs */
+        void keep(const char *name, const v8::Local<v8::Value> &value);
+
+        uint64_t getStart() const;
+        uint64_t getEnd() const;
+        /* end of what was delivered so far */
+        uint64_t getDelivered() const;
+        void setEnd(uint64_t end_);
+        void setDepth(unsigned depth_);
+        bool isPaused() const;
+
+        /* main thread, before a chunk is issued, may set its data */
+        virtual void prepare(PipelineChunk *chunk);
+        /* threadpool, the RPCs of a chunk, sets len and eof or error */
+        virtual void execute(PipelineChunk *chunk) = 0;
+        /* main thread, in offset order, may take data away from chunk */
+        virtual void deliver(PipelineChunk *chunk);
+        /* threadpool, once every chunk succeeded, returns an error */
+        virtual bool hasFinish() const;
+        virtual int finish();
+        /* main thread, last call before the pipeline deletes itself */
+        virtual void done(int error_) = 0;
+
+        /* give back the slab chunk of chunk, if any */
+        static void releaseData(PipelineChunk *chunk);
+
+    private:
+        Nan::Persistent<v8::Object> persistent;
+        uint64_t start_;
+        uint64_t next;
+        uint64_t end;
+        uint64_t delivered;
+        uint32_t chunkSize;
+        unsigned depth;
+        unsigned inFlight;
+        bool paused;
+        bool finishing;
+        bool ending;
+        bool scheduling;
+        int error;
+        std::map<uint64_t, PipelineChunk> ready;
+
+        void schedule();
+        void complete(PipelineChunk *chunk);
+        void finished(int error_);
+        void settle();
+
+        Pipeline(const Pipeline &);
+        Pipeline &operator=(const Pipeline &);
+    };
+
+    /*
+     * READ chunk->count bytes at chunk->offset of fh into chunk->data,
+     * allocated from the slab when unset, with as many READs as the
+     * server needs. Threadpool only.
+     */
+    void pipeline_read(Client *client, Channel &channel, const FileHandle &fh,
+                       PipelineChunk *chunk);
+
+    /*
+     * WRITE the chunk->count bytes of chunk->data at chunk->offset of fh,
+     * with as many WRITEs as the server needs. When sparse, the blocks
+     * that are all zeros are not sent but counted in chunk->skipped: the
+     * file must already read as zeros there, see pipeline_extend().
+     * Threadpool only.
+     */
+    void pipeline_write(Client *client, Channel &channel,
+                        const FileHandle &fh, PipelineChunk *chunk,
+                        stable_how stable, bool sparse);
+
+    /*
+     * COMMIT count bytes at offset of fh and store the verifier of the
+     * server in verf, returns an error code. Threadpool only.
+     */
+    int pipeline_commit(Client *client, Channel &channel,
+                        const FileHandle &fh, uint64_t offset,
+                        uint64_t count, char *verf);
+
+    /*
+     * Grow fh to size bytes with a SETATTR when it is shorter, as when
+     * the blocks skipped by a sparse WRITE ran to the end of the range.
+     * Returns an error code. Threadpool only.
+     */
+    int pipeline_extend(Client *client, Channel &channel,
+                        const FileHandle &fh, uint64_t size);
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <vector>
+#include <nan.h>
+#include "node_nfsc_port.h"
+
+/* maximum number of idle workers kept per procedure */
+#define NFSC_WORKER_POOL_SIZE 64
+
+namespace NFS {
+
+    /*
+     * Freelist of pre-constructed workers for one procedure.
+     *
+     * Workers are handed back by their Destroy() override once the JS
+     * callback has run, so steady-state calls reuse the worker, its
+     * Nan::Callback, its persistent handle and its args/res storage.
+     *
+     * Workers hold handles of the isolate they were created in, so pools
+     * are per JS thread and emptied when that thread's environment goes
+     * away. Workers still in flight then keep their pool alive: it is
+     * closed, takes no worker back, and is deleted by the release() of
+     * the last one. The pools of a thread are chained together for
+     * workerPoolStats().
+     */
+    class WorkerPoolBase {
+    public:
+        const char *getName() const;
+        WorkerPoolBase *getNext() const;
+        static WorkerPoolBase *getFirst();
+
+        double getAllocated() const;
+        double getReused() const;
+        double getDiscarded() const;
+        size_t getIdle() const;
+        size_t getOutstanding() const;
+
+        /*
+         * returns false when the pool is full or closed, the caller must
+         * delete the worker and not touch the pool again
+         */
+        bool release(Nan::AsyncWorker *worker);
+
+    protected:
+        WorkerPoolBase(const char *name_, WorkerPoolBase **owner_);
+        virtual ~WorkerPoolBase();
+        Nan::AsyncWorker *pop();
+
+        double allocated;
+        double reused;
+        /* workers handed out and not released yet */
+        size_t outstanding;
+
+    private:
+        const char *name;
+        WorkerPoolBase **owner;
+        WorkerPoolBase *next;
+        double discarded;
+        bool closed;
+        std::vector<Nan::AsyncWorker *> idle;
+
+        void close();
+        static void cleanup(void *pool);
+    };
+
+    template<typename Worker>
+    class WorkerPool : public WorkerPoolBase {
+    public:
+        static WorkerPool &instance() {
+            static __thread WorkerPoolBase *my_pool = NULL;
+            if (!my_pool)
+                new WorkerPool(&my_pool);
+            return *static_cast<WorkerPool *>(my_pool);
+        }
+
+        Worker *acquire() {
+            Nan::AsyncWorker *worker = pop();
+            ++outstanding;
+            if (worker) {
+                ++reused;
+                return static_cast<Worker *>(worker);
+            }
+            ++allocated;
+            return new Worker(this);
+        }
+
+    private:
+        explicit WorkerPool(WorkerPoolBase **owner_)
+            : WorkerPoolBase(Worker::poolName(), owner_) {}
+    };
+
+    /*
+     * Base of the workers taken from a WorkerPool: Destroy() makes the
+     * worker forget its last job with recycle(), then hands it back to
+     * its pool, or deletes it when the pool will not have it.
+     *
+     * Workers created with a JS callback keep their Nan::Callback across
+     * reuses, only the function it holds is dropped once called. The
+     * others complete through their own WorkComplete().
+     */
+    class PooledWorker : public Nan::AsyncWorker {
+    public:
+        void WorkComplete() NFSC_OVERRIDE {
+            Nan::HandleScope scope;
+            HandleOKCallback();
+            callback->Reset();
+        }
+
+        void Destroy() NFSC_OVERRIDE {
+            recycle();
+            if (!pool || !pool->release(this))
+                delete this;
+        }
+
+        /* give back a worker whose setup() failed, without queuing it */
+        void abandon() {
+            if (callback)
+                callback->Reset();
+            Destroy();
+        }
+
+    protected:
+        WorkerPoolBase *pool;
+
+        PooledWorker(WorkerPoolBase *pool_, bool hasCallback)
+            : Nan::AsyncWorker(hasCallback ? new Nan::Callback() : NULL),
+              pool(pool_)
+        {}
+
+        /* drop what the last job left, before reuse or deletion */
+        virtual void recycle() {}
+    };
+
+    NAN_METHOD(WorkerPoolStats);
+}
@@ -32,3 +32,41 @@
         if ( ret < 0 )\
             *p = NULL;\
     } while (0)
+
+/*
+ * Per-environment teardown of thread local state. Only node versions
+ * with worker_threads can run several environments, and only those have
+ * environment cleanup hooks.
+ */
+#include <node_version.h>
+#if NODE_MAJOR_VERSION >= 12
+# define NFSC_ADD_CLEANUP_HOOK(__fn__, __arg__) \
+    node::AddEnvironmentCleanupHook(v8::Isolate::GetCurrent(), \
+                                    (__fn__), (__arg__))
+#else
+# define NFSC_ADD_CLEANUP_HOOK(__fn__, __arg__) do {} while (0)
+#endif
+
+/*
+ * Debug builds report every wait of a JS thread on something a threadpool
+ * RPC may hold: the event loop may stall for as long, up to a full
+ * timeout. __wait__ is the blocking statement, __what__ names it.
+ */
+#ifdef DEBUG
+# include <stdint.h>
+namespace NFS {
+    /* false off the JS threads, which may block freely */
+    bool loop_wait_start(uint64_t *start);
+    void loop_wait_end(const char *what, uint64_t start);
+}
+# define NFSC_LOOP_WAIT(__what__, __wait__) \
+    do {\
+        uint64_t start_;\
+        bool loop_ = NFS::loop_wait_start(&start_);\
+        __wait__;\
+        if (loop_)\
+            NFS::loop_wait_end((__what__), start_);\
+    } while (0)
+#else
+# define NFSC_LOOP_WAIT(__what__, __wait__) do { __wait__; } while (0)
+#endif
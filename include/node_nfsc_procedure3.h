@@ -21,18 +21,29 @@
 #include "nfs3.h"
 #include "node_nfsc_port.h"
 #include "node_nfsc_errors3.h"
+#include "node_nfsc_pool.h"
 
 
 
 namespace NFS {
     class Client;
+
+    /*
+     * Base of all pooled NFSv3 procedure workers.
+     *
+     * A worker is taken from its WorkerPool, filled by the subclass
+     * setup() method and queued. Once the JS callback has run, Destroy()
+     * releases the XDR results and hands the worker back to the pool
+     * instead of deleting it.
+     */
     template<typename PROCEDURE3args, typename PROCEDURE3res>
-    class Procedure3Worker : public Nan::AsyncWorker {
+    class Procedure3Worker : public PooledWorker {
 
     protected:
         Client *client;
         bool success;
-        char *error;
+        bool called;
+        int error;
         xdrproc_t freeFunc;
         PROCEDURE3args args;
         PROCEDURE3res res;
@@ -43,41 +54,73 @@ namespace NFS {
         virtual void procSuccess() = 0;
         virtual void procFailure() = 0;
 
+        /*
+         * Feed the connection caches from args/res, called in the
+         * threadpool after every RPC that got a reply, whatever its
+         * status.
+         */
+        virtual void updateCaches() {}
+
+        /*
+         * Fill res from the connection caches instead of calling the
+         * server, anything allocated in res must come from malloc().
+         */
+        virtual bool fromCache() { return false; }
+
+        void reset(Client *client_, const v8::Local<v8::Value> &callback_) {
+            client = client_;
+            callback->Reset(callback_.As<v8::Function>());
+        }
+
+        void recycle() NFSC_OVERRIDE {
+            error = 0;
+            /*
+             * res is owned by the worker and freeing it needs no CLIENT
+             * state, so this never waits for the client on the loop thread
+             */
+            if (called && freeFunc)
+                xdr_free(freeFunc, (char*)&res);
+            called = false;
+            success = false;
+            args = PROCEDURE3args();
+            res = PROCEDURE3res();
+            client = 0;
+        }
+
     public:
 
-        Procedure3Worker(Client *client_,
-                         xdrproc_t freeFunc_,
-                         Nan::Callback *callback)
-            : Nan::AsyncWorker(callback),
-              client(client_),
+        Procedure3Worker(WorkerPoolBase *pool_, xdrproc_t freeFunc_)
+            : PooledWorker(pool_, true),
+              client(0),
               success(false),
+              called(false),
               error(0),
               freeFunc(freeFunc_),
-              args({}),
-              res({})
+              args(),
+              res()
         {}
 
         ~Procedure3Worker() NFSC_OVERRIDE {
-            free(error);
-            if (freeFunc) {
-                Serialize my(client);
-                clnt_freeres(client->getClient(), freeFunc, (char*)&res);
-            }
+            Procedure3Worker::recycle();
         }
         void Execute() NFSC_OVERRIDE {
             if (!client->isMounted()) {
-                NFSC_ASPRINTF(&error, NFSC_NOT_MOUNTED);
+                error = NFSC_NOT_MOUNTED;
                 return;
             }
-            Serialize my(client);
-            clnt_stat stat;
-            stat = xdrProc(&args, &res, client->getClient());
-            if (stat != RPC_SUCCESS) {
-                NFSC_ASPRINTF(&error, "%s", rpc_error(stat));
-                return;
+            called = true;
+            if (!fromCache()) {
+                Serialize my(client);
+                clnt_stat stat;
+                stat = xdrProc(&args, &res, client->getClient());
+                if (stat != RPC_SUCCESS) {
+                    error = rpc_error_code(stat);
+                    return;
+                }
+                updateCaches();
             }
             if (res.status != NFS3_OK) {
-                NFSC_ASPRINTF(&error, "%s", nfs3_error(res.status));
+                error = nfs3_error_code(res.status);
                 return;
             }
             success = true;
@@ -21,25 +21,50 @@
 #include "node_nfsc_procedure3.h"
 
 
+/* READ3res decoder into a preset buffer, see node_nfsc_read3.cc */
+bool_t xdr_READ3res_slab(XDR *xdrs, READ3res *objp);
+
 namespace NFS {
     class Client;
 
     class Read3Worker : public Procedure3Worker<READ3args, READ3res> {
 
+        /* slab chunk the payload is decoded into, see node_nfsc_slab.h */
+        char *chunk;
+        size_t chunkSize;
+
+        /* READ to issue ahead of the reader once the callback is queued */
+        bool ahead;
+        uint64_t aheadOffset;
+        uint32_t aheadCount;
+        uint64_t aheadGeneration;
+
+        void releaseChunk();
+
     public:
 
-        Read3Worker(Client *client_,
-                    const v8::Local<v8::Value> &obj_fh_,
-                    const v8::Local<v8::Value> &count_,
-                    const v8::Local<v8::Value> &offset_,
-                    Nan::Callback *callback);
+        static const char *poolName() {
+            return "read3";
+        }
+
+        explicit Read3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &obj_fh_,
+                   const v8::Local<v8::Value> &count_,
+                   const v8::Local<v8::Value> &offset_,
+                   const v8::Local<v8::Value> &callback_);
+        ~Read3Worker() NFSC_OVERRIDE;
+
+        void Execute() NFSC_OVERRIDE;
+        void WorkComplete() NFSC_OVERRIDE;
 
     private:
 
-        clnt_stat xdrProc(READ3args *a, READ3res *r, CLIENT *c) NFSC_OVERRIDE {
-            return nfsproc3_read_3(a, r, c);
-        }
+        void recycle() NFSC_OVERRIDE;
+        clnt_stat xdrProc(READ3args *a, READ3res *r, CLIENT *c) NFSC_OVERRIDE;
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
+        bool fromCache() NFSC_OVERRIDE;
     };
 }
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <nan.h>
+#include "nfs3.h"
+#include "node_nfsc_cache.h"
+#include "node_nfsc_port.h"
+#include "node_nfsc_pool.h"
+
+/* maximum number of files read sequentially at once per connection */
+#define NFSC_READAHEAD_STREAMS 64
+/* smallest window opened by a sequential read */
+#define NFSC_READAHEAD_MIN_WINDOW 65536
+
+namespace NFS {
+    class Client;
+
+    /*
+     * Sequential read detection per file handle.
+     *
+     * Each read3 call is reported with access(): a read starting where
+     * the previous one ended doubles the readahead window of the file, up
+     * to the configured maximum, any other offset closes it. While the
+     * window is open, a window worth of data is read ahead of the reader
+     * into a buffer per file, which read3 calls consume without an RPC.
+     * The window is cut in READs of at most rtmax, each issued on its
+     * own channel, whose results are put back in order. Disabled unless
+     * given a maximum window.
+     */
+    class Readahead {
+    public:
+        Readahead();
+
+        void configure(size_t maxWindow);
+        bool isEnabled();
+
+        /*
+         * Copy count bytes at offset of fh, whose fresh attributes come
+         * from the attribute cache, to buf. Fails unless the buffer holds
+         * all of them, or all of them up to the end of file.
+         */
+        bool read(const nfs_fh3 &fh, const fattr3 &attrs,
+                  uint64_t offset, uint32_t count,
+                  char *buf, uint32_t *len, bool *eof);
+
+        /*
+         * Record a read of len bytes at offset of fh. Returns true with
+         * the range to fetch ahead, and the stream generation to give
+         * back to fill(), when READs of up to rtmax bytes each should be
+         * issued for it.
+         */
+        bool access(const nfs_fh3 &fh, uint64_t offset, uint32_t len,
+                    bool eof, uint32_t rtmax,
+                    uint64_t *aheadOffset, uint32_t *aheadCount,
+                    uint64_t *generation);
+
+        /*
+         * Results of the READs issued ahead, in any order. Both return
+         * false when the stream moved on since, the caches must then not
+         * be updated with them either.
+         */
+        bool fill(const FileHandle &fh, uint64_t generation,
+                  uint64_t offset, const post_op_attr &attrs,
+                  const char *data, uint32_t len, bool eof);
+        bool failed(const FileHandle &fh, uint64_t generation);
+
+        /* our own changes to the file */
+        void invalidate(const nfs_fh3 &fh);
+
+        double getHits() const;
+        double getMisses() const;
+        double getIssued() const;
+        /* windows whose READs all landed in the buffer */
+        double getFilled() const;
+
+    private:
+        /* a READ that completed before those preceding it */
+        struct Early {
+            std::string data;
+            bool eof;
+        };
+
+        struct Stream {
+            uint64_t next;
+            uint32_t window;
+            uint64_t generation;
+            /* READs in flight */
+            uint32_t pending;
+            /* data read ahead, from start, attributes when read */
+            uint64_t start;
+            std::string data;
+            bool eof;
+            nfstime3 mtime;
+            nfstime3 ctime;
+            /* by offset, appended to data once contiguous */
+            std::map<uint64_t, Early> early;
+        };
+
+        std::mutex lock;
+        size_t maxWindow;
+        uint64_t nextGeneration;
+        LruCache<FileHandle, Stream> streams;
+        double hits;
+        double misses;
+        double issued;
+        double filled;
+
+        void reset(Stream *stream);
+
+        Readahead(const Readahead &);
+        Readahead &operator=(const Readahead &);
+    };
+
+    /* READ of part of a window ahead of a reader, with no JS callback */
+    class ReadaheadWorker : public PooledWorker {
+
+        Client *client;
+        FileHandle fh;
+        uint64_t generation;
+        READ3args args;
+        READ3res res;
+
+    public:
+
+        static const char *poolName() {
+            return "readahead";
+        }
+
+        explicit ReadaheadWorker(WorkerPoolBase *pool_);
+        void setup(Client *client_, const nfs_fh3 &fh_,
+                   uint64_t offset, uint32_t count, uint64_t generation_);
+
+        void Execute() NFSC_OVERRIDE;
+        void WorkComplete() NFSC_OVERRIDE;
+
+    private:
+
+        void recycle() NFSC_OVERRIDE;
+    };
+}
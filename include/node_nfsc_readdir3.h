@@ -28,12 +28,17 @@ namespace NFS {
 
     public:
 
-        ReadDir3Worker(Client *client_,
-                       const v8::Local<v8::Value> &dir_fh_,
-                       const v8::Local<v8::Value> &cookie_,
-                       const v8::Local<v8::Value> &cookieverf_,
-                       const v8::Local<v8::Value> &count_,
-                       Nan::Callback *callback);
+        static const char *poolName() {
+            return "readdir3";
+        }
+
+        explicit ReadDir3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &dir_fh_,
+                   const v8::Local<v8::Value> &cookie_,
+                   const v8::Local<v8::Value> &cookieverf_,
+                   const v8::Local<v8::Value> &count_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -42,5 +47,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
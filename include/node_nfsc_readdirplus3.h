@@ -29,13 +29,18 @@ namespace NFS {
 
     public:
 
-        ReadDirPlus3Worker(Client *client_,
-                           const v8::Local<v8::Value> &dir_fh_,
-                           const v8::Local<v8::Value> &cookie_,
-                           const v8::Local<v8::Value> &cookieverf_,
-                           const v8::Local<v8::Value> &dircount_,
-                           const v8::Local<v8::Value> &maxcount_,
-                           Nan::Callback *callback);
+        static const char *poolName() {
+            return "readdirplus3";
+        }
+
+        explicit ReadDirPlus3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &dir_fh_,
+                   const v8::Local<v8::Value> &cookie_,
+                   const v8::Local<v8::Value> &cookieverf_,
+                   const v8::Local<v8::Value> &dircount_,
+                   const v8::Local<v8::Value> &maxcount_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -46,5 +51,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
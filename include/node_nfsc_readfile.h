@@ -0,0 +1,62 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <string>
+#include <nan.h>
+#include "node_nfsc_pipeline.h"
+
+namespace NFS {
+    class Client;
+
+    /*
+     * Range of a file read by a Pipeline, returned as one Buffer the
+     * READs land in directly, or as one Buffer per chunk.
+     *
+     * Without a length, the first chunk is read alone: the attributes
+     * of its reply give the size of the Buffer to read the rest into.
+     */
+    class ReadFileJob : public Pipeline {
+        FileHandle fh;
+        bool chunked;
+        unsigned wantedDepth;
+        /* the single Buffer, allocated once the size is known */
+        char *dest;
+        bool sized;
+        /* when the server tells no size, data is gathered here */
+        std::string spill;
+        Nan::Persistent<v8::Array> chunks;
+        uint32_t chunkCount;
+
+    public:
+        ReadFileJob(Client *client_, const v8::Local<v8::Value> &obj_fh_,
+                    uint64_t offset, uint64_t length, uint32_t chunkSize_,
+                    unsigned depth_, bool chunked_,
+                    const v8::Local<v8::Value> &callback_);
+        ~ReadFileJob() NFSC_OVERRIDE;
+
+        /* false when a single Buffer of size bytes cannot be had */
+        bool allocate(uint64_t size);
+
+    protected:
+        void prepare(PipelineChunk *chunk) NFSC_OVERRIDE;
+        void execute(PipelineChunk *chunk) NFSC_OVERRIDE;
+        void deliver(PipelineChunk *chunk) NFSC_OVERRIDE;
+        void done(int error_) NFSC_OVERRIDE;
+    };
+}
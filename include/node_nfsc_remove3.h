@@ -19,6 +19,7 @@
 #pragma once
 #include <nan.h>
 #include "node_nfsc_procedure3.h"
+#include "node_nfsc_string.h"
 
 
 namespace NFS {
@@ -26,14 +27,19 @@ namespace NFS {
 
     class Remove3Worker : public Procedure3Worker<REMOVE3args, REMOVE3res> {
 
-        Nan::Utf8String name;
+        InlineString<NFSC_INLINE_STRING_SIZE> name;
 
     public:
 
-        Remove3Worker(Client *client_,
-                      const v8::Local<v8::Value> &parent_fh_,
-                      const v8::Local<v8::Value> &name_,
-                      Nan::Callback *callback);
+        static const char *poolName() {
+            return "remove3";
+        }
+
+        explicit Remove3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &parent_fh_,
+                   const v8::Local<v8::Value> &name_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -42,5 +48,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <stdint.h>
+#include <list>
+#include <string>
+#include <vector>
+#include <nan.h>
+#include "nfs3.h"
+#include "node_nfsc_fh.h"
+#include "node_nfsc_port.h"
+#include "node_nfsc_pool.h"
+
+/* RPCs of a removeTree in flight, unless asked otherwise */
+#define NFSC_REMOVE_TREE_CONCURRENCY 16
+/* names one REMOVE task goes through */
+#define NFSC_REMOVE_TREE_GROUP 32
+/* entries one LIST task goes through */
+#define NFSC_REMOVE_TREE_BATCH 1024
+
+namespace NFS {
+    class Client;
+    class PathWalker;
+    class RemoveTree;
+
+    /* a directory being emptied */
+    struct RemoveTreeDir {
+        FileHandle fh;
+        /* NULL for the directory the tree is removed from */
+        RemoveTreeDir *parent;
+        std::string name;
+        /* LIST and REMOVE tasks and subdirectories left before the RMDIR */
+        size_t pending;
+        /* listed again from the start after a NOTEMPTY RMDIR */
+        bool relisted;
+        std::list<RemoveTreeDir>::iterator self;
+    };
+
+    struct RemoveTreeTask {
+        enum Kind {
+            LOOKUP,
+            LIST,
+            REMOVE,
+            RMDIR
+        };
+
+        Kind kind;
+        /* LIST and RMDIR: the directory, otherwise the one names are in */
+        RemoveTreeDir *dir;
+        std::vector<std::string> names;
+        /* LIST: where the previous batch stopped */
+        cookie3 cookie;
+        cookieverf3 verf;
+    };
+
+    /* runs one task of a RemoveTree in the threadpool */
+    class RemoveTreeWorker : public PooledWorker {
+        friend class RemoveTree;
+
+        struct Subdir {
+            std::string name;
+            FileHandle fh;
+        };
+
+        RemoveTree *job;
+        RemoveTreeTask task;
+        int error;
+        /* LOOKUP and LIST results */
+        bool isDir;
+        FileHandle fh;
+        std::vector<std::string> files;
+        std::vector<Subdir> subdirs;
+        bool more;
+        /* REMOVE and RMDIR results */
+        uint32_t removed;
+
+    public:
+
+        static const char *poolName() {
+            return "removeTree";
+        }
+
+        explicit RemoveTreeWorker(WorkerPoolBase *pool_);
+        void setup(RemoveTree *job_, const RemoveTreeTask &task_);
+
+        void Execute() NFSC_OVERRIDE;
+        void WorkComplete() NFSC_OVERRIDE;
+
+    private:
+
+        void recycle() NFSC_OVERRIDE;
+        void list();
+        bool classify(PathWalker *walker, const char *name,
+                      const post_op_attr &attrs, const post_op_fh3 &handle);
+        void remove();
+        void rmdir();
+    };
+
+    /*
+     * rm -rf of name in a directory, driven from the main thread.
+     *
+     * Each directory is listed with READDIRPLUS a batch of entries at a
+     * time, the files of a batch are then removed by groups of names
+     * running concurrently, and its subdirectories emptied the same way,
+     * before the rest of the directory is listed; entries READDIRPLUS
+     * gave no attributes for are looked up. A directory is removed once
+     * its last entry is, so RMDIRs go bottom-up, and listed once more
+     * from the start if some entries escaped the listing. Tasks wait on
+     * a stack, which walks the tree depth first and bounds what is
+     * pending.
+     *
+     * Entries already gone are not errors, the first other error stops
+     * issuing tasks and is reported once the tasks in flight are done.
+     */
+    class RemoveTree {
+        friend class RemoveTreeWorker;
+
+    public:
+        RemoveTree(Client *client_, const v8::Local<v8::Value> &dir_fh_,
+                   const std::string &name, unsigned concurrency_,
+                   const v8::Local<v8::Value> &callback_);
+        ~RemoveTree();
+
+        void start();
+
+    private:
+        Client *client;
+        Nan::Callback callback;
+        Nan::Persistent<v8::Object> persistent;
+        unsigned concurrency;
+        std::list<RemoveTreeDir> dirs;
+        RemoveTreeDir *top;
+        std::vector<RemoveTreeTask> tasks;
+        unsigned inFlight;
+        int error;
+        double files;
+        double directories;
+
+        RemoveTreeDir *addDir(RemoveTreeDir *parent, const std::string &name,
+                              const FileHandle &fh);
+        void push(RemoveTreeTask::Kind kind, RemoveTreeDir *dir,
+                  std::vector<std::string> *names);
+        /* list dir from cookie, holding it until done */
+        void pushList(RemoveTreeDir *dir, const cookie3 &cookie,
+                      const cookieverf3 verf);
+        /* one pending entry of dir is gone */
+        void release(RemoveTreeDir *dir);
+        void complete(RemoveTreeWorker *worker);
+        void schedule();
+
+        RemoveTree(const RemoveTree &);
+        RemoveTree &operator=(const RemoveTree &);
+    };
+}
@@ -19,6 +19,7 @@
 #pragma once
 #include <nan.h>
 #include "node_nfsc_procedure3.h"
+#include "node_nfsc_string.h"
 
 
 namespace NFS {
@@ -26,17 +27,22 @@ namespace NFS {
 
     class Rename3Worker : public Procedure3Worker<RENAME3args, RENAME3res> {
 
-        Nan::Utf8String from_name;
-        Nan::Utf8String to_name;
+        InlineString<NFSC_INLINE_STRING_SIZE> from_name;
+        InlineString<NFSC_INLINE_STRING_SIZE> to_name;
 
     public:
 
-        Rename3Worker(Client *client_,
-                      const v8::Local<v8::Value> &from_fh_,
-                      const v8::Local<v8::Value> &from_name_,
-                      const v8::Local<v8::Value> &to_fh_,
-                      const v8::Local<v8::Value> &to_name_,
-                      Nan::Callback *callback);
+        static const char *poolName() {
+            return "rename3";
+        }
+
+        explicit Rename3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &from_fh_,
+                   const v8::Local<v8::Value> &from_name_,
+                   const v8::Local<v8::Value> &to_fh_,
+                   const v8::Local<v8::Value> &to_name_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -45,5 +51,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
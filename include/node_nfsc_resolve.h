@@ -0,0 +1,113 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include <nan.h>
+#include "nfs3.h"
+#include "node_nfsc_fh.h"
+#include "node_nfsc_port.h"
+#include "node_nfsc_pool.h"
+#include "node_nfsc_string.h"
+
+/* symbolic links followed by one resolution, as Linux MAXSYMLINKS */
+#define NFSC_MAX_SYMLINKS 40
+
+namespace NFS {
+    class Channel;
+    class Client;
+
+    /*
+     * One step at a time walker over a connection, used by the compound
+     * operations: each LOOKUP goes through the name cache first, the
+     * client lock is only held for each RPC so other requests on the
+     * connection interleave with a long walk. Given a channel, the RPCs
+     * go through it instead.
+     */
+    class PathWalker {
+        Client *client;
+        Channel *channel;
+        int error;
+        FileHandle fh;
+        fattr3 attrs;
+        bool hasAttrs;
+
+    public:
+        PathWalker();
+        void reset(Client *client_);
+        /* held by the caller, NULL for the main CLIENT under Serialize */
+        void setChannel(Channel *channel_);
+
+        /* append the components of path, '.' and empty ones skipped */
+        static void split(const char *path, std::vector<std::string> *names);
+
+        int getError() const;
+        const FileHandle &getFh() const;
+        void setFh(const FileHandle &fh_);
+        bool setRoot();
+        /* attributes of the current handle, fetched when unknown */
+        const fattr3 *getAttrs();
+
+        /* move to name in the current directory */
+        bool lookup(const std::string &name);
+        /* read the target of the current handle */
+        bool readlink(std::string *target);
+    };
+
+    /*
+     * Walks a slash separated path from a directory handle in a single
+     * threadpool job, with a READLINK per symbolic link followed.
+     */
+    class ResolvePathWorker : public PooledWorker {
+
+        Client *client;
+        bool success;
+        int error;
+        bool followSymlinks;
+        bool intermediates;
+        InlineString<NFSC_INLINE_STRING_SIZE> path;
+        FileHandle start;
+        PathWalker walker;
+        /* components left to resolve, the next one last */
+        std::vector<std::string> components;
+        std::vector<FileHandle> handles;
+
+    public:
+
+        static const char *poolName() {
+            return "resolvePath";
+        }
+
+        explicit ResolvePathWorker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &start_fh_,
+                   const v8::Local<v8::Value> &path_,
+                   const v8::Local<v8::Value> &options_,
+                   const v8::Local<v8::Value> &callback_);
+
+        void Execute() NFSC_OVERRIDE;
+        void HandleOKCallback() NFSC_OVERRIDE;
+
+    private:
+
+        void push(const char *path_);
+        bool resolve();
+        void recycle() NFSC_OVERRIDE;
+    };
+}
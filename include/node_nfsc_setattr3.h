@@ -28,11 +28,16 @@ namespace NFS {
 
     public:
 
-        SetAttr3Worker(Client *client_,
-                       const v8::Local<v8::Value> &obj_fh_,
-                       const v8::Local<v8::Value> &attrs_,
-                       const v8::Local<v8::Value> &guard_,
-                       Nan::Callback *callback);
+        static const char *poolName() {
+            return "setattr3";
+        }
+
+        explicit SetAttr3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &obj_fh_,
+                   const v8::Local<v8::Value> &attrs_,
+                   const v8::Local<v8::Value> &guard_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -41,5 +46,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <stddef.h>
+#include <mutex>
+#include <vector>
+#include <nan.h>
+
+/* smallest and largest pooled chunk, larger reads fall back to malloc */
+#define NFSC_SLAB_MIN_SHIFT 12
+#define NFSC_SLAB_MAX_SHIFT 20
+#define NFSC_SLAB_CLASSES (NFSC_SLAB_MAX_SHIFT - NFSC_SLAB_MIN_SHIFT + 1)
+/* chunks are carved from regions of this size (one x86-64 huge page) */
+#define NFSC_SLAB_REGION_SIZE (2UL << 20)
+
+namespace NFS {
+
+    /*
+     * Process-wide allocator for READ3 payloads.
+     *
+     * Requests are rounded up to a power-of-two size class between 4KiB
+     * and 1MiB, which covers the usual rsize values. Chunks come from
+     * 2MiB mmap()ed regions, backed by huge pages when the
+     * NFSC_SLAB_HUGEPAGES environment variable is set, and go back to a
+     * per-class freelist when the Buffer that wraps them is finalized.
+     * Regions are never unmapped.
+     *
+     * alloc() may be called from the libuv threadpool, release() and
+     * newBuffer() from the main thread.
+     */
+    class Slab {
+    public:
+        static Slab &instance();
+
+        /*
+         * Return a chunk of at least size bytes and store its real
+         * capacity in *capacity, or NULL on allocation failure.
+         */
+        char *alloc(size_t size, size_t *capacity);
+        void release(char *chunk, size_t capacity);
+
+        /*
+         * Wrap len bytes of chunk in a Buffer that gives the chunk back
+         * on finalization, and account for capacity as external memory.
+         */
+        v8::Local<v8::Object> newBuffer(char *chunk,
+                                        size_t len,
+                                        size_t capacity);
+
+    private:
+        struct SizeClass {
+            std::mutex lock;
+            std::vector<char *> free;
+            double regions;
+            double inUse;
+        };
+
+        SizeClass classes[NFSC_SLAB_CLASSES];
+        bool hugePages;
+
+        Slab();
+        Slab(const Slab &);
+        Slab &operator=(const Slab &);
+
+        static int classOf(size_t size);
+        char *mapRegion();
+        static void freeCallback(char *chunk, void *hint);
+
+        friend NAN_METHOD(SlabStats);
+    };
+
+    NAN_METHOD(SlabStats);
+}
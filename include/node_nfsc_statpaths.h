@@ -0,0 +1,126 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <nan.h>
+#include "nfs3.h"
+#include "node_nfsc_fh.h"
+#include "node_nfsc_port.h"
+#include "node_nfsc_pool.h"
+
+/* maximum number of paths of one statPaths call */
+#define NFSC_STAT_PATHS_MAX 65536
+/* directories looked in at once by a statPaths call */
+#define NFSC_STAT_PATHS_CONCURRENCY 8
+/* paths of one directory looked up by a single task */
+#define NFSC_STAT_PATHS_TASK_SIZE 256
+
+namespace NFS {
+    class Client;
+    class StatPaths;
+
+    /* paths of one parent directory, or a slice of them */
+    struct StatPathsTask {
+        /* components of the parent, relative to the start directory */
+        std::vector<std::string> dir;
+        /* last components, empty for the parent itself */
+        std::vector<std::string> names;
+        /* index in the call of each of names */
+        std::vector<uint32_t> indexes;
+    };
+
+    /* looks up one StatPathsTask in the threadpool */
+    class StatPathsWorker : public PooledWorker {
+        friend class StatPaths;
+
+        StatPaths *job;
+        StatPathsTask task;
+        int error;
+
+    public:
+
+        static const char *poolName() {
+            return "statPaths";
+        }
+
+        explicit StatPathsWorker(WorkerPoolBase *pool_);
+        void setup(StatPaths *job_, StatPathsTask *task_);
+
+        void Execute() NFSC_OVERRIDE;
+        void WorkComplete() NFSC_OVERRIDE;
+
+    private:
+
+        void recycle() NFSC_OVERRIDE;
+    };
+
+    /*
+     * Attributes of many paths below one directory. The paths are
+     * grouped by parent directory on the main thread, each parent is
+     * then resolved and its paths looked up by a StatPathsWorker on its
+     * own channel, up to NFSC_STAT_PATHS_CONCURRENCY of them at once; a
+     * parent with many paths is split in tasks of
+     * NFSC_STAT_PATHS_TASK_SIZE. The ancestors shared by several
+     * parents are answered by the name cache after their first LOOKUP.
+     * Symbolic links are not followed.
+     *
+     * The results are handed to JS packed as by walk_batch(), one record
+     * per path in the order of the call, with the error of the path, 0
+     * when it resolved, instead of the depth: { handles: Buffer,
+     * records: Buffer of doubles }.
+     */
+    class StatPaths {
+        friend class StatPathsWorker;
+
+    public:
+        StatPaths(Client *client_, const v8::Local<v8::Value> &start_fh_,
+                  const v8::Local<v8::Value> &callback_);
+        ~StatPaths();
+
+        /* group the paths by parent, false with a JS exception pending */
+        bool setup(const v8::Local<v8::Array> &paths);
+        void start();
+
+    private:
+        struct Result {
+            int error;
+            FileHandle fh;
+            fattr3 attrs;
+        };
+
+        Client *client;
+        Nan::Callback callback;
+        Nan::Persistent<v8::Object> persistent;
+        FileHandle start_fh;
+        std::vector<StatPathsTask> pending;
+        /* one per path, each only written by the task holding it */
+        std::vector<Result> results;
+        unsigned inFlight;
+        int error;
+
+        void complete(StatPathsWorker *worker);
+        void schedule();
+        v8::Local<v8::Object> pack();
+
+        StatPaths(const StatPaths &);
+        StatPaths &operator=(const StatPaths &);
+    };
+}
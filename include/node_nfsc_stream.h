@@ -0,0 +1,57 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <nan.h>
+#include "node_nfsc_hash.h"
+#include "node_nfsc_pipeline.h"
+#include "node_nfsc_transfer.h"
+
+namespace NFS {
+    class Client;
+
+    /*
+     * Range of a file read by a Pipeline and handed chunk by chunk, in
+     * Buffers wrapping the slab chunks the READs landed in, to onData.
+     * onData returning false pauses the pipeline until resumed through
+     * its Transfer: the chunks in flight are then all that is read ahead.
+     * With algorithms set, the chunks are also hashed as they are read
+     * and the digests handed to the final callback.
+     */
+    class ReadStreamJob : public Pipeline {
+        FileHandle fh;
+        Nan::Callback onData;
+        Transfer *transfer;
+        Digest *digest;
+
+    public:
+        ReadStreamJob(Client *client_, const v8::Local<v8::Value> &obj_fh_,
+                      uint64_t offset, uint64_t length, uint32_t chunkSize_,
+                      unsigned depth_, unsigned algorithms,
+                      const v8::Local<v8::Value> &onData_,
+                      const v8::Local<v8::Value> &callback_);
+        ~ReadStreamJob();
+
+        v8::Local<v8::Object> getTransfer();
+
+    protected:
+        void execute(PipelineChunk *chunk) NFSC_OVERRIDE;
+        void deliver(PipelineChunk *chunk) NFSC_OVERRIDE;
+        void done(int error_) NFSC_OVERRIDE;
+    };
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <nan.h>
+
+/* names up to NAME_MAX never touch the heap */
+#define NFSC_INLINE_STRING_SIZE 256
+
+namespace NFS {
+
+    /*
+     * Reassignable replacement for Nan::Utf8String used by pooled workers:
+     * short strings live inline, longer ones go to a heap buffer that is
+     * kept (and only ever grown) across reuses.
+     */
+    template<size_t N>
+    class InlineString {
+        char inlineBuf[N];
+        char *heapBuf;
+        size_t heapSize;
+        char *str;
+
+        InlineString(const InlineString &);
+        InlineString &operator=(const InlineString &);
+
+    public:
+        InlineString() : heapBuf(NULL), heapSize(0), str(inlineBuf) {
+            inlineBuf[0] = 0;
+        }
+
+        ~InlineString() {
+            free(heapBuf);
+        }
+
+        bool assign(const v8::Local<v8::Value> &value) {
+            ssize_t len = Nan::DecodeBytes(value, Nan::UTF8);
+            char *dst = inlineBuf;
+            if (len < 0)
+                return false;
+            if (size_t(len) >= N) {
+                if (size_t(len) >= heapSize) {
+                    char *buf = (char *)realloc(heapBuf, len + 1);
+                    if (!buf)
+                        return false;
+                    heapBuf = buf;
+                    heapSize = len + 1;
+                }
+                dst = heapBuf;
+            }
+            Nan::DecodeWrite(dst, len, value, Nan::UTF8);
+            dst[len] = 0;
+            str = dst;
+            return true;
+        }
+
+        char *operator*() {
+            return str;
+        }
+
+        const char *operator*() const {
+            return str;
+        }
+    };
+}
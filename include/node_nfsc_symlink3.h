@@ -19,23 +19,29 @@
 #pragma once
 #include <nan.h>
 #include "node_nfsc_procedure3.h"
+#include "node_nfsc_string.h"
 
 namespace NFS {
     class Client;
 
     class SymLink3Worker : public Procedure3Worker<SYMLINK3args, SYMLINK3res> {
 
-        Nan::Utf8String name;
-        Nan::Utf8String path;
+        InlineString<NFSC_INLINE_STRING_SIZE> name;
+        InlineString<NFSC_INLINE_STRING_SIZE> path;
 
     public:
 
-        SymLink3Worker(Client *client_,
-                       const v8::Local<v8::Value> &parent_fh_,
-                       const v8::Local<v8::Value> &name_,
-                       const v8::Local<v8::Value> &attrs_,
-                       const v8::Local<v8::Value> &path_,
-                       Nan::Callback *callback);
+        static const char *poolName() {
+            return "symlink3";
+        }
+
+        explicit SymLink3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &parent_fh_,
+                   const v8::Local<v8::Value> &name_,
+                   const v8::Local<v8::Value> &attrs_,
+                   const v8::Local<v8::Value> &path_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -44,5 +50,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <nan.h>
+
+namespace NFS {
+
+    /* a native job driven from the main thread that JS may steer */
+    class Transferable {
+    public:
+        virtual ~Transferable() {}
+
+        virtual void pause() = 0;
+        virtual void resume() = 0;
+        /* stop and end with error once idle */
+        virtual void abort(int error_) = 0;
+    };
+
+    /*
+     * JS handle on a running Transferable, to pause, resume or abort it.
+     * The job detaches itself before it goes away, the methods then do
+     * nothing.
+     */
+    class Transfer : public Nan::ObjectWrap {
+        Transferable *job;
+
+        explicit Transfer(Transferable *job_);
+
+        static Nan::Persistent<v8::Function> &constructor();
+        static NAN_METHOD(New);
+        static NAN_METHOD(Pause);
+        static NAN_METHOD(Resume);
+        static NAN_METHOD(Abort);
+
+    public:
+        static void Init();
+        static v8::Local<v8::Object> create(Transferable *job_);
+
+        void detach();
+    };
+}
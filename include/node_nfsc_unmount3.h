@@ -29,7 +29,7 @@ namespace NFS {
 
         Client *client;
         bool success;
-        char *error;
+        int error;
 
     public:
 
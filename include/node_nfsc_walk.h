@@ -0,0 +1,167 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include <nan.h>
+#include "nfs3.h"
+#include "node_nfsc_fh.h"
+#include "node_nfsc_filter.h"
+#include "node_nfsc_port.h"
+#include "node_nfsc_pool.h"
+#include "node_nfsc_transfer.h"
+
+/* directories listed at once by a walk, unless asked otherwise */
+#define NFSC_WALK_CONCURRENCY 8
+#define NFSC_WALK_MAX_CONCURRENCY 64
+/* entries a directory is listed by before they are delivered */
+#define NFSC_WALK_BATCH_SIZE 1024
+/* READDIRPLUS sizes of a walk */
+#define NFSC_WALK_DIRCOUNT 8192
+#define NFSC_WALK_MAXCOUNT 32768
+/* doubles per entry in the records of a batch, see walk_batch() */
+#define NFSC_WALK_RECORD_SIZE 14
+
+namespace NFS {
+    class Client;
+    class Walk;
+
+    /* a directory to list, or the rest of one */
+    struct WalkDir {
+        FileHandle fh;
+        /* relative to the root of the walk, empty for the root */
+        std::string path;
+        unsigned depth;
+        cookie3 cookie;
+        cookieverf3 verf;
+    };
+
+    struct WalkEntry {
+        std::string path;
+        FileHandle fh;
+        unsigned depth;
+        bool hasAttrs;
+        fattr3 attrs;
+    };
+
+    /* lists up to a batch of entries of one directory in the threadpool */
+    class WalkWorker : public PooledWorker {
+        friend class Walk;
+
+        Walk *walk;
+        WalkDir dir;
+        bool more;
+        int error;
+        std::vector<WalkEntry> entries;
+        std::vector<WalkDir> subdirs;
+
+    public:
+
+        static const char *poolName() {
+            return "walk";
+        }
+
+        explicit WalkWorker(WorkerPoolBase *pool_);
+        void setup(Walk *walk_, const WalkDir &dir_);
+
+        void Execute() NFSC_OVERRIDE;
+        void WorkComplete() NFSC_OVERRIDE;
+
+    private:
+
+        void recycle() NFSC_OVERRIDE;
+    };
+
+    /*
+     * Native traversal of the tree below a directory.
+     *
+     * Directories waiting to be listed are kept on a stack, up to
+     * concurrency of them are listed at once by WalkWorkers, each on its
+     * own channel, and a directory is listed a batch of entries at a
+     * time: the tree is thus walked depth first, which bounds what is
+     * pending by the depth of the tree and not by its width.
+     *
+     * Scheduling happens on the main thread, where each batch is handed
+     * to onBatch packed in a few objects. onBatch returning false pauses
+     * the walk, the batches of the directories being listed are then
+     * held until it is resumed through its Transfer.
+     *
+     * With a filter, only the entries it matches are delivered, the
+     * others are dropped in the threadpool.
+     *
+     * Directories removed while the walk runs are skipped, any other
+     * error stops the walk.
+     */
+    class Walk : public Transferable {
+        friend class WalkWorker;
+
+    public:
+        Walk(Client *client_, const v8::Local<v8::Value> &root_fh_,
+             unsigned concurrency_, unsigned maxDepth_, uint32_t batchSize_,
+             WalkFilter *filter_, const v8::Local<v8::Value> &onBatch_,
+             const v8::Local<v8::Value> &callback_);
+        virtual ~Walk();
+
+        v8::Local<v8::Object> getTransfer();
+        void start();
+
+        void pause() NFSC_OVERRIDE;
+        void resume() NFSC_OVERRIDE;
+        void abort(int error_) NFSC_OVERRIDE;
+
+    private:
+        Client *client;
+        Nan::Callback onBatch;
+        Nan::Callback callback;
+        Nan::Persistent<v8::Object> persistent;
+        Transfer *transfer;
+        unsigned concurrency;
+        unsigned maxDepth;
+        uint32_t batchSize;
+        /* owned, NULL to deliver every entry */
+        WalkFilter *filter;
+        std::vector<WalkDir> pending;
+        std::deque<std::vector<WalkEntry> > ready;
+        unsigned inFlight;
+        bool paused;
+        bool scheduling;
+        bool ending;
+        int error;
+        double listed;
+
+        void complete(WalkWorker *worker);
+        void schedule();
+
+        Walk(const Walk &);
+        Walk &operator=(const Walk &);
+    };
+
+    /*
+     * Pack entries for JS: { paths: [string], handles: Buffer, records:
+     * Buffer of doubles }, with NFSC_WALK_RECORD_SIZE doubles per entry:
+     * the offset and length of its handle in handles, its depth, then
+     * type (0 without attributes), mode, nlink, uid, gid, size, used,
+     * fileid, atime, mtime and ctime of its attributes.
+     */
+    v8::Local<v8::Object> walk_batch(const std::vector<WalkEntry> &entries);
+    /* fill the type to ctime doubles of a record, zeros without attrs */
+    void walk_record_attrs(double *record, const fattr3 *attrs);
+}
@@ -23,18 +23,29 @@
 
 namespace NFS {
     class Client;
+    class Connection;
+
+    /* WRITE cache handling, shared by every worker that writes */
+    void write3_update_caches(Connection *connection,
+                              const WRITE3args &args,
+                              const WRITE3res &res);
 
     class Write3Worker : public Procedure3Worker<WRITE3args, WRITE3res> {
 
     public:
 
-        Write3Worker(Client *client_,
-                     const v8::Local<v8::Value> &obj_fh_,
-                     const v8::Local<v8::Value> &count_,
-                     const v8::Local<v8::Value> &offset_,
-                     const v8::Local<v8::Value> &stable_,
-                     const v8::Local<v8::Value> &data_,
-                     Nan::Callback *callback);
+        static const char *poolName() {
+            return "write3";
+        }
+
+        explicit Write3Worker(WorkerPoolBase *pool_);
+        bool setup(Client *client_,
+                   const v8::Local<v8::Value> &obj_fh_,
+                   const v8::Local<v8::Value> &count_,
+                   const v8::Local<v8::Value> &offset_,
+                   const v8::Local<v8::Value> &stable_,
+                   const v8::Local<v8::Value> &data_,
+                   const v8::Local<v8::Value> &callback_);
 
     private:
 
@@ -43,5 +54,6 @@ namespace NFS {
         }
         void procSuccess() NFSC_OVERRIDE;
         void procFailure() NFSC_OVERRIDE;
+        void updateCaches() NFSC_OVERRIDE;
     };
 }
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nan.h>
+#include "nfs3.h"
+#include "node_nfsc_fh.h"
+#include "node_nfsc_port.h"
+#include "node_nfsc_pool.h"
+
+/* default size of the WRITEs small writes are gathered into */
+#define NFSC_WSIZE 65536
+/* unstable data kept for retransmission per file before a COMMIT */
+#define NFSC_WRITE_BEHIND_UNCOMMITTED (16 << 20)
+
+namespace NFS {
+    class Client;
+
+    /*
+     * Write-back state per file handle.
+     *
+     * Writes contiguous to the dirty data of a file are gathered in
+     * memory up to wsize bytes, then sent as UNSTABLE WRITEs. Data the
+     * server did not commit is kept with the verifier of its WRITE until
+     * a COMMIT: when the COMMIT verifier differs, the server lost it and
+     * it is sent again. Errors of gathered writes, whose callbacks have
+     * already run, are reported by the next flush, which also waits for
+     * the data other workers are sending.
+     */
+    class WriteBehind {
+    public:
+        struct Range {
+            uint64_t seq;
+            uint64_t offset;
+            std::string data;
+            char verf[NFS3_WRITEVERFSIZE];
+        };
+
+        WriteBehind();
+
+        void configure(size_t wsize_);
+        size_t getWsize();
+
+        /*
+         * Gather len bytes at offset of fh, fails when they are not
+         * contiguous to the dirty data or do not fit in wsize.
+         */
+        bool absorb(const FileHandle &fh, uint64_t offset,
+                    const char *data, size_t len);
+        /* take the dirty data of fh to send it */
+        bool take(const FileHandle &fh, uint64_t *offset, std::string *data);
+
+        /* a worker sends data of fh, outside of a flush */
+        void startSending(const FileHandle &fh);
+        void endSending(const FileHandle &fh);
+        /* until the data of fh being sent is, for a flush to commit it */
+        void waitSent(const FileHandle &fh);
+        /* files with data to send or commit, or an error to report */
+        void pending(std::vector<FileHandle> *fhs);
+
+        /* an UNSTABLE WRITE of fh was not committed by the server */
+        void sent(const FileHandle &fh, uint64_t offset,
+                  const char *data, size_t len, const char *verf);
+        size_t getUncommitted(const FileHandle &fh);
+
+        /* sequence of the last WRITE a COMMIT sent now covers, 0 if none */
+        uint64_t snapshot(const FileHandle &fh);
+        /*
+         * The COMMIT covering up to seq replied verf: WRITEs sent with
+         * another verifier are moved to stale, the others forgotten.
+         */
+        void committed(const FileHandle &fh, uint64_t seq,
+                       const char *verf, std::vector<Range> *stale);
+
+        void setError(const FileHandle &fh, int error);
+        int takeError(const FileHandle &fh);
+
+        double getGathered() const;
+        double getWrites() const;
+        double getCommits() const;
+        double getResent() const;
+        void countWrite();
+        void countCommit();
+        void countResent();
+
+    private:
+        struct File {
+            uint64_t start;
+            std::string dirty;
+            std::vector<Range> uncommitted;
+            size_t uncommittedBytes;
+            uint64_t nextSeq;
+            int error;
+            /* workers sending data of the file */
+            unsigned sending;
+        };
+        typedef std::unordered_map<FileHandle, File> Files;
+
+        std::mutex lock;
+        /* signaled when a file has no data being sent anymore */
+        std::condition_variable idle;
+        size_t wsize;
+        Files files;
+        double gathered;
+        double writes;
+        double commits;
+        double resent;
+
+        void release(Files::iterator file);
+
+        WriteBehind(const WriteBehind &);
+        WriteBehind &operator=(const WriteBehind &);
+    };
+
+    /* the RPCs sending and committing the data of one file */
+    class WriteBehindSender {
+        Client *client;
+        FileHandle fh;
+        int error;
+
+    public:
+        WriteBehindSender(Client *client_, const FileHandle &fh_);
+
+        int getError() const;
+        bool write(uint64_t offset, const char *data, size_t len,
+                   stable_how stable);
+        bool commit();
+        /*
+         * Send the dirty data, wait for the data other workers are
+         * sending, COMMIT, and return the first error since the last
+         * flush.
+         */
+        int flush();
+
+    private:
+        void fail(int error_);
+    };
+
+    /*
+     * Flush every file of the connection with data left: gathered data
+     * has no other way to the server once it is unmounted. Returns the
+     * first error.
+     */
+    int write_behind_drain(Client *client);
+
+    /*
+     * Sends the dirty data of a file, then the write that did not fit
+     * with it, or COMMITs everything for a flush.
+     */
+    class WriteBehindWorker : public PooledWorker {
+
+        Client *client;
+        int error;
+        bool flush;
+        FileHandle fh;
+        uint64_t offset;
+        std::string data;
+
+    public:
+
+        static const char *poolName() {
+            return "writeBehind";
+        }
+
+        explicit WriteBehindWorker(WorkerPoolBase *pool_);
+        void setup(Client *client_,
+                   const v8::Local<v8::Value> &obj_fh_,
+                   uint64_t offset_,
+                   const char *data_, size_t len,
+                   const v8::Local<v8::Value> &callback_);
+        void setupFlush(Client *client_,
+                        const v8::Local<v8::Value> &obj_fh_,
+                        const v8::Local<v8::Value> &callback_);
+
+        void Execute() NFSC_OVERRIDE;
+        void HandleOKCallback() NFSC_OVERRIDE;
+
+    private:
+
+        void recycle() NFSC_OVERRIDE;
+        void send();
+    };
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <vector>
+#include <nan.h>
+#include "node_nfsc_pipeline.h"
+
+namespace NFS {
+    class Client;
+
+    /*
+     * Buffers written at an offset of a file by a Pipeline, as UNSTABLE
+     * WRITEs followed by a single COMMIT.
+     *
+     * Chunks never span two Buffers, so each WRITE is sent straight from
+     * the caller's memory. The verifier of every uncommitted chunk is
+     * kept: the chunks the COMMIT verifier does not match were lost by a
+     * server restart and are sent again, FILE_SYNC.
+     *
+     * A sparse job does not send the blocks that are all zeros, the file
+     * is grown to the end of the range if they were the last ones.
+     */
+    class WriteFileJob : public Pipeline {
+        struct Segment {
+            const char *data;
+            size_t len;
+        };
+        struct Uncommitted {
+            uint64_t offset;
+            uint32_t len;
+            char *data;
+            char verf[NFS3_WRITEVERFSIZE];
+        };
+
+        FileHandle fh;
+        stable_how stable;
+        bool sparse;
+        double skipped;
+        std::vector<Segment> segments;
+        /* segment the next chunk starts in, and its offset in the file */
+        size_t segment;
+        uint64_t segmentStart;
+        std::vector<Uncommitted> uncommitted;
+
+    public:
+        WriteFileJob(Client *client_, const v8::Local<v8::Value> &obj_fh_,
+                     const v8::Local<v8::Value> &data_, uint64_t offset,
+                     uint64_t length, uint32_t chunkSize_, unsigned depth_,
+                     stable_how stable_, bool sparse_,
+                     const v8::Local<v8::Value> &callback_);
+
+        /* add a Buffer, in order, to what is written */
+        void add(const char *data, size_t len);
+
+    protected:
+        void prepare(PipelineChunk *chunk) NFSC_OVERRIDE;
+        void execute(PipelineChunk *chunk) NFSC_OVERRIDE;
+        void deliver(PipelineChunk *chunk) NFSC_OVERRIDE;
+        bool hasFinish() const NFSC_OVERRIDE;
+        int finish() NFSC_OVERRIDE;
+        void done(int error_) NFSC_OVERRIDE;
+    };
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#pragma once
+#include <stddef.h>
+
+namespace NFS {
+
+    /*
+     * True when the len bytes at data are all zero. The scan is
+     * vectorized, with AVX2 or SSE2 as the CPU allows, and stops at the
+     * first non-zero vector, so data blocks are rejected early.
+     */
+    bool zero_block(const char *data, size_t len);
+}
@@ -25,13 +25,25 @@ class NFSError extends Error {
         this.status = status;
         this.code = code;
         this.description = desc;
-        Object.keys(info || {})
-            .forEach(index => {
-                this[index] = info[index];
-            });
+        if (info) {
+            Object.keys(info)
+                .forEach(index => {
+                    this[index] = info[index];
+                });
+        }
     }
 
+    /**
+     * Errors without extra properties are the shared, frozen template
+     * itself, so that the failure path allocates nothing; only errors
+     * carrying info get an instance of their own
+     *
+     * @param {object} info extra properties copied to the error
+     * @return {NFSError} the template or a new error instance
+     */
     newInstance(info) {
+        if (!info)
+            return this;
         return new NFSError(this.status, this.code, this.description, info);
     }
 
@@ -39,20 +51,44 @@ class NFSError extends Error {
 
 class ErrorFactory {
 
+    /**
+     * Build the error templates once, indexed both by name and by the
+     * numeric code the native layer reports (nativeCode when the entry
+     * has one, code otherwise)
+     *
+     * @param {string} errorsDb path of the JSON errors description
+     */
     constructor(errorsDb) {
         const errors = require(errorsDb);
         this.errorTemplates = {};
+        this.errorCodes = new Map();
 
         Object.keys(errors)
             .forEach(index => {
-                this.errorTemplates[index] =
+                const template = Object.freeze(
                     new NFSError(index, errors[index].code,
-                                   errors[index].description);
+                                 errors[index].description));
+                const nativeCode = errors[index].nativeCode !== undefined ?
+                    errors[index].nativeCode : errors[index].code;
+                this.errorTemplates[index] = template;
+                this.errorCodes.set(nativeCode, template);
             });
-        this.unknownError = new NFSError('UNKNOWN', -1, 'Unknown error.');
+        this.unknownError = Object.freeze(
+            new NFSError('UNKNOWN', -1, 'Unknown error.'));
     }
+
+    /**
+     * Create an error from its name or from a native error code
+     *
+     * @param {string|number} type error name or native error code
+     * @param {object} info extra properties copied to the error
+     * @return {NFSError} the shared template of the error when info is
+     *         not given, a new error instance otherwise
+     */
     create(type, info) {
-        const template = this.errorTemplates[type] || this.unknownError;
+        const template = (typeof type === 'number' ?
+                          this.errorCodes.get(type) :
+                          this.errorTemplates[type]) || this.unknownError;
         return template.newInstance(info);
     }
 }
@@ -23,6 +23,7 @@ try {
 } catch (err) {
     impl = require('../build/Debug/node-nfsc');
 }
+const stream = require('stream');
 const ErrorFactory = require('./errorFactory.js');
 
 const defaultProtocol = 'udp';
@@ -30,6 +31,8 @@ const defaultUid = process.geteuid();
 const defaultGid = process.getegid();
 const defaultAuthenticationMethod = 'unix';
 const defaultTimeout = 25;
+/* data buffered by a write stream before it is sent in one writeFile() */
+const defaultStreamHighWaterMark = 1 << 20;
 
 function int53(i) {
     if (i < Number.MIN_SAFE_INTEGER || i > Number.MAX_SAFE_INTEGER)
@@ -39,6 +42,150 @@ function int53(i) {
 
 const nfsv3ErrorFactory = new ErrorFactory('../errors/NFSv3.json');
 
+/* layout of the records of a native walk batch, see node_nfsc_walk.h */
+const walkRecordSize = 14;
+const walkTypes = [null, 'NF3REG', 'NF3DIR', 'NF3BLK', 'NF3CHR', 'NF3LNK',
+                   'NF3SOCK', 'NF3FIFO'];
+
+/* the attributes of the record at base, null without them */
+function packedAttributes(records, base) {
+    if (!records[base + 3])
+        return null;
+    return {
+        type: walkTypes[records[base + 3]],
+        mode: records[base + 4],
+        nlink: records[base + 5],
+        uid: records[base + 6],
+        gid: records[base + 7],
+        size: records[base + 8],
+        used: records[base + 9],
+        fileid: records[base + 10],
+        atime: records[base + 11],
+        mtime: records[base + 12],
+        ctime: records[base + 13],
+    };
+}
+
+/**
+ * Entries listed by walk(), kept packed as the native side built them:
+ * nothing but the paths is converted until asked for.
+ */
+class WalkBatch {
+    constructor(packed) {
+        this.paths = packed.paths;
+        this.length = packed.paths.length;
+        this._handles = packed.handles;
+        this._records = new Float64Array(packed.records.buffer,
+                                         packed.records.byteOffset,
+                                         packed.records.length / 8);
+    }
+
+    /**
+     * @param {number} i Index of the entry.
+     * @returns {string} Its path, relative to the walked directory.
+     */
+    path(i) {
+        return this.paths[i];
+    }
+
+    /**
+     * @param {number} i Index of the entry.
+     * @returns {Buffer} Its file handle, empty if the server sent none.
+     */
+    handle(i) {
+        const offset = this._records[i * walkRecordSize];
+        const length = this._records[i * walkRecordSize + 1];
+        return this._handles.slice(offset, offset + length);
+    }
+
+    /**
+     * @param {number} i Index of the entry.
+     * @returns {number} 1 for the entries of the walked directory.
+     */
+    depth(i) {
+        return this._records[i * walkRecordSize + 2];
+    }
+
+    /**
+     * @param {number} i Index of the entry.
+     * @returns {string|null} Its type, null without attributes.
+     */
+    type(i) {
+        return walkTypes[this._records[i * walkRecordSize + 3]] || null;
+    }
+
+    /**
+     * @param {number} i Index of the entry.
+     * @returns {object|null} { type, mode, nlink, uid, gid, size, used,
+     *                          fileid, atime, mtime, ctime } with times in
+     *                          fractional seconds, null without attributes.
+     */
+    attributes(i) {
+        return packedAttributes(this._records, i * walkRecordSize);
+    }
+}
+
+/**
+ * Results of statPaths(), kept packed as the native side built them:
+ * records as those of a WalkBatch, with the error of each path instead
+ * of its depth.
+ */
+class StatBatch {
+    constructor(paths, packed, error) {
+        this.paths = paths;
+        this.length = paths.length;
+        this._handles = packed.handles;
+        this._records = new Float64Array(packed.records.buffer,
+                                         packed.records.byteOffset,
+                                         packed.records.length / 8);
+        this._error = error;
+    }
+
+    /**
+     * @param {number} i Index of the path.
+     * @returns {string} The path, as given to statPaths().
+     */
+    path(i) {
+        return this.paths[i];
+    }
+
+    /**
+     * @param {number} i Index of the path.
+     * @returns {null|object} null if it resolved, else {status: string}.
+     */
+    err(i) {
+        const code = this._records[i * walkRecordSize + 2];
+        return code ? this._error(code) : null;
+    }
+
+    /**
+     * @param {number} i Index of the path.
+     * @returns {Buffer} Its file handle, empty if it did not resolve.
+     */
+    handle(i) {
+        const offset = this._records[i * walkRecordSize];
+        const length = this._records[i * walkRecordSize + 1];
+        return this._handles.slice(offset, offset + length);
+    }
+
+    /**
+     * @param {number} i Index of the path.
+     * @returns {string|null} Its type, null if it did not resolve.
+     */
+    type(i) {
+        return walkTypes[this._records[i * walkRecordSize + 3]] || null;
+    }
+
+    /**
+     * @param {number} i Index of the path.
+     * @returns {object|null} As WalkBatch.attributes(), null if it did
+     *                        not resolve.
+     */
+    attributes(i) {
+        return packedAttributes(this._records, i * walkRecordSize);
+    }
+}
+
 class V3 {
 
     /**
@@ -53,6 +200,40 @@ class V3 {
      * @param {string} options.authenticationMethod 'none', 'unix', 'krb5',
      *                                              'krb5i' or 'krb5p'
      * @param {string} options.timeout timeout in seconds for network operations
+     * @param {boolean} options.shared share the native connection, mount
+     *                  and caches included, with every other shared client
+     *                  created with the same options, in any worker thread
+     * @param {integer} options.acregmin minimum time in seconds attributes
+     *                  of a non-directory are cached (default 3)
+     * @param {integer} options.acregmax maximum time in seconds attributes
+     *                  of a non-directory are cached (default 60)
+     * @param {integer} options.acdirmin minimum time in seconds attributes
+     *                  of a directory are cached (default 30)
+     * @param {integer} options.acdirmax maximum time in seconds attributes
+     *                  of a directory are cached (default 60)
+     * @param {integer} options.acaccess time in seconds results of access()
+     *                  are cached, unless the object ctime changes
+     *                  (default 60, 0 disables)
+     * @param {boolean} options.lookupCache answer LOOKUP, including
+     *                  misses, from the native name cache while the
+     *                  directory attributes are fresh (default true)
+     * @param {integer} options.pageCache size in bytes of the native cache
+     *                  of file data, served to read() while the file
+     *                  attributes are fresh, an uncached getattr() when
+     *                  opening a file gives close-to-open consistency
+     *                  (default 0, disabled)
+     * @param {integer} options.readahead maximum size in bytes of the
+     *                  window read ahead of sequential read() calls on a
+     *                  file, it opens on the second sequential call and
+     *                  doubles with each following one (default 0,
+     *                  disabled)
+     * @param {integer} options.wsize size in bytes up to which contiguous
+     *                  writeBehind() calls are gathered (default 65536)
+     * @param {string} options.cacheFile path of a file keeping the cached
+     *                  attributes and names across restarts: written by
+     *                  saveCache() and the last unmount(), loaded by the
+     *                  next mount() of the same export; names are trusted
+     *                  again once their directory is seen unchanged
      */
     constructor(opts) {
         const options = opts ? opts : {};
@@ -68,9 +249,22 @@ class V3 {
             ? defaultAuthenticationMethod : options.authenticationMethod;
         const timeout = options.timeout === undefined
             ? defaultTimeout : options.timeout;
+        const tunables = {
+            shared: !!options.shared,
+            acregmin: options.acregmin,
+            acregmax: options.acregmax,
+            acdirmin: options.acdirmin,
+            acdirmax: options.acdirmax,
+            acaccess: options.acaccess,
+            lookupCache: options.lookupCache,
+            pageCache: options.pageCache,
+            readahead: options.readahead,
+            wsize: options.wsize,
+            cacheFile: options.cacheFile
+        };
         this.client = new impl.Client(host, exportPath, protocol,
                                       uid, gid, authenticationMethod,
-                                      timeout);
+                                      timeout, tunables);
 
         /* unix modes */
         this.MODE_IRWXU = 0o700;
@@ -155,6 +349,12 @@ class V3 {
       * from this client.  AUTH_UNIX authentication or better is
       * required.
       *
+      * The last client of a connection first flushes the data buffered
+      * by writeBehind(). When that fails, the error is returned and the
+      * client stays mounted, the data that could not be written is
+      * dropped. This is the only place gathered data is flushed without
+      * a flush() call: a client collected without unmount() loses it.
+      *
       * @param {function} callback(err: null || {status: string});
       * @returns {undefined}
       */
@@ -203,6 +403,9 @@ class V3 {
      *
      * @param {Buffer} object The file handle of an object whose attributes are
      *                        to be retrieved.
+     * @param {Object} [options]
+     * @param {boolean} options.cached answer from the attribute cache when
+     *                                 it holds fresh attributes for object
      * @param {function} callback(err: null || {status: string},
      *                            obj_attributes: Object);
      *                   On success, err is null. Continue execution with
@@ -210,7 +413,14 @@ class V3 {
      *                   On error, err contains information about the error.     
      * @returns {undefined}
      */
-    getattr(object, callback) {
+    getattr(object, options, callback) {
+        if (typeof options === 'function')
+            return this.getattr(object, null, options);
+        if (options && options.cached) {
+            const cached = this.client.cachedGetattr3(object);
+            if (cached)
+                return process.nextTick(callback, null, cached);
+        }
         this.client.getattr3(object, (err, obj_attributes) => {
             if (err)
                 return callback(this._error(err));
@@ -388,8 +598,8 @@ class V3 {
      *                        checking. count must be less than or equal to the
      *                        value of the rtmax field in the FSINFO reply
      *                        structure for the file system that contains file.
-     *                        If greater, the server may return only rtmax
-     *                        bytes, resulting in a short read.
+     *                        If greater, only rtmax bytes are read,
+     *                        resulting in a short read.
      * @param {integer} offset
      *                        The position within the file at which the read is
      *                        to begin.  An offset of 0 means to read data
@@ -864,6 +1074,496 @@ class V3 {
                             invarsec);
         });
     }
+
+    /**
+     * Write through a buffer per file: writes contiguous to the data
+     * buffered for the file are gathered in memory up to wsize bytes, and
+     * their callback runs at once. The data is sent with UNSTABLE WRITEs
+     * and only guaranteed to be on stable storage after flush().
+     *
+     * Data still buffered is not seen by read() or write() calls on the
+     * same file, flush() it first. It is lost if the client is collected
+     * without unmount().
+     *
+     * @param {Buffer} object The file handle of the file to write to.
+     * @param {number} offset The position within the file at which the
+     *                        write is to begin.
+     * @param {Buffer} data The data to write, copied before returning.
+     * @param {function} callback(err: null || {status: string});
+     *                   On error, err contains information about the error
+     *                   of the WRITE of this data or of data gathered
+     *                   before it.
+     * @returns {undefined}
+     */
+    writeBehind(object, offset, data, callback) {
+        const gathered = this.client.writeBehind3(object, offset, data,
+            err => callback(err ? this._error(err) : null));
+        if (gathered)
+            process.nextTick(callback, null);
+    }
+
+    /**
+     * Send the data buffered by writeBehind() for a file and COMMIT it.
+     * WRITEs the server lost in a restart, noticed by a change of the
+     * write verifier, are sent again.
+     *
+     * @param {Buffer} object The file handle of the file to flush.
+     * @param {function} callback(err: null || {status: string});
+     *                   On error, err contains the first error met since
+     *                   the previous flush of the file.
+     * @returns {undefined}
+     */
+    flush(object, callback) {
+        this.client.flush3(object,
+                           err => callback(err ? this._error(err) : null));
+    }
+
+    /**
+     * Resolve a slash separated path relative to a directory in one native
+     * job, instead of a lookup() round trip through JS per component.
+     * Components are answered by the lookup cache when it holds them.
+     *
+     * @param {Buffer} dir The file handle of the directory to start from.
+     * @param {string} path The path to resolve, '.' and empty components
+     *                      are skipped, '..' is looked up on the server.
+     * @param {Object} [options]
+     * @param {boolean} options.followSymlinks follow symbolic links met
+     *                  on the way, the last component included, absolute
+     *                  targets are resolved from the mount root
+     * @param {boolean} options.intermediates also return the handle of
+     *                  every directory walked through
+     * @param {function} callback(err: null || {status: string},
+     *                            object: Buffer,
+     *                            obj_attributes: Object,
+     *                            handles: Buffer[] || undefined);
+     *                   On success, err is null. Continue execution with
+     *                   the handle of the path and its attributes.
+     *                   On error, err contains information about the error
+     *                   of the first component that failed.
+     * @returns {undefined}
+     */
+    resolvePath(dir, path, options, callback) {
+        if (typeof options === 'function')
+            return this.resolvePath(dir, path, null, options);
+        this.client.resolvePath(dir, path, options,
+                                (err, object, obj_attributes, handles) => {
+                                    if (err)
+                                        return callback(this._error(err));
+                                    return callback(null, object,
+                                                    obj_attributes,
+                                                    handles);
+                                });
+    }
+
+    /**
+     * Retrieve the handles and attributes of many paths relative to a
+     * directory in one native call. The paths are grouped by parent
+     * directory, each parent is looked up once and several of them are
+     * looked in at once, each over its own connection to the server.
+     * Symbolic links are not followed.
+     *
+     * @param {Buffer} dir The file handle of the directory to start from.
+     * @param {string[]} paths The paths to stat.
+     * @param {function} callback(err: null || {status: string},
+     *                            results: StatBatch);
+     *                   On success, err is null and results packs, for
+     *                   each i of paths, results.err(i), null ||
+     *                   {status: string}, results.handle(i) and
+     *                   results.attributes(i), with times in fractional
+     *                   seconds: a path that failed to resolve does not
+     *                   fail the whole call.
+     * @returns {undefined}
+     */
+    statPaths(dir, paths, callback) {
+        this.client.statPaths(dir, paths, (err, packed) => {
+            if (err)
+                return callback(this._error(err));
+            return callback(null, new StatBatch(paths, packed,
+                                                code => this._error(code)));
+        });
+    }
+
+    /**
+     * Read a range of a file in one native call. The range is cut in
+     * chunks of which up to options.depth are read at once, each over
+     * its own connection to the server, and landed directly in the
+     * returned Buffer.
+     *
+     * @param {Buffer} object The file handle of the file to read.
+     * @param {object} [options] { offset: number (0),
+     *                   length: number (up to the end of the file),
+     *                   chunkSize: number (the rtmax of the server),
+     *                   depth: number (4), chunks: boolean (false) }
+     *                   With chunks set, the data is returned as one
+     *                   Buffer per chunk, for ranges too large for a
+     *                   single Buffer.
+     * @param {function} callback(err: null || {status: string},
+     *                            data: Buffer || Buffer[])
+     * @returns {undefined}
+     */
+    readFile(object, options, callback) {
+        if (typeof options === 'function') {
+            callback = options;
+            options = {};
+        }
+        this.client.readFile(object, options || {}, (err, data) => {
+            if (err)
+                return callback(this._error(err));
+            return callback(null, data);
+        });
+    }
+
+    /**
+     * Write Buffers at an offset of a file in one native call. The data
+     * is cut in chunks of which up to options.depth are written at once,
+     * each over its own connection to the server, as UNSTABLE WRITEs
+     * followed by a single COMMIT. Chunks the server lost by restarting
+     * before the COMMIT are sent again.
+     *
+     * @param {Buffer} object The file handle of the file to write.
+     * @param {Buffer|Buffer[]} data The data, written back to back.
+     * @param {object} [options] { offset: number (0),
+     *                   chunkSize: number (the wtmax of the server),
+     *                   depth: number (4),
+     *                   stable: number (WRITE_UNSTABLE),
+     *                   sparse: boolean (false) skip the blocks that are
+     *                           all zeros, the file must read as zeros
+     *                           there already (new or truncated) }
+     *                   With stable set to WRITE_FILE_SYNC or
+     *                   WRITE_DATA_SYNC, no COMMIT is needed.
+     * @param {function} callback(err: null || {status: string},
+     *                            count: number, skipped: number) skipped
+     *                            is the part of count that was not sent
+     * @returns {undefined}
+     */
+    writeFile(object, data, options, callback) {
+        if (typeof options === 'function') {
+            callback = options;
+            options = {};
+        }
+        this.client.writeFile(object, data, options || {},
+                              (err, count, skipped) => {
+                                  if (err)
+                                      return callback(this._error(err));
+                                  return callback(null, count, skipped);
+                              });
+    }
+
+    /**
+     * Copy a range of a file to a file of this or another mounted client
+     * in one native call: chunks are READ and then sent as UNSTABLE
+     * WRITEs without ever reaching JS, up to options.depth at once, and
+     * a single COMMIT ends the copy. The destination is not truncated.
+     *
+     * @param {Buffer} object The file handle of the file to copy.
+     * @param {V3} destination The client dstObject is reached through.
+     * @param {Buffer} dstObject The file handle of the file to write.
+     * @param {object} [options] { offset: number (0),
+     *                   length: number (up to the end of the file),
+     *                   dstOffset: number (offset),
+     *                   chunkSize: number (the lower of the rtmax of the
+     *                              source and the wtmax of the
+     *                              destination),
+     *                   depth: number (4),
+     *                   attributes: boolean (false) also copy mode, owner
+     *                               and times,
+     *                   sparse: boolean (false) skip the blocks that are
+     *                           all zeros, the destination must read as
+     *                           zeros there already }
+     * @param {function} callback(err: null || {status: string},
+     *                            count: number, skipped: number) skipped
+     *                            is the part of count that was not sent
+     * @returns {undefined}
+     */
+    copy(object, destination, dstObject, options, callback) {
+        if (typeof options === 'function') {
+            callback = options;
+            options = {};
+        }
+        this.client.copy(object, destination.client, dstObject,
+                         options || {}, (err, count, skipped) => {
+                             if (err)
+                                 return callback(this._error(err));
+                             return callback(null, count, skipped);
+                         });
+    }
+
+    /**
+     * Hash a range of a file in one native call. Chunks are read as by
+     * readFile() and hashed in the threadpool as they arrive, the data
+     * itself never reaches JS. CRC32C uses the SSE4.2 instruction and
+     * SHA-256 the SHA extensions when the CPU has them.
+     *
+     * @param {Buffer} object The file handle of the file to hash.
+     * @param {object} [options] { offset: number (0),
+     *                   length: number (up to the end of the file),
+     *                   algorithms: string[] (['sha256']) any of 'crc32c',
+     *                               'sha256' and 'xxhash64',
+     *                   chunkSize: number (the rtmax of the server),
+     *                   depth: number (4) }
+     * @param {function} callback(err: null || {status: string},
+     *                            digests: {algorithm: hex string},
+     *                            count: number)
+     * @returns {undefined}
+     */
+    checksum(object, options, callback) {
+        if (typeof options === 'function') {
+            callback = options;
+            options = {};
+        }
+        this.client.checksum(object, options || {},
+                             (err, digests, count) => {
+                                 if (err)
+                                     return callback(this._error(err));
+                                 return callback(null, digests, count);
+                             });
+    }
+
+    /**
+     * Download a range of a file to a local file descriptor in one
+     * native call. Chunks are READ up to options.depth at once and each
+     * is written with pwrite() at its position by the thread that read
+     * it, the data never becomes a Buffer. fd must stay open until the
+     * callback runs.
+     *
+     * @param {Buffer} object The file handle of the file to read.
+     * @param {number} fd A local file descriptor open for writing.
+     * @param {object} [options] { offset: number (0),
+     *                   length: number (up to the end of the file),
+     *                   fdOffset: number (offset) where to write in fd,
+     *                   chunkSize: number (the rtmax of the server),
+     *                   depth: number (4),
+     *                   sync: boolean (false) fdatasync() fd at the end }
+     * @param {function} callback(err: null || {status: string,
+     *                                          errno: number},
+     *                            count: number)
+     *                   When writing fd fails, err.status is
+     *                   NFSC_ELOCALWRITE and err.errno the errno of the
+     *                   failed pwrite() or fdatasync().
+     * @returns {undefined}
+     */
+    downloadToFd(object, fd, options, callback) {
+        if (typeof options === 'function') {
+            callback = options;
+            options = {};
+        }
+        this.client.downloadToFd(object, fd, options || {}, (err, count) => {
+            if (err)
+                return callback(this._error(err, count === undefined ?
+                                            undefined : { errno: count }));
+            return callback(null, count);
+        });
+    }
+
+    /**
+     * Open a Readable stream on a range of a file. Chunks are read ahead
+     * natively, up to options.depth at once, and pushed without a copy;
+     * reading pauses while the stream is above its highWaterMark.
+     *
+     * @param {Buffer} object The file handle of the file to read.
+     * @param {object} [options] { offset: number (0),
+     *                   length: number (up to the end of the file),
+     *                   chunkSize: number (the rtmax of the server),
+     *                   depth: number (4),
+     *                   checksum: string[] hash what is read, as by
+     *                             checksum(),
+     *                   highWaterMark: number (1 MiB) }
+     * @returns {stream.Readable} Emits {status: string} errors and, with
+     *          options.checksum, 'checksum' with the digests before 'end'.
+     */
+    createReadStream(object, options) {
+        options = options || {};
+        let transfer = null;
+        const readable = new stream.Readable({
+            highWaterMark: options.highWaterMark ||
+                defaultStreamHighWaterMark,
+            read: () => {
+                if (transfer)
+                    transfer.resume();
+            },
+        });
+        readable._destroy = (err, callback) => {
+            if (transfer)
+                transfer.abort();
+            callback(err);
+        };
+        transfer = this.client.readStream(object, options,
+                                          data => readable.push(data),
+                                          (err, digests) => {
+                                              transfer = null;
+                                              if (!err && digests)
+                                                  readable.emit('checksum',
+                                                                digests);
+                                              if (!err)
+                                                  readable.push(null);
+                                              else if (!readable.destroyed)
+                                                  readable.destroy(
+                                                      this._error(err));
+                                          });
+        return readable;
+    }
+
+    /**
+     * Open a Writable stream at an offset of a file. Writes return as
+     * soon as they are buffered; what is buffered, up to highWaterMark,
+     * is then sent by a single writeFile() while the next writes buffer.
+     *
+     * @param {Buffer} object The file handle of the file to write.
+     * @param {object} [options] { offset: number (0),
+     *                   chunkSize: number (the wtmax of the server),
+     *                   depth: number (4),
+     *                   stable: number (WRITE_UNSTABLE),
+     *                   sparse: boolean (false),
+     *                   highWaterMark: number (1 MiB) }
+     * @returns {stream.Writable} Emits {status: string} errors.
+     */
+    createWriteStream(object, options) {
+        options = options || {};
+        let offset = options.offset || 0;
+        const send = (buffers, callback) => {
+            this.writeFile(object, buffers, {
+                offset,
+                chunkSize: options.chunkSize,
+                depth: options.depth,
+                stable: options.stable,
+                sparse: options.sparse,
+            }, (err, count) => {
+                if (err)
+                    return callback(err);
+                offset += count;
+                return callback();
+            });
+        };
+        return new stream.Writable({
+            highWaterMark: options.highWaterMark ||
+                defaultStreamHighWaterMark,
+            write: (chunk, encoding, callback) => send([chunk], callback),
+            writev: (chunks, callback) =>
+                send(chunks.map(item => item.chunk), callback),
+        });
+    }
+
+    /**
+     * List the tree below a directory natively, with READDIRPLUS on up
+     * to options.concurrency directories at once, depth first. Symbolic
+     * links are not followed, directories removed during the walk are
+     * skipped. With options.filter, entries are matched natively and
+     * only those matching are handed to JS.
+     *
+     * @param {Buffer} dir The file handle of the directory to walk.
+     * @param {object} [options] { concurrency: number (8),
+     *                   maxDepth: number (unlimited, 1 lists dir only),
+     *                   batchSize: number (1024),
+     *                   filter: { names: string[] (globs on the name),
+     *                             regex: string (extended, on the path),
+     *                             types: string[] (e.g. 'NF3REG'),
+     *                             minSize, maxSize: number,
+     *                             minMtime, maxMtime: number (seconds),
+     *                             prune: string[] (globs on the names
+     *                                    of directories not to enter) } }
+     * @param {function} onBatch(batch: WalkBatch) Called with the entries
+     *                   as they are listed. Returning false pauses the
+     *                   walk until the returned handle is resumed.
+     * @param {function} callback(err: null || {status: string},
+     *                            count: number) count is the number of
+     *                   entries delivered.
+     * @returns {object} { pause(), resume(), abort() }
+     */
+    walk(dir, options, onBatch, callback) {
+        return this.client.walk(dir, options || {},
+                                packed => onBatch(new WalkBatch(packed)),
+                                (err, count) => {
+                                    if (err)
+                                        return callback(this._error(err));
+                                    return callback(null, count);
+                                });
+    }
+
+    /**
+     * Remove name from a directory and, when it is a directory, the
+     * whole tree below it, natively: the files of each directory are
+     * removed concurrently and the directories bottom-up. Entries
+     * removed by someone else meanwhile are not errors.
+     *
+     * @param {Buffer} dir The file handle of the directory holding name.
+     * @param {string} name The file or directory to remove.
+     * @param {object} [options] { concurrency: number (16) }
+     * @param {function} callback(err: null || {status: string},
+     *                            removed: { files: number,
+     *                                       directories: number })
+     *                   removed counts what was removed even on error.
+     * @returns {undefined}
+     */
+    removeTree(dir, name, options, callback) {
+        if (typeof options === 'function') {
+            callback = options;
+            options = {};
+        }
+        this.client.removeTree(dir, name, options || {},
+                               (err, files, directories) => {
+                                   const removed = { files, directories };
+                                   if (err)
+                                       return callback(this._error(err),
+                                                       removed);
+                                   return callback(null, removed);
+                               });
+    }
+
+    /**
+     * Report the hit rates of the native caches of this client
+     *
+     * @return {object} { attributes: { hits, misses, entries },
+     *                   access: { hits, misses, entries },
+     *                   names: { hits, negativeHits, misses, entries },
+     *                   pages: { hits, misses, entries },
+     *                   readahead: { hits, misses, issued, filled },
+     *                   writeBehind: { gathered, writes, commits, resent } }
+     */
+    cacheStats() {
+        return this.client.cacheStats();
+    }
+
+    /**
+     * Write the cached attributes and names to options.cacheFile, for a
+     * process restarting after a crash to start warm. Does nothing when
+     * the client has no cache file.
+     *
+     * @param {function} callback(err: null || {status: string})
+     * @returns {undefined}
+     */
+    saveCache(callback) {
+        this.client.saveCache(err => callback(err ? this._error(err) : null));
+    }
+}
+
+/**
+ * Report the state of the native worker freelists, one entry per procedure
+ *
+ * @return {object} { procedure: { allocated, reused, discarded, idle,
+ *                                  outstanding } }
+ *                  where allocated counts workers created with new, reused
+ *                  counts calls served from the freelist, discarded counts
+ *                  workers deleted because the freelist was full, idle
+ *                  is the current freelist length and outstanding the
+ *                  number of workers handed out and not yet given back
+ */
+function workerPoolStats() {
+    return impl.workerPoolStats();
+}
+
+/**
+ * Report the state of the slab allocator backing read() payloads
+ *
+ * Set NFSC_SLAB_HUGEPAGES in the environment to back slabs with huge pages.
+ *
+ * @return {object} { hugePages, classes: { size: { regions, inUse, free } } }
+ *                  where size is the chunk size in bytes, regions the
+ *                  number of 2MiB regions mapped for that size, inUse the
+ *                  number of chunks held by live Buffers and free the
+ *                  number of chunks ready for reuse
+ */
+function slabStats() {
+    return impl.slabStats();
 }
 
-module.exports = { V3 };
+module.exports = { V3, WalkBatch, workerPoolStats, slabStats };
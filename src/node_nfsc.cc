@@ -17,9 +17,37 @@
  *    Guillaume Gimenez <ggim@scality.com>
  */
 #include "node_nfsc.h"
+#include "node_nfsc_pool.h"
+#include "node_nfsc_slab.h"
+#include "node_nfsc_transfer.h"
+#include "node_nfsc_options.h"
 #include <gssrpc/rpc.h>
 #include "mount3.h"
 #include "nfs3.h"
+#ifdef DEBUG
+#include <execinfo.h>
+
+static __thread bool loop_thread = false;
+
+bool NFS::loop_wait_start(uint64_t *start)
+{
+    if (!loop_thread)
+        return false;
+    *start = uv_hrtime();
+    return true;
+}
+
+void NFS::loop_wait_end(const char *what, uint64_t start)
+{
+    void *frames[32];
+    int depth;
+
+    fprintf(stderr, "node-nfsc: event loop blocked %.3fms in %s\n",
+            (uv_hrtime() - start) / 1e6, what);
+    depth = backtrace(frames, sizeof(frames)/sizeof(*frames));
+    backtrace_symbols_fd(frames, depth, 2);
+}
+#endif
 
 NAN_MODULE_INIT(NFS::Client::Init) {
     v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
@@ -47,29 +75,84 @@ NAN_MODULE_INIT(NFS::Client::Init) {
     SetPrototypeMethod(tpl, "symlink3", SymLink3);
     SetPrototypeMethod(tpl, "readlink3", ReadLink3);
     SetPrototypeMethod(tpl, "fsstat3", FsStat3);
+    SetPrototypeMethod(tpl, "cachedGetattr3", CachedGetAttr3);
+    SetPrototypeMethod(tpl, "cacheStats", CacheStats);
+    SetPrototypeMethod(tpl, "saveCache", SaveCache);
+    SetPrototypeMethod(tpl, "resolvePath", ResolvePath);
+    SetPrototypeMethod(tpl, "statPaths", StatPaths);
+    SetPrototypeMethod(tpl, "readFile", ReadFile);
+    SetPrototypeMethod(tpl, "writeFile", WriteFile);
+    SetPrototypeMethod(tpl, "readStream", ReadStream);
+    SetPrototypeMethod(tpl, "copy", Copy);
+    SetPrototypeMethod(tpl, "checksum", Checksum);
+    SetPrototypeMethod(tpl, "downloadToFd", DownloadToFd);
+    SetPrototypeMethod(tpl, "walk", WalkTree);
+    SetPrototypeMethod(tpl, "removeTree", RmTree);
+    SetPrototypeMethod(tpl, "writeBehind3", WriteBehind3);
+    SetPrototypeMethod(tpl, "flush3", Flush3);
 
     constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
     Nan::Set(target, Nan::New("Client").ToLocalChecked(),
         Nan::GetFunction(tpl).ToLocalChecked());
+    Nan::SetMethod(target, "workerPoolStats", WorkerPoolStats);
+    Nan::SetMethod(target, "slabStats", SlabStats);
+    NFS::Transfer::Init();
+#ifdef DEBUG
+    loop_thread = true;
+#endif
 }
 
 
 
 NFS::Serialize::Serialize(NFS::Client *client_)
     : client(client_) {
-    sem_wait(&client->sem);
+    NFSC_LOOP_WAIT("Serialize", sem_wait(&client->connection->sem));
 }
 
 
 
 NFS::Serialize::~Serialize() {
-    sem_post(&client->sem);
+    sem_post(&client->connection->sem);
 }
 
 
+static __thread Nan::Persistent<v8::Function> *my_constructor = NULL;
+
+static void
+constructor_cleanup(void *)
+{
+    my_constructor->Reset();
+    delete my_constructor;
+    my_constructor = NULL;
+}
+
+Nan::Persistent<v8::Function> &NFS::Client::constructor()
+{
+    if (!my_constructor) {
+        my_constructor = new Nan::Persistent<v8::Function>();
+        NFSC_ADD_CLEANUP_HOOK(constructor_cleanup, NULL);
+    }
+    return *my_constructor;
+}
+
+bool NFS::Client::isInstance(const v8::Local<v8::Value> &value)
+{
+    if (!value->IsObject())
+        return false;
+    v8::Local<v8::Value> prototype = Nan::New(constructor())
+            ->Get(Nan::New("prototype").ToLocalChecked());
+    return v8::Local<v8::Object>::Cast(value)->GetPrototype()
+            ->StrictEquals(prototype);
+}
+
+NFS::Connection *NFS::Client::getConnection()
+{
+    return connection;
+}
+
 CLIENT *NFS::Client::getClient()
 {
-    return client;
+    return connection->getClient();
 }
 
 const char *NFS::Client::getHost() const
@@ -84,27 +167,17 @@ const char *NFS::Client::getExportPath() const
 
 void NFS::Client::setClient(CLIENT *client_)
 {
-    if (client) {
-        if (client->cl_auth)
-            auth_destroy(client->cl_auth);
-        clnt_destroy(client);
-    }
-    client = client_;
+    connection->setClient(client_);
 }
 
 CLIENT *NFS::Client::getMountClient()
 {
-    return mntClient;
+    return connection->getMountClient();
 }
 
 void NFS::Client::setMountClient(CLIENT *client_)
 {
-    if (mntClient) {
-        if (mntClient->cl_auth)
-            auth_destroy(mntClient->cl_auth);
-        clnt_destroy(mntClient);
-    }
-    mntClient = client_;
+    connection->setMountClient(client_);
 }
 
 void NFS::Client::setMounted(bool v)
@@ -115,24 +188,17 @@ void NFS::Client::setMounted(bool v)
 
 nfs_fh3 &NFS::Client::getRootFh()
 {
-    return *rootFh;
+    return connection->getRootFh();
 }
 
 void NFS::Client::freeRootFh()
 {
-    if (rootFh) {
-        delete[] rootFh->data.data_val;
-        delete rootFh;
-    }
+    connection->freeRootFh();
 }
 
 void NFS::Client::setRootFh(char *data, size_t len)
 {
-    freeRootFh();
-    rootFh = new nfs_fh3;
-    rootFh->data.data_val = new char[len];
-    rootFh->data.data_len = len;
-    memcpy(rootFh->data.data_val, data, len);
+    connection->setRootFh(data, len);
 }
 
 const char *NFS::Client::getProtocol() const
@@ -171,13 +237,11 @@ NFS::Client::Client(const v8::Local<v8::Value> &host_,
                     const v8::Local<v8::Value> &uid_,
                     const v8::Local<v8::Value> &gid_,
                     const v8::Local<v8::Value> &authenticationMethod_,
-                    const v8::Local<v8::Value> &timeout_) :
+                    const v8::Local<v8::Value> &timeout_,
+                    const v8::Local<v8::Value> &options_) :
     Nan::ObjectWrap(),
-    sem(),
-    client(NULL),
-    mntClient(NULL),
+    connection(NULL),
     mounted(false),
-    rootFh(NULL),
     host(host_),
     exportPath(exportPath_),
     protocol(protocol_),
@@ -186,19 +250,65 @@ NFS::Client::Client(const v8::Local<v8::Value> &host_,
     authenticationMethod(authenticationMethod_),
     timeout({timeout_->Int32Value(), 0})
 {
-    sem_init(&sem, 0, 1);
+    unsigned acregmin = option_uint(options_, "acregmin", NFSC_ACREGMIN);
+    unsigned acregmax = option_uint(options_, "acregmax", NFSC_ACREGMAX);
+    unsigned acdirmin = option_uint(options_, "acdirmin", NFSC_ACDIRMIN);
+    unsigned acdirmax = option_uint(options_, "acdirmax", NFSC_ACDIRMAX);
+    unsigned acaccess = option_uint(options_, "acaccess", NFSC_ACCESS_TIMEOUT);
+    bool lookupCache = option_bool(options_, "lookupCache", true);
+    unsigned pageCache = option_uint(options_, "pageCache", 0);
+    unsigned readahead = option_uint(options_, "readahead", 0);
+    unsigned wsize = option_uint(options_, "wsize", NFSC_WSIZE);
+    std::string cacheFile = option_string(options_, "cacheFile");
+    std::string key;
+    key.append(*host).push_back(0);
+    key.append(*exportPath).push_back(0);
+    key.append(*protocol).push_back(0);
+    key.append(*authenticationMethod).push_back(0);
+    key.append(std::to_string(uid)).push_back(0);
+    key.append(std::to_string(gid)).push_back(0);
+    key.append(std::to_string(timeout.tv_sec)).push_back(0);
+    key.append(std::to_string(acregmin)).push_back(0);
+    key.append(std::to_string(acregmax)).push_back(0);
+    key.append(std::to_string(acdirmin)).push_back(0);
+    key.append(std::to_string(acdirmax)).push_back(0);
+    key.append(std::to_string(acaccess)).push_back(0);
+    key.append(lookupCache ? "1" : "0").push_back(0);
+    key.append(std::to_string(pageCache)).push_back(0);
+    key.append(std::to_string(readahead)).push_back(0);
+    key.append(std::to_string(wsize)).push_back(0);
+    key.append(cacheFile);
+    connection = Connection::acquire(key,
+                                     option_bool(options_, "shared", false));
+    /* configure() empties the caches, a shared connection may be in use */
+    connection->configureOnce([&]() {
+        connection->getAttrCache().configure(acregmin, acregmax,
+                                             acdirmin, acdirmax);
+        connection->getAccessCache().configure(acaccess);
+        connection->getNameCache().configure(lookupCache);
+        connection->getPageCache().configure(pageCache);
+        connection->getReadahead().configure(readahead);
+        connection->getWriteBehind().configure(wsize);
+        connection->getCacheFile().configure(cacheFile);
+    });
 }
 
 NFS::Client::~Client()
 {
-    setClient(NULL);
-    setMountClient(NULL);
+    /*
+     * No UMNT here, the mount is dropped when the connection goes. No
+     * flush either, this runs from the GC on the loop thread: writes
+     * still gathered when the last client goes away unmounted are lost.
+     */
+    if (mounted)
+        connection->removeMount();
+    Connection::release(connection);
 }
 
 NAN_METHOD(NFS::Client::New) {
     bool typeError = true;
-    if (info.Length() != 7) {
-        Nan::ThrowSyntaxError("Must be called with 7 parameters");
+    if (info.Length() != 7 && info.Length() != 8) {
+        Nan::ThrowSyntaxError("Must be called with 7 or 8 parameters");
         return;
     }
     if (!info[0]->IsString())
@@ -216,6 +326,8 @@ NAN_METHOD(NFS::Client::New) {
                             " must be a String");
     else if (!info[6]->IsInt32())
         Nan::ThrowTypeError("Parameter 7, timeout must be a signed integer");
+    else if (!info[7]->IsUndefined() && !info[7]->IsObject())
+        Nan::ThrowTypeError("Parameter 8, options must be an object");
     else
         typeError = false;
     if (typeError)
@@ -225,11 +337,11 @@ NAN_METHOD(NFS::Client::New) {
         NFS::Client *obj = new NFS::Client(info[0], info[1],
                 info[2], info[3],
                 info[4], info[5],
-                info[6]);
+                info[6], info[7]);
         obj->Wrap(info.This());
         info.GetReturnValue().Set(info.This());
     } else {
-        const int argc = 7;
+        const int argc = 8;
         v8::Local<v8::Value> argv[] = {
             info[0],
             info[1],
@@ -237,7 +349,8 @@ NAN_METHOD(NFS::Client::New) {
             info[3],
             info[4],
             info[5],
-            info[6]
+            info[6],
+            info[7]
         };
         v8::Local<v8::Function> cons = Nan::New(constructor());
         info.GetReturnValue().Set(Nan::NewInstance(cons, argc, argv)
@@ -245,4 +358,76 @@ NAN_METHOD(NFS::Client::New) {
     }
 }
 
-NODE_MODULE(NFS, NFS::Client::Init)
+// ( ) -> { attributes: { hits, misses, entries },
+//          access: { hits, misses, entries },
+//          names: { hits, negativeHits, misses, entries },
+//          pages: { hits, misses, entries },
+//          readahead: { hits, misses, issued, filled },
+//          writeBehind: { gathered, writes, commits, resent } }
+NAN_METHOD(NFS::Client::CacheStats) {
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    AttrCache &attrCache = obj->connection->getAttrCache();
+    v8::Local<v8::Object> stats = Nan::New<v8::Object>();
+    v8::Local<v8::Object> attributes = Nan::New<v8::Object>();
+    attributes->Set(Nan::New("hits").ToLocalChecked(),
+                    Nan::New(attrCache.getHits()));
+    attributes->Set(Nan::New("misses").ToLocalChecked(),
+                    Nan::New(attrCache.getMisses()));
+    attributes->Set(Nan::New("entries").ToLocalChecked(),
+                    Nan::New(double(attrCache.getSize())));
+    stats->Set(Nan::New("attributes").ToLocalChecked(), attributes);
+    AccessCache &accessCache = obj->connection->getAccessCache();
+    v8::Local<v8::Object> access = Nan::New<v8::Object>();
+    access->Set(Nan::New("hits").ToLocalChecked(),
+                Nan::New(accessCache.getHits()));
+    access->Set(Nan::New("misses").ToLocalChecked(),
+                Nan::New(accessCache.getMisses()));
+    access->Set(Nan::New("entries").ToLocalChecked(),
+                Nan::New(double(accessCache.getSize())));
+    stats->Set(Nan::New("access").ToLocalChecked(), access);
+    NameCache &nameCache = obj->connection->getNameCache();
+    v8::Local<v8::Object> names = Nan::New<v8::Object>();
+    names->Set(Nan::New("hits").ToLocalChecked(),
+               Nan::New(nameCache.getHits()));
+    names->Set(Nan::New("negativeHits").ToLocalChecked(),
+               Nan::New(nameCache.getNegativeHits()));
+    names->Set(Nan::New("misses").ToLocalChecked(),
+               Nan::New(nameCache.getMisses()));
+    names->Set(Nan::New("entries").ToLocalChecked(),
+               Nan::New(double(nameCache.getSize())));
+    stats->Set(Nan::New("names").ToLocalChecked(), names);
+    PageCache &pageCache = obj->connection->getPageCache();
+    v8::Local<v8::Object> pages = Nan::New<v8::Object>();
+    pages->Set(Nan::New("hits").ToLocalChecked(),
+               Nan::New(pageCache.getHits()));
+    pages->Set(Nan::New("misses").ToLocalChecked(),
+               Nan::New(pageCache.getMisses()));
+    pages->Set(Nan::New("entries").ToLocalChecked(),
+               Nan::New(double(pageCache.getSize())));
+    stats->Set(Nan::New("pages").ToLocalChecked(), pages);
+    Readahead &readahead = obj->connection->getReadahead();
+    v8::Local<v8::Object> ahead = Nan::New<v8::Object>();
+    ahead->Set(Nan::New("hits").ToLocalChecked(),
+               Nan::New(readahead.getHits()));
+    ahead->Set(Nan::New("misses").ToLocalChecked(),
+               Nan::New(readahead.getMisses()));
+    ahead->Set(Nan::New("issued").ToLocalChecked(),
+               Nan::New(readahead.getIssued()));
+    ahead->Set(Nan::New("filled").ToLocalChecked(),
+               Nan::New(readahead.getFilled()));
+    stats->Set(Nan::New("readahead").ToLocalChecked(), ahead);
+    WriteBehind &writeBehind = obj->connection->getWriteBehind();
+    v8::Local<v8::Object> behind = Nan::New<v8::Object>();
+    behind->Set(Nan::New("gathered").ToLocalChecked(),
+                Nan::New(writeBehind.getGathered()));
+    behind->Set(Nan::New("writes").ToLocalChecked(),
+                Nan::New(writeBehind.getWrites()));
+    behind->Set(Nan::New("commits").ToLocalChecked(),
+                Nan::New(writeBehind.getCommits()));
+    behind->Set(Nan::New("resent").ToLocalChecked(),
+                Nan::New(writeBehind.getResent()));
+    stats->Set(Nan::New("writeBehind").ToLocalChecked(), behind);
+    info.GetReturnValue().Set(stats);
+}
+
+NAN_MODULE_WORKER_ENABLED(NFS, NFS::Client::Init)
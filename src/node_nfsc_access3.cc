@@ -38,22 +38,66 @@ NAN_METHOD(NFS::Client::Access3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::Access3Worker(obj, info[0], info[1], callback));
+    NFS::Access3Worker *worker =
+            NFS::WorkerPool<NFS::Access3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::Access3Worker::Access3Worker(NFS::Client *client_,
-                                const v8::Local<v8::Value> &obj_fh_,
-                                const v8::Local<v8::Value> &access_,
-                                Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t)xdr_ACCESS3res, callback)
+NFS::Access3Worker::Access3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t)xdr_ACCESS3res)
+{}
+
+bool NFS::Access3Worker::setup(NFS::Client *client_,
+                               const v8::Local<v8::Value> &obj_fh_,
+                               const v8::Local<v8::Value> &access_,
+                               const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
     args.object.data.data_val = node::Buffer::Data(obj_fh_);
     args.object.data.data_len = node::Buffer::Length(obj_fh_);
     args.access = access_->Uint32Value();
+    return true;
 }
 
-void NFS::Access3Worker::procFailure()
+void NFS::Access3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    if (res.status == NFS3_OK) {
+        cache.put(args.object, res.ACCESS3res_u.resok.obj_attributes);
+        client->getConnection()->getAccessCache().put(
+                args.object, client->getUid(), client->getGid(),
+                res.ACCESS3res_u.resok.obj_attributes,
+                args.access, res.ACCESS3res_u.resok.access);
+    } else {
+        cache.put(args.object, res.ACCESS3res_u.resfail.obj_attributes);
+    }
+}
+
+bool NFS::Access3Worker::fromCache()
+{
+    AccessCache &access = client->getConnection()->getAccessCache();
+    ACCESS3resok &resok = res.ACCESS3res_u.resok;
+    fattr3 attrs;
+    bool fresh;
+
+    if (!access.isEnabled())
+        return false;
+    fresh = client->getConnection()->getAttrCache().get(args.object, &attrs);
+    if (!access.get(args.object, client->getUid(), client->getGid(),
+                    fresh ? &attrs : NULL, args.access, &resok.access))
+        return false;
+    resok.obj_attributes.attributes_follow = fresh;
+    if (fresh)
+        resok.obj_attributes.post_op_attr_u.attributes = attrs;
+    res.status = NFS3_OK;
+    return true;
+}
+
+void NFS::Access3Worker::procSuccess()
 {
     v8::Local<v8::Value> obj_attrs;
     if (res.ACCESS3res_u.resok.obj_attributes.attributes_follow)
@@ -69,11 +113,10 @@ void NFS::Access3Worker::procFailure()
     callback->Call(sizeof(argv)/sizeof(*argv), argv);
 }
 
-void NFS::Access3Worker::procSuccess()
+void NFS::Access3Worker::procFailure()
 {
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked()
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
     };
     callback->Call(1, argv);
 }
-
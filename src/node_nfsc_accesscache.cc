@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include "node_nfsc_accesscache.h"
+
+#define NS_PER_SEC 1000000000ULL
+
+NFS::AccessCache::AccessCache()
+    : lock(),
+      entries(NFSC_ACCESS_CACHE_SIZE),
+      timeout(NFSC_ACCESS_TIMEOUT * NS_PER_SEC),
+      hits(0),
+      misses(0)
+{}
+
+void NFS::AccessCache::configure(unsigned timeout_)
+{
+    std::lock_guard<std::mutex> my(lock);
+    timeout = timeout_ * NS_PER_SEC;
+    entries.clear();
+}
+
+bool NFS::AccessCache::isEnabled()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return timeout != 0;
+}
+
+bool NFS::AccessCache::get(const nfs_fh3 &fh, uint32_t uid, uint32_t gid,
+                           const fattr3 *attrs, uint32_t requested,
+                           uint32_t *granted)
+{
+    Key key = { FileHandle(fh), uid, gid };
+    std::lock_guard<std::mutex> my(lock);
+    Entry *entry = entries.find(key);
+    if (entry &&
+        (entry->expires <= monotonicTime() ||
+         (attrs && (!entry->hasCtime ||
+                    entry->ctime.seconds != attrs->ctime.seconds ||
+                    entry->ctime.nseconds != attrs->ctime.nseconds)))) {
+        entries.erase(key);
+        entry = NULL;
+    }
+    if (!entry || (requested & ~entry->checked)) {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    *granted = entry->granted & requested;
+    return true;
+}
+
+void NFS::AccessCache::put(const nfs_fh3 &fh, uint32_t uid, uint32_t gid,
+                           const post_op_attr &attrs, uint32_t requested,
+                           uint32_t granted)
+{
+    Key key = { FileHandle(fh), uid, gid };
+    std::lock_guard<std::mutex> my(lock);
+    if (!timeout)
+        return;
+    Entry &entry = entries.insert(key);
+    bool hasCtime = attrs.attributes_follow;
+    const nfstime3 &ctime = attrs.post_op_attr_u.attributes.ctime;
+    /* merge with results for the same ctime only, they never outlive it */
+    if (!entry.expires || !hasCtime || !entry.hasCtime ||
+        entry.ctime.seconds != ctime.seconds ||
+        entry.ctime.nseconds != ctime.nseconds) {
+        entry.hasCtime = hasCtime;
+        if (hasCtime)
+            entry.ctime = ctime;
+        entry.checked = 0;
+        entry.granted = 0;
+        entry.expires = monotonicTime() + timeout;
+    }
+    entry.checked |= requested;
+    entry.granted = (entry.granted & ~requested) | (granted & requested);
+}
+
+double NFS::AccessCache::getHits() const
+{
+    return hits;
+}
+
+double NFS::AccessCache::getMisses() const
+{
+    return misses;
+}
+
+size_t NFS::AccessCache::getSize()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return entries.size();
+}
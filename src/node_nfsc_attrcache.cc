@@ -0,0 +1,215 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <algorithm>
+#include "node_nfsc_attrcache.h"
+
+#define NS_PER_SEC 1000000000ULL
+
+static bool
+same_attrs(const fattr3 &a, const fattr3 &b)
+{
+    return a.size == b.size &&
+            a.mtime.seconds == b.mtime.seconds &&
+            a.mtime.nseconds == b.mtime.nseconds &&
+            a.ctime.seconds == b.ctime.seconds &&
+            a.ctime.nseconds == b.ctime.nseconds;
+}
+
+static bool
+older(const nfstime3 &a, const nfstime3 &b)
+{
+    return a.seconds < b.seconds ||
+            (a.seconds == b.seconds && a.nseconds < b.nseconds);
+}
+
+/* the file is as the cache knows it, the operation came next */
+static bool
+same_wcc(const wcc_attr &before, const fattr3 &attrs)
+{
+    return before.size == attrs.size &&
+            before.mtime.seconds == attrs.mtime.seconds &&
+            before.mtime.nseconds == attrs.mtime.nseconds &&
+            before.ctime.seconds == attrs.ctime.seconds &&
+            before.ctime.nseconds == attrs.ctime.nseconds;
+}
+
+NFS::AttrCache::AttrCache()
+    : lock(),
+      entries(NFSC_ATTR_CACHE_SIZE),
+      regmin(NFSC_ACREGMIN * NS_PER_SEC),
+      regmax(NFSC_ACREGMAX * NS_PER_SEC),
+      dirmin(NFSC_ACDIRMIN * NS_PER_SEC),
+      dirmax(NFSC_ACDIRMAX * NS_PER_SEC),
+      hits(0),
+      misses(0)
+{}
+
+void NFS::AttrCache::configure(unsigned regmin_, unsigned regmax_,
+                               unsigned dirmin_, unsigned dirmax_)
+{
+    std::lock_guard<std::mutex> my(lock);
+    regmin = regmin_ * NS_PER_SEC;
+    regmax = regmax_ * NS_PER_SEC;
+    dirmin = dirmin_ * NS_PER_SEC;
+    dirmax = dirmax_ * NS_PER_SEC;
+    if (regmin > regmax)
+        regmin = regmax;
+    if (dirmin > dirmax)
+        dirmin = dirmax;
+    entries.clear();
+}
+
+bool NFS::AttrCache::get(const nfs_fh3 &fh, fattr3 *attrs)
+{
+    FileHandle key(fh);
+    std::lock_guard<std::mutex> my(lock);
+    Entry *entry = entries.find(key);
+    if (!entry || entry->expires <= monotonicTime()) {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    *attrs = entry->attrs;
+    return true;
+}
+
+void NFS::AttrCache::put(const nfs_fh3 &fh, const fattr3 &attrs)
+{
+    FileHandle key(fh);
+    std::lock_guard<std::mutex> my(lock);
+    store(key, attrs, false);
+}
+
+/*
+ * Replies on different channels come back in any order: attributes
+ * older than the cached ones, by ctime, are stale and drop the entry,
+ * unless they follow it as the wcc_data of the next operation.
+ */
+void NFS::AttrCache::store(const FileHandle &key, const fattr3 &attrs,
+                           bool follows)
+{
+    bool dir = attrs.type == NF3DIR;
+    uint64_t min = dir ? dirmin : regmin;
+    uint64_t max = dir ? dirmax : regmax;
+    uint64_t now = monotonicTime();
+
+    if (!max)
+        return;
+    Entry *cached = entries.find(key);
+    if (cached && !follows && older(attrs.ctime, cached->attrs.ctime)) {
+        entries.erase(key);
+        return;
+    }
+    Entry &entry = cached ? *cached : entries.insert(key);
+    if (entry.timeo && same_attrs(entry.attrs, attrs)) {
+        /* revalidated, only count it once the previous timeout is over */
+        if (entry.expires <= now)
+            entry.timeo = entry.timeo * 2 < max ? entry.timeo * 2 : max;
+    } else {
+        entry.timeo = min ? min : 1;
+    }
+    entry.attrs = attrs;
+    entry.expires = now + entry.timeo;
+}
+
+void NFS::AttrCache::put(const nfs_fh3 &fh, const post_op_attr &attrs)
+{
+    if (attrs.attributes_follow)
+        put(fh, attrs.post_op_attr_u.attributes);
+    else
+        invalidate(fh);
+}
+
+void NFS::AttrCache::put(const post_op_fh3 &fh, const post_op_attr &attrs)
+{
+    if (fh.handle_follows)
+        put(fh.post_op_fh3_u.handle, attrs);
+}
+
+void NFS::AttrCache::put(const nfs_fh3 &fh, const wcc_data &wcc)
+{
+    if (!wcc.after.attributes_follow) {
+        invalidate(fh);
+        return;
+    }
+    FileHandle key(fh);
+    std::lock_guard<std::mutex> my(lock);
+    const Entry *cached = entries.peek(key);
+    store(key, wcc.after.post_op_attr_u.attributes,
+          cached && wcc.before.attributes_follow &&
+          same_wcc(wcc.before.pre_op_attr_u.attributes, cached->attrs));
+}
+
+void NFS::AttrCache::invalidate(const nfs_fh3 &fh)
+{
+    FileHandle key(fh);
+    std::lock_guard<std::mutex> my(lock);
+    entries.erase(key);
+}
+
+void NFS::AttrCache::save(std::vector<Saved> *saved)
+{
+    uint64_t now = monotonicTime();
+    std::lock_guard<std::mutex> my(lock);
+    saved->reserve(saved->size() + entries.size());
+    entries.forEach([&](const FileHandle &fh, const Entry &entry) {
+        Saved item;
+        item.fh = fh;
+        item.attrs = entry.attrs;
+        item.timeo = entry.timeo;
+        item.ttl = entry.expires > now ? entry.expires - now : 0;
+        saved->push_back(item);
+    });
+}
+
+/*
+ * Expired entries are kept for their timeout: refreshed unchanged, they
+ * stay cached as long as before the restart.
+ */
+void NFS::AttrCache::restore(const Saved &saved)
+{
+    bool dir = saved.attrs.type == NF3DIR;
+    uint64_t min = dir ? dirmin : regmin;
+    uint64_t max = dir ? dirmax : regmax;
+    uint64_t now = monotonicTime();
+
+    std::lock_guard<std::mutex> my(lock);
+    if (!max)
+        return;
+    Entry &entry = entries.insert(saved.fh);
+    entry.attrs = saved.attrs;
+    entry.timeo = std::max(std::min(saved.timeo, max), min ? min : 1);
+    entry.expires = saved.ttl ? now + std::min(saved.ttl, entry.timeo) : 0;
+}
+
+double NFS::AttrCache::getHits() const
+{
+    return hits;
+}
+
+double NFS::AttrCache::getMisses() const
+{
+    return misses;
+}
+
+size_t NFS::AttrCache::getSize()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return entries.size();
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vector>
+#include "node_nfsc.h"
+#include "node_nfsc_cachefile.h"
+#include "node_nfsc_errors3.h"
+
+/*
+ * Layout of the file, in host byte order as it is only read back by
+ * the same build: a header followed by the attribute, directory and
+ * name records, each name record being followed by the name, padded to
+ * 8 bytes.
+ */
+struct cache_file_header {
+    char magic[8];
+    uint32_t version;
+    /* records embed fattr3 as is */
+    uint32_t fattrSize;
+    uint64_t fsid;
+    uint32_t rootLen;
+    char root[NFS3_FHSIZE];
+    uint32_t attrCount;
+    uint32_t dirCount;
+    uint32_t nameCount;
+    /* CLOCK_REALTIME, in nanoseconds */
+    uint64_t savedAt;
+};
+
+struct cache_file_attr {
+    uint32_t fhLen;
+    char fh[NFS3_FHSIZE];
+    uint64_t timeo;
+    uint64_t ttl;
+    fattr3 attrs;
+};
+
+struct cache_file_dir {
+    uint32_t fhLen;
+    char fh[NFS3_FHSIZE];
+    nfstime3 mtime;
+    nfstime3 ctime;
+};
+
+struct cache_file_name {
+    uint32_t dirLen;
+    char dir[NFS3_FHSIZE];
+    uint32_t fhLen;
+    char fh[NFS3_FHSIZE];
+    uint32_t negative;
+    uint32_t nameLen;
+};
+
+static const char cache_file_magic[8] = "NFSCACH";
+
+static uint64_t
+realtime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static size_t
+padded(size_t len)
+{
+    return (len + 7) & ~size_t(7);
+}
+
+static void
+put_fh(uint32_t *len, char *data, const NFS::FileHandle &fh)
+{
+    *len = fh.size();
+    memcpy(data, fh.getData(), fh.size());
+}
+
+static bool
+get_fh(NFS::FileHandle *fh, uint32_t len, const char *data)
+{
+    if (len > NFS3_FHSIZE)
+        return false;
+    fh->assign(data, len);
+    return true;
+}
+
+NFS::CacheFile::CacheFile()
+    : lock(),
+      path(),
+      root(),
+      fsid(0)
+{}
+
+void NFS::CacheFile::configure(const std::string &path_)
+{
+    std::lock_guard<std::mutex> my(lock);
+    path = path_;
+}
+
+bool NFS::CacheFile::isEnabled()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return !path.empty();
+}
+
+void NFS::CacheFile::load(NFS::Connection *connection, const nfs_fh3 &root_,
+                          const fattr3 &rootAttrs)
+{
+    std::lock_guard<std::mutex> my(lock);
+    root = FileHandle(root_);
+    fsid = rootAttrs.fsid;
+    if (path.empty())
+        return;
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (!fstat(fd, &st) && size_t(st.st_size) >= sizeof(cache_file_header))
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return;
+
+    const char *p = static_cast<const char *>(map);
+    const char *end = p + st.st_size;
+    cache_file_header header;
+    memcpy(&header, p, sizeof(header));
+    p += sizeof(header);
+    FileHandle saved;
+    if (memcmp(header.magic, cache_file_magic, sizeof(header.magic)) ||
+        header.version != NFSC_CACHE_FILE_VERSION ||
+        header.fattrSize != sizeof(fattr3) ||
+        header.fsid != fsid ||
+        !get_fh(&saved, header.rootLen, header.root) ||
+        saved != root ||
+        size_t(end - p) / sizeof(cache_file_attr) < header.attrCount) {
+        munmap(map, st.st_size);
+        return;
+    }
+
+    AttrCache &attrCache = connection->getAttrCache();
+    NameCache &nameCache = connection->getNameCache();
+    uint64_t now = realtime();
+    uint64_t elapsed = now > header.savedAt ? now - header.savedAt : 0;
+    for (uint32_t i = 0 ; i < header.attrCount ; ++i) {
+        cache_file_attr record;
+        AttrCache::Saved item;
+        memcpy(&record, p, sizeof(record));
+        p += sizeof(record);
+        if (!get_fh(&item.fh, record.fhLen, record.fh))
+            continue;
+        item.attrs = record.attrs;
+        item.timeo = record.timeo;
+        item.ttl = record.ttl > elapsed ? record.ttl - elapsed : 0;
+        attrCache.restore(item);
+    }
+    if (size_t(end - p) / sizeof(cache_file_dir) < header.dirCount) {
+        munmap(map, st.st_size);
+        return;
+    }
+    for (uint32_t i = 0 ; i < header.dirCount ; ++i) {
+        cache_file_dir record;
+        NameCache::SavedDir item;
+        memcpy(&record, p, sizeof(record));
+        p += sizeof(record);
+        if (!get_fh(&item.fh, record.fhLen, record.fh))
+            continue;
+        item.mtime = record.mtime;
+        item.ctime = record.ctime;
+        nameCache.restore(item);
+    }
+    NameCache::SavedName item;
+    for (uint32_t i = 0 ; i < header.nameCount ; ++i) {
+        cache_file_name record;
+        if (size_t(end - p) < sizeof(record))
+            break;
+        memcpy(&record, p, sizeof(record));
+        p += sizeof(record);
+        if (size_t(end - p) < padded(record.nameLen))
+            break;
+        item.name.assign(p, record.nameLen);
+        p += padded(record.nameLen);
+        if (!get_fh(&item.dir, record.dirLen, record.dir) ||
+            !get_fh(&item.fh, record.fhLen, record.fh) ||
+            item.name.find('\0') != std::string::npos)
+            continue;
+        item.negative = record.negative;
+        nameCache.restore(item);
+    }
+    munmap(map, st.st_size);
+}
+
+/*
+ * Written to a temporary file renamed over the previous one, so that a
+ * crash never leaves a truncated cache file behind.
+ */
+int NFS::CacheFile::save(NFS::Connection *connection)
+{
+    std::lock_guard<std::mutex> my(lock);
+    if (path.empty())
+        return 0;
+
+    std::vector<AttrCache::Saved> attrs;
+    std::vector<NameCache::SavedDir> dirs;
+    std::vector<NameCache::SavedName> names;
+    connection->getAttrCache().save(&attrs);
+    connection->getNameCache().save(&dirs, &names);
+
+    size_t size = sizeof(cache_file_header) +
+            attrs.size() * sizeof(cache_file_attr) +
+            dirs.size() * sizeof(cache_file_dir);
+    for (size_t i = 0 ; i < names.size() ; ++i)
+        size += sizeof(cache_file_name) + padded(names[i].name.size());
+
+    /* unique, several connections of a process may share the path */
+    std::string tmp(path);
+    tmp.append(".XXXXXX");
+    int fd = mkostemp(&tmp[0], O_CLOEXEC);
+    if (fd < 0)
+        return errno;
+    void *map = MAP_FAILED;
+    if (!ftruncate(fd, size))
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        int error = errno;
+        close(fd);
+        unlink(tmp.c_str());
+        return error;
+    }
+
+    /* the file was just truncated, padding is already zeroed */
+    char *p = static_cast<char *>(map);
+    cache_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cache_file_magic, sizeof(header.magic));
+    header.version = NFSC_CACHE_FILE_VERSION;
+    header.fattrSize = sizeof(fattr3);
+    header.fsid = fsid;
+    put_fh(&header.rootLen, header.root, root);
+    header.attrCount = attrs.size();
+    header.dirCount = dirs.size();
+    header.nameCount = names.size();
+    header.savedAt = realtime();
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    for (size_t i = 0 ; i < attrs.size() ; ++i) {
+        cache_file_attr record;
+        memset(&record, 0, sizeof(record));
+        put_fh(&record.fhLen, record.fh, attrs[i].fh);
+        record.timeo = attrs[i].timeo;
+        record.ttl = attrs[i].ttl;
+        record.attrs = attrs[i].attrs;
+        memcpy(p, &record, sizeof(record));
+        p += sizeof(record);
+    }
+    for (size_t i = 0 ; i < dirs.size() ; ++i) {
+        cache_file_dir record;
+        memset(&record, 0, sizeof(record));
+        put_fh(&record.fhLen, record.fh, dirs[i].fh);
+        record.mtime = dirs[i].mtime;
+        record.ctime = dirs[i].ctime;
+        memcpy(p, &record, sizeof(record));
+        p += sizeof(record);
+    }
+    for (size_t i = 0 ; i < names.size() ; ++i) {
+        cache_file_name record;
+        memset(&record, 0, sizeof(record));
+        put_fh(&record.dirLen, record.dir, names[i].dir);
+        put_fh(&record.fhLen, record.fh, names[i].fh);
+        record.negative = names[i].negative;
+        record.nameLen = names[i].name.size();
+        memcpy(p, &record, sizeof(record));
+        p += sizeof(record);
+        memcpy(p, names[i].name.data(), names[i].name.size());
+        p += padded(names[i].name.size());
+    }
+
+    int error = 0;
+    if (msync(map, size, MS_SYNC) || fsync(fd))
+        error = errno;
+    munmap(map, size);
+    close(fd);
+    if (!error && rename(tmp.c_str(), path.c_str()))
+        error = errno;
+    if (error)
+        unlink(tmp.c_str());
+    return error;
+}
+
+// ( callback(err) )
+NAN_METHOD(NFS::Client::SaveCache) {
+    bool typeError = true;
+    if (info.Length() != 1) {
+        Nan::ThrowTypeError("Must be called with 1 parameters");
+        return;
+    }
+    if (!info[0]->IsFunction())
+        Nan::ThrowTypeError("Parameter 1, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    Nan::Callback *callback = new Nan::Callback(info[0].As<v8::Function>());
+    Nan::AsyncQueueWorker(new NFS::SaveCacheWorker(obj, callback));
+}
+
+NFS::SaveCacheWorker::SaveCacheWorker(NFS::Client *client_,
+                                      Nan::Callback *callback)
+    : Nan::AsyncWorker(callback),
+      client(client_),
+      error(0)
+{}
+
+void NFS::SaveCacheWorker::Execute()
+{
+    if (!client->isMounted()) {
+        error = NFSC_NOT_MOUNTED;
+        return;
+    }
+    if (client->getConnection()->getCacheFile().save(client->getConnection()))
+        error = NFSC_ECACHEFILE;
+}
+
+void NFS::SaveCacheWorker::HandleOKCallback()
+{
+    Nan::HandleScope scope;
+    v8::Local<v8::Value> argv[] = {
+        error ? v8::Local<v8::Value>(Nan::New<v8::Integer>(error))
+              : v8::Local<v8::Value>(Nan::Null())
+    };
+    callback->Call(1, argv);
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include "node_nfsc.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_mount3.h"
+
+static void
+close_channel(CLIENT *channel)
+{
+    if (channel->cl_auth)
+        auth_destroy(channel->cl_auth);
+    clnt_destroy(channel);
+}
+
+NFS::ChannelPool::ChannelPool()
+    : lock(),
+      idle(),
+      open(0),
+      limit(NFSC_MAX_CHANNELS)
+{}
+
+NFS::ChannelPool::~ChannelPool()
+{
+    clear();
+}
+
+CLIENT *NFS::ChannelPool::acquire(NFS::Client *client)
+{
+    {
+        std::lock_guard<std::mutex> my(lock);
+        if (!idle.empty()) {
+            CLIENT *channel = idle.back();
+            idle.pop_back();
+            return channel;
+        }
+        if (open >= limit)
+            return NULL;
+        ++open;
+    }
+    /* connecting takes a round trip, do not hold the lock meanwhile */
+    int error = 0;
+    CLIENT *channel = Mount3Worker::createNfsClient(client, &error);
+    if (!channel) {
+        std::lock_guard<std::mutex> my(lock);
+        --open;
+        limit = open;
+    }
+    return channel;
+}
+
+void NFS::ChannelPool::release(CLIENT *channel, bool reusable)
+{
+    {
+        std::lock_guard<std::mutex> my(lock);
+        if (reusable) {
+            idle.push_back(channel);
+            return;
+        }
+        --open;
+    }
+    close_channel(channel);
+}
+
+void NFS::ChannelPool::clear()
+{
+    std::vector<CLIENT *> closing;
+    {
+        std::lock_guard<std::mutex> my(lock);
+        closing.swap(idle);
+        open -= closing.size();
+        limit = NFSC_MAX_CHANNELS;
+    }
+    for (size_t i = 0 ; i < closing.size() ; ++i)
+        close_channel(closing[i]);
+}
+
+size_t NFS::ChannelPool::getOpen()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return open;
+}
+
+NFS::Channel::Channel(NFS::Client *client_)
+    : client(client_),
+      channel(client->getConnection()->getChannels().acquire(client)),
+      serialize(NULL),
+      reusable(true)
+{
+    if (!channel)
+        serialize = new Serialize(client);
+}
+
+NFS::Channel::~Channel()
+{
+    if (channel)
+        client->getConnection()->getChannels().release(channel, reusable);
+    delete serialize;
+}
+
+CLIENT *NFS::Channel::get() const
+{
+    return channel ? channel : client->getClient();
+}
+
+clnt_stat NFS::Channel::check(clnt_stat stat)
+{
+    if (stat != RPC_SUCCESS)
+        reusable = false;
+    return stat;
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include "node_nfsc.h"
+#include "node_nfsc_checksum.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_options.h"
+
+// (object, options, callback(err, digests, count) )
+NAN_METHOD(NFS::Client::Checksum) {
+    bool typeError = true;
+    if (info.Length() != 3) {
+        Nan::ThrowTypeError("Must be called with 3 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, object must be a Buffer");
+    else if (!info[1]->IsUndefined() && !info[1]->IsNull() &&
+             !info[1]->IsObject())
+        Nan::ThrowTypeError("Parameter 2, options must be an object");
+    else if (!info[2]->IsFunction())
+        Nan::ThrowTypeError("Parameter 3, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    uint64_t offset = CheckUDouble(option_number(info[1], "offset", 0));
+    double length_ = option_number(info[1], "length", -1);
+    uint64_t length = length_ < 0 ? NFSC_PIPELINE_TO_EOF
+                                  : CheckUDouble(length_);
+    if (offset == (uint64_t)-1 || (length_ >= 0 && length == (uint64_t)-1)) {
+        Nan::ThrowRangeError("Invalid offset or length");
+        return;
+    }
+    unsigned algorithms = NFSC_HASH_SHA256;
+    if (info[1]->IsObject()) {
+        v8::Local<v8::Value> names = info[1].As<v8::Object>()
+                ->Get(Nan::New("algorithms").ToLocalChecked());
+        if (!names->IsUndefined())
+            algorithms = checksum_algorithms(names);
+    }
+    if (!algorithms) {
+        Nan::ThrowRangeError("Unknown checksum algorithm");
+        return;
+    }
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    uint32_t chunkSize = option_uint(info[1], "chunkSize",
+                                     obj->getConnection()->getRtmax());
+    unsigned depth = option_uint(info[1], "depth", NFSC_PIPELINE_DEPTH);
+    NFS::ChecksumJob *job = new NFS::ChecksumJob(obj, info[0], offset,
+                                                 length, chunkSize, depth,
+                                                 algorithms, info[2]);
+    job->start();
+}
+
+NFS::ChecksumJob::ChecksumJob(NFS::Client *client_,
+                              const v8::Local<v8::Value> &obj_fh_,
+                              uint64_t offset, uint64_t length,
+                              uint32_t chunkSize_, unsigned depth_,
+                              unsigned algorithms,
+                              const v8::Local<v8::Value> &callback_)
+    : Pipeline(client_, offset, length, chunkSize_, depth_, callback_),
+      fh(node::Buffer::Data(obj_fh_), node::Buffer::Length(obj_fh_)),
+      digest(algorithms, offset)
+{}
+
+void NFS::ChecksumJob::execute(NFS::PipelineChunk *chunk)
+{
+    Channel channel(client);
+    pipeline_read(client, channel, fh, chunk);
+    checksum_add(&digest, chunk);
+}
+
+void NFS::ChecksumJob::done(int error_)
+{
+    if (error_) {
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::Integer>(error_)
+        };
+        callback.Call(1, argv);
+        return;
+    }
+    v8::Local<v8::Value> argv[] = {
+        Nan::Null(),
+        checksum_result(&digest),
+        Nan::New<v8::Number>(double(getDelivered() - getStart()))
+    };
+    callback.Call(sizeof(argv)/sizeof(*argv), argv);
+}
+
+unsigned NFS::checksum_algorithms(const v8::Local<v8::Value> &names)
+{
+    if (names->IsString())
+        return Digest::parse(*Nan::Utf8String(names));
+    if (!names->IsArray())
+        return 0;
+    v8::Local<v8::Array> array = names.As<v8::Array>();
+    unsigned algorithms = 0;
+    for (uint32_t i = 0 ; i < array->Length() ; ++i) {
+        v8::Local<v8::Value> name = array->Get(i);
+        unsigned algorithm = name->IsString()
+                ? Digest::parse(*Nan::Utf8String(name)) : 0;
+        if (!algorithm)
+            return 0;
+        algorithms |= algorithm;
+    }
+    return algorithms;
+}
+
+void NFS::checksum_add(NFS::Digest *digest, const NFS::PipelineChunk *chunk)
+{
+    /* a chunk that failed ends nothing, the pipeline fails with it */
+    if (chunk->error)
+        return;
+    /* the same end of the range as Pipeline::complete() sees */
+    digest->add(chunk->offset, chunk->data, chunk->len,
+                chunk->eof || chunk->len < chunk->count);
+}
+
+v8::Local<v8::Object> NFS::checksum_result(NFS::Digest *digest)
+{
+    static const char hex[] = "0123456789abcdef";
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    for (unsigned algorithm = NFSC_HASH_CRC32C ;
+         algorithm <= NFSC_HASH_XXHASH64 ;
+         algorithm <<= 1) {
+        if (!(digest->getAlgorithms() & algorithm))
+            continue;
+        unsigned char raw[NFSC_HASH_MAX_SIZE];
+        char str[2 * NFSC_HASH_MAX_SIZE];
+        size_t len = digest->final(algorithm, raw);
+        for (size_t i = 0 ; i < len ; ++i) {
+            str[2 * i] = hex[raw[i] >> 4];
+            str[2 * i + 1] = hex[raw[i] & 0xf];
+        }
+        result->Set(Nan::New(Digest::name(algorithm)).ToLocalChecked(),
+                    Nan::New(str, 2 * len).ToLocalChecked());
+    }
+    return result;
+}
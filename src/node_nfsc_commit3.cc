@@ -42,26 +42,44 @@ NAN_METHOD(NFS::Client::Commit3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[3].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::Commit3Worker(obj, info[0], info[1], info[2],
-                                               callback));
+    NFS::Commit3Worker *worker =
+            NFS::WorkerPool<NFS::Commit3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::Commit3Worker::Commit3Worker(NFS::Client *client_,
-                                  const v8::Local<v8::Value> &obj_fh_,
-                                  const v8::Local<v8::Value> &count_,
-                                  const v8::Local<v8::Value> &offset_,
-                                  Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_COMMIT3res, callback)
+NFS::Commit3Worker::Commit3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_COMMIT3res)
+{}
+
+bool NFS::Commit3Worker::setup(NFS::Client *client_,
+                               const v8::Local<v8::Value> &obj_fh_,
+                               const v8::Local<v8::Value> &count_,
+                               const v8::Local<v8::Value> &offset_,
+                               const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
     args.file.data.data_val = node::Buffer::Data(obj_fh_);
     args.file.data.data_len = node::Buffer::Length(obj_fh_);
     args.count = count_->NumberValue();
     args.offset = CheckUDouble(offset_->NumberValue());
     if (args.offset == (uint64_t)-1) {
         Nan::ThrowRangeError("Invalid offset");
-        return;
+        return false;
     }
+    return true;
+}
+
+void NFS::Commit3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    if (res.status == NFS3_OK)
+        cache.put(args.file, res.COMMIT3res_u.resok.file_wcc);
+    else
+        cache.put(args.file, res.COMMIT3res_u.resfail.file_wcc);
 }
 
 void NFS::Commit3Worker::procSuccess()
@@ -112,7 +130,7 @@ void NFS::Commit3Worker::procFailure()
     obj_attrs->Set(Nan::New("after").ToLocalChecked(),
                    before);
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         obj_attrs
     };
     callback->Call(2, argv);
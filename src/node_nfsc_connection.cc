@@ -0,0 +1,222 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string.h>
+#include <gssrpc/rpc.h>
+#include "node_nfsc_connection.h"
+
+typedef std::map<std::string, NFS::Connection *> Registry;
+
+static std::mutex registry_lock;
+static Registry registry;
+
+NFS::Connection *NFS::Connection::acquire(const std::string &key,
+                                          bool shared)
+{
+    if (!shared)
+        return new Connection(key, false);
+
+    std::lock_guard<std::mutex> my(registry_lock);
+    Registry::iterator it = registry.find(key);
+    if (it != registry.end()) {
+        ++it->second->refs;
+        return it->second;
+    }
+    Connection *connection = new Connection(key, true);
+    registry[key] = connection;
+    return connection;
+}
+
+void NFS::Connection::release(NFS::Connection *connection)
+{
+    if (connection->shared) {
+        std::lock_guard<std::mutex> my(registry_lock);
+        if (--connection->refs > 0)
+            return;
+        registry.erase(connection->key);
+    }
+    delete connection;
+}
+
+NFS::Connection::Connection(const std::string &key_, bool shared_)
+    : sem(),
+      client(NULL),
+      mntClient(NULL),
+      rootFh(NULL),
+      mounts(0),
+      attrCache(),
+      accessCache(),
+      nameCache(),
+      pageCache(),
+      readahead(),
+      writeBehind(),
+      cacheFile(),
+      channels(),
+      rtmax(NFSC_TRANSFER_SIZE),
+      wtmax(NFSC_TRANSFER_SIZE),
+      refs(1),
+      shared(shared_),
+      key(key_),
+      configured()
+{
+    sem_init(&sem, 0, 1);
+}
+
+NFS::Connection::~Connection()
+{
+    channels.clear();
+    setClient(NULL);
+    setMountClient(NULL);
+    freeRootFh();
+    sem_destroy(&sem);
+}
+
+CLIENT *NFS::Connection::getClient()
+{
+    return client;
+}
+
+void NFS::Connection::setClient(CLIENT *client_)
+{
+    if (client) {
+        if (client->cl_auth)
+            auth_destroy(client->cl_auth);
+        clnt_destroy(client);
+    }
+    client = client_;
+}
+
+CLIENT *NFS::Connection::getMountClient()
+{
+    return mntClient;
+}
+
+void NFS::Connection::setMountClient(CLIENT *client_)
+{
+    if (mntClient) {
+        if (mntClient->cl_auth)
+            auth_destroy(mntClient->cl_auth);
+        clnt_destroy(mntClient);
+    }
+    mntClient = client_;
+}
+
+nfs_fh3 &NFS::Connection::getRootFh()
+{
+    return *rootFh;
+}
+
+void NFS::Connection::freeRootFh()
+{
+    if (rootFh) {
+        delete[] rootFh->data.data_val;
+        delete rootFh;
+        rootFh = NULL;
+    }
+}
+
+void NFS::Connection::setRootFh(char *data, size_t len)
+{
+    freeRootFh();
+    rootFh = new nfs_fh3;
+    rootFh->data.data_val = new char[len];
+    rootFh->data.data_len = len;
+    memcpy(rootFh->data.data_val, data, len);
+}
+
+NFS::AttrCache &NFS::Connection::getAttrCache()
+{
+    return attrCache;
+}
+
+NFS::AccessCache &NFS::Connection::getAccessCache()
+{
+    return accessCache;
+}
+
+NFS::NameCache &NFS::Connection::getNameCache()
+{
+    return nameCache;
+}
+
+NFS::PageCache &NFS::Connection::getPageCache()
+{
+    return pageCache;
+}
+
+NFS::Readahead &NFS::Connection::getReadahead()
+{
+    return readahead;
+}
+
+NFS::WriteBehind &NFS::Connection::getWriteBehind()
+{
+    return writeBehind;
+}
+
+NFS::CacheFile &NFS::Connection::getCacheFile()
+{
+    return cacheFile;
+}
+
+NFS::ChannelPool &NFS::Connection::getChannels()
+{
+    return channels;
+}
+
+uint32_t NFS::Connection::getRtmax() const
+{
+    return rtmax;
+}
+
+uint32_t NFS::Connection::getWtmax() const
+{
+    return wtmax;
+}
+
+void NFS::Connection::setTransferSizes(uint32_t rtmax_, uint32_t wtmax_,
+                                       bool udp)
+{
+    if (udp) {
+        rtmax_ = std::min<uint32_t>(rtmax_, NFSC_UDP_TRANSFER_SIZE);
+        wtmax_ = std::min<uint32_t>(wtmax_, NFSC_UDP_TRANSFER_SIZE);
+    }
+    /* a server announcing no limit keeps the default */
+    if (rtmax_)
+        rtmax = rtmax_;
+    if (wtmax_)
+        wtmax = wtmax_;
+}
+
+int NFS::Connection::getMounts() const
+{
+    return mounts;
+}
+
+void NFS::Connection::addMount()
+{
+    ++mounts;
+}
+
+int NFS::Connection::removeMount()
+{
+    return --mounts;
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "node_nfsc.h"
+#include "node_nfsc_copy.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_errors3.h"
+#include "node_nfsc_options.h"
+#include "node_nfsc_resolve.h"
+
+// (object, destination, dst_object, options, callback(err, count, skipped) )
+NAN_METHOD(NFS::Client::Copy) {
+    bool typeError = true;
+    if (info.Length() != 5) {
+        Nan::ThrowTypeError("Must be called with 5 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, object must be a Buffer");
+    else if (!NFS::Client::isInstance(info[1]))
+        Nan::ThrowTypeError("Parameter 2, destination must be a Client");
+    else if (!info[2]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 3, dst_object must be a Buffer");
+    else if (!info[3]->IsUndefined() && !info[3]->IsNull() &&
+             !info[3]->IsObject())
+        Nan::ThrowTypeError("Parameter 4, options must be an object");
+    else if (!info[4]->IsFunction())
+        Nan::ThrowTypeError("Parameter 5, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    uint64_t offset = CheckUDouble(option_number(info[3], "offset", 0));
+    uint64_t dstOffset = CheckUDouble(option_number(info[3], "dstOffset",
+                                                    double(offset)));
+    double length_ = option_number(info[3], "length", -1);
+    uint64_t length = length_ < 0 ? NFSC_PIPELINE_TO_EOF
+                                  : CheckUDouble(length_);
+    if (offset == (uint64_t)-1 || dstOffset == (uint64_t)-1 ||
+        (length_ >= 0 && length == (uint64_t)-1)) {
+        Nan::ThrowRangeError("Invalid offset, dstOffset or length");
+        return;
+    }
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    NFS::Client* destination =
+            ObjectWrap::Unwrap<NFS::Client>(info[1].As<v8::Object>());
+    uint32_t chunkSize = option_uint(
+            info[3], "chunkSize",
+            std::min(obj->getConnection()->getRtmax(),
+                     destination->getConnection()->getWtmax()));
+    unsigned depth = option_uint(info[3], "depth", NFSC_PIPELINE_DEPTH);
+    bool copyAttrs = option_bool(info[3], "attributes", false);
+    bool sparse = option_bool(info[3], "sparse", false);
+    NFS::CopyJob *job = new NFS::CopyJob(obj, info[0], info[1], info[2],
+                                         offset, length, dstOffset,
+                                         chunkSize, depth, copyAttrs,
+                                         sparse, info[4]);
+    job->start();
+}
+
+NFS::CopyJob::CopyJob(NFS::Client *client_,
+                      const v8::Local<v8::Value> &src_fh_,
+                      const v8::Local<v8::Value> &destination_,
+                      const v8::Local<v8::Value> &dst_fh_, uint64_t offset,
+                      uint64_t length, uint64_t dstOffset,
+                      uint32_t chunkSize_, unsigned depth_, bool copyAttrs_,
+                      bool sparse_, const v8::Local<v8::Value> &callback_)
+    : Pipeline(client_, offset, length, chunkSize_, depth_, callback_),
+      src(node::Buffer::Data(src_fh_), node::Buffer::Length(src_fh_)),
+      destination(Nan::ObjectWrap::Unwrap<Client>(
+                          destination_.As<v8::Object>())),
+      dst(node::Buffer::Data(dst_fh_), node::Buffer::Length(dst_fh_)),
+      dstStart(dstOffset),
+      copyAttrs(copyAttrs_),
+      sparse(sparse_),
+      skipped(0),
+      hasAttrs(false),
+      attrs(),
+      uncommitted()
+{
+    keep("destination", destination_);
+}
+
+void NFS::CopyJob::write(NFS::PipelineChunk *chunk, stable_how stable)
+{
+    PipelineChunk out = PipelineChunk();
+    out.offset = dstStart + (chunk->offset - getStart());
+    out.count = chunk->len;
+    out.data = chunk->data;
+    /* one channel at a time, both may be the main CLIENT of one mount */
+    Channel channel(destination);
+    pipeline_write(destination, channel, dst, &out, stable, sparse);
+    chunk->error = out.error;
+    chunk->skipped = out.skipped;
+    chunk->unstable = out.unstable;
+    memcpy(chunk->verf, out.verf, NFS3_WRITEVERFSIZE);
+}
+
+void NFS::CopyJob::execute(NFS::PipelineChunk *chunk)
+{
+    if (!destination->isMounted()) {
+        chunk->error = NFSC_NOT_MOUNTED;
+        return;
+    }
+    {
+        Channel channel(client);
+        pipeline_read(client, channel, src, chunk);
+    }
+    if (!chunk->error && chunk->len)
+        write(chunk, UNSTABLE);
+}
+
+void NFS::CopyJob::deliver(NFS::PipelineChunk *chunk)
+{
+    if (chunk->hasAttrs) {
+        hasAttrs = true;
+        attrs = chunk->attrs;
+    }
+    skipped += chunk->skipped;
+    if (!chunk->unstable)
+        return;
+    Uncommitted range;
+    range.offset = chunk->offset;
+    range.len = chunk->len;
+    memcpy(range.verf, chunk->verf, NFS3_WRITEVERFSIZE);
+    uncommitted.push_back(range);
+}
+
+bool NFS::CopyJob::hasFinish() const
+{
+    return copyAttrs || skipped || !uncommitted.empty();
+}
+
+int NFS::CopyJob::finish()
+{
+    if (!destination->isMounted())
+        return NFSC_NOT_MOUNTED;
+    if (!uncommitted.empty()) {
+        char verf[NFS3_WRITEVERFSIZE];
+        uint64_t first = uncommitted.front().offset;
+        uint64_t last = uncommitted.back().offset + uncommitted.back().len;
+        int error_;
+        {
+            Channel channel(destination);
+            error_ = pipeline_commit(destination, channel, dst,
+                                     dstStart + (first - getStart()),
+                                     last - first, verf);
+        }
+        if (error_)
+            return error_;
+        /* the destination restarted, what it lost is read again */
+        for (size_t i = 0 ; i < uncommitted.size() ; ++i) {
+            const Uncommitted &range = uncommitted[i];
+            if (!memcmp(range.verf, verf, NFS3_WRITEVERFSIZE))
+                continue;
+            PipelineChunk chunk = PipelineChunk();
+            chunk.offset = range.offset;
+            chunk.count = range.len;
+            /* not from the slab, which is given back on the main thread */
+            chunk.data = static_cast<char *>(malloc(range.len));
+            if (!chunk.data)
+                return NFSC_UNKNOWN_ERROR;
+            {
+                Channel channel(client);
+                pipeline_read(client, channel, src, &chunk);
+            }
+            if (!chunk.error)
+                write(&chunk, FILE_SYNC);
+            free(chunk.data);
+            if (chunk.error)
+                return chunk.error;
+        }
+    }
+    if (skipped) {
+        Channel channel(destination);
+        int error_ = pipeline_extend(destination, channel, dst,
+                                     dstStart + (getDelivered() - getStart()));
+        if (error_)
+            return error_;
+    }
+    return copyAttrs ? setAttrs() : 0;
+}
+
+int NFS::CopyJob::setAttrs()
+{
+    if (!hasAttrs) {
+        PathWalker walker;
+        walker.reset(client);
+        walker.setFh(src);
+        const fattr3 *attrs_ = walker.getAttrs();
+        if (!attrs_)
+            return walker.getError();
+        attrs = *attrs_;
+    }
+    SETATTR3args args = SETATTR3args();
+    SETATTR3res res = SETATTR3res();
+    dst.toNfs(&args.object);
+    args.new_attributes.mode.set_it = true;
+    args.new_attributes.mode.set_mode3_u.mode = attrs.mode;
+    args.new_attributes.uid.set_it = true;
+    args.new_attributes.uid.set_uid3_u.uid = attrs.uid;
+    args.new_attributes.gid.set_it = true;
+    args.new_attributes.gid.set_gid3_u.gid = attrs.gid;
+    args.new_attributes.atime.set_it = SET_TO_CLIENT_TIME;
+    args.new_attributes.atime.set_atime_u.atime = attrs.atime;
+    args.new_attributes.mtime.set_it = SET_TO_CLIENT_TIME;
+    args.new_attributes.mtime.set_mtime_u.mtime = attrs.mtime;
+    args.guard.check = 0;
+    Channel channel(destination);
+    clnt_stat stat = channel.check(
+            nfsproc3_setattr_3(&args, &res, channel.get()));
+    if (stat != RPC_SUCCESS)
+        return rpc_error_code(stat);
+    AttrCache &cache = destination->getConnection()->getAttrCache();
+    int error_ = 0;
+    if (res.status == NFS3_OK) {
+        cache.put(args.object, res.SETATTR3res_u.resok.obj_wcc);
+    } else {
+        cache.put(args.object, res.SETATTR3res_u.resfail.obj_wcc);
+        error_ = nfs3_error_code(res.status);
+    }
+    xdr_free((xdrproc_t) xdr_SETATTR3res, (char *)&res);
+    return error_;
+}
+
+void NFS::CopyJob::done(int error_)
+{
+    if (error_) {
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::Integer>(error_)
+        };
+        callback.Call(1, argv);
+        return;
+    }
+    v8::Local<v8::Value> argv[] = {
+        Nan::Null(),
+        Nan::New<v8::Number>(double(getDelivered() - getStart())),
+        Nan::New<v8::Number>(skipped)
+    };
+    callback.Call(sizeof(argv)/sizeof(*argv), argv);
+}
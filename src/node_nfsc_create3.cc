@@ -43,20 +43,31 @@ NAN_METHOD(NFS::Client::Create3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[4].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::Create3Worker(obj, info[0], info[1],
-                                                 info[2], info[3], callback));
+    NFS::Create3Worker *worker =
+            NFS::WorkerPool<NFS::Create3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3], info[4])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::Create3Worker::Create3Worker(NFS::Client *client_,
-                                  const v8::Local<v8::Value> &parent_fh_,
-                                  const v8::Local<v8::Value> &name_,
-                                  const v8::Local<v8::Value> &mode_,
-                                  const v8::Local<v8::Value> &attrs_,
-                                  Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_CREATE3res, callback),
-      name(name_)
+NFS::Create3Worker::Create3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_CREATE3res)
+{}
+
+bool NFS::Create3Worker::setup(NFS::Client *client_,
+                               const v8::Local<v8::Value> &parent_fh_,
+                               const v8::Local<v8::Value> &name_,
+                               const v8::Local<v8::Value> &mode_,
+                               const v8::Local<v8::Value> &attrs_,
+                               const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
+    if (!name.assign(name_)) {
+        Nan::ThrowError("Out of memory");
+        return false;
+    }
     args.where.dir.data.data_val = node::Buffer::Data(parent_fh_);
     args.where.dir.data.data_len = node::Buffer::Length(parent_fh_);
     args.where.name = *name;
@@ -67,7 +78,7 @@ NFS::Create3Worker::Create3Worker(NFS::Client *client_,
         if (!attrs_->IsObject()) {
             Nan::ThrowTypeError("Invalid argument for this creation mode,"
                                 " must be an Object when UNCHECKED/GUARDED");
-            return;
+            return false;
         }
         args.how.createhow3_u.obj_attributes =
                 node_nfsc_sattr3(v8::Local<v8::Object>::Cast(attrs_));
@@ -76,11 +87,11 @@ NFS::Create3Worker::Create3Worker(NFS::Client *client_,
         if (!attrs_->IsUint8Array()) {
             Nan::ThrowTypeError("Invalid argument for this creation mode,"
                                 " must be a Buffer when EXCLUSIVE");
-            return;
+            return false;
         }
         if (node::Buffer::Length(attrs_) != NFS3_CREATEVERFSIZE) {
             Nan::ThrowTypeError("Invalid verifier size, must be 8 bytes long");
-            return;
+            return false;
         }
         memcpy(&args.how.createhow3_u.verf[0],
                node::Buffer::Data(attrs_),
@@ -88,6 +99,24 @@ NFS::Create3Worker::Create3Worker(NFS::Client *client_,
         break;
     default:
         Nan::ThrowTypeError("Invalid creation mode");
+        return false;
+    }
+    return true;
+}
+
+void NFS::Create3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    NameCache &names = client->getConnection()->getNameCache();
+    if (res.status == NFS3_OK) {
+        cache.put(res.CREATE3res_u.resok.obj,
+                  res.CREATE3res_u.resok.obj_attributes);
+        cache.put(args.where.dir, res.CREATE3res_u.resok.dir_wcc);
+        names.added(args.where.dir, res.CREATE3res_u.resok.dir_wcc,
+                    args.where.name, res.CREATE3res_u.resok.obj);
+    } else {
+        cache.put(args.where.dir, res.CREATE3res_u.resfail.dir_wcc);
+        names.modified(args.where.dir, res.CREATE3res_u.resfail.dir_wcc);
     }
 }
 
@@ -153,7 +182,7 @@ void NFS::Create3Worker::procFailure()
     wcc->Set(Nan::New("before").ToLocalChecked(), before);
     wcc->Set(Nan::New("after").ToLocalChecked(), after);
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         wcc
     };
     callback->Call(2, argv);
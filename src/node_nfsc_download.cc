@@ -0,0 +1,145 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <errno.h>
+#include <unistd.h>
+#include "node_nfsc.h"
+#include "node_nfsc_download.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_options.h"
+
+// (object, fd, options, callback(err, count) ), count is the errno of a
+// local write on NFSC_ELOCALWRITE
+NAN_METHOD(NFS::Client::DownloadToFd) {
+    bool typeError = true;
+    if (info.Length() != 4) {
+        Nan::ThrowTypeError("Must be called with 4 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, object must be a Buffer");
+    else if (!info[1]->IsInt32() || info[1]->Int32Value() < 0)
+        Nan::ThrowTypeError("Parameter 2, fd must be a file descriptor");
+    else if (!info[2]->IsUndefined() && !info[2]->IsNull() &&
+             !info[2]->IsObject())
+        Nan::ThrowTypeError("Parameter 3, options must be an object");
+    else if (!info[3]->IsFunction())
+        Nan::ThrowTypeError("Parameter 4, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    uint64_t offset = CheckUDouble(option_number(info[2], "offset", 0));
+    uint64_t fdOffset = CheckUDouble(option_number(info[2], "fdOffset",
+                                                   double(offset)));
+    double length_ = option_number(info[2], "length", -1);
+    uint64_t length = length_ < 0 ? NFSC_PIPELINE_TO_EOF
+                                  : CheckUDouble(length_);
+    if (offset == (uint64_t)-1 || fdOffset == (uint64_t)-1 ||
+        (length_ >= 0 && length == (uint64_t)-1)) {
+        Nan::ThrowRangeError("Invalid offset, fdOffset or length");
+        return;
+    }
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    uint32_t chunkSize = option_uint(info[2], "chunkSize",
+                                     obj->getConnection()->getRtmax());
+    unsigned depth = option_uint(info[2], "depth", NFSC_PIPELINE_DEPTH);
+    bool sync = option_bool(info[2], "sync", false);
+    NFS::DownloadJob *job = new NFS::DownloadJob(obj, info[0],
+                                                 info[1]->Int32Value(),
+                                                 offset, length, fdOffset,
+                                                 chunkSize, depth, sync,
+                                                 info[3]);
+    job->start();
+}
+
+NFS::DownloadJob::DownloadJob(NFS::Client *client_,
+                              const v8::Local<v8::Value> &obj_fh_, int fd_,
+                              uint64_t offset, uint64_t length,
+                              uint64_t fdOffset, uint32_t chunkSize_,
+                              unsigned depth_, bool sync_,
+                              const v8::Local<v8::Value> &callback_)
+    : Pipeline(client_, offset, length, chunkSize_, depth_, callback_),
+      fh(node::Buffer::Data(obj_fh_), node::Buffer::Length(obj_fh_)),
+      fd(fd_),
+      fdStart(fdOffset),
+      sync(sync_),
+      localErrno(0)
+{}
+
+/* chunks fail concurrently, the first errno is kept */
+int NFS::DownloadJob::failLocal(int errno_)
+{
+    int none = 0;
+    localErrno.compare_exchange_strong(none, errno_);
+    return NFSC_ELOCALWRITE;
+}
+
+void NFS::DownloadJob::execute(NFS::PipelineChunk *chunk)
+{
+    {
+        Channel channel(client);
+        pipeline_read(client, channel, fh, chunk);
+    }
+    if (chunk->error)
+        return;
+    const char *data = chunk->data;
+    size_t left = chunk->len;
+    off_t position = fdStart + (chunk->offset - getStart());
+    while (left) {
+        ssize_t written = pwrite(fd, data, left, position);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0) {
+            chunk->error = failLocal(written < 0 ? errno : EIO);
+            return;
+        }
+        data += written;
+        left -= written;
+        position += written;
+    }
+}
+
+bool NFS::DownloadJob::hasFinish() const
+{
+    return sync;
+}
+
+int NFS::DownloadJob::finish()
+{
+    return fdatasync(fd) ? failLocal(errno) : 0;
+}
+
+void NFS::DownloadJob::done(int error_)
+{
+    if (error_) {
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::Integer>(error_),
+            error_ == NFSC_ELOCALWRITE
+                ? v8::Local<v8::Value>(Nan::New<v8::Integer>(localErrno.load()))
+                : v8::Local<v8::Value>(Nan::Undefined())
+        };
+        callback.Call(sizeof(argv)/sizeof(*argv), argv);
+        return;
+    }
+    v8::Local<v8::Value> argv[] = {
+        Nan::Null(),
+        Nan::New<v8::Number>(double(getDelivered() - getStart()))
+    };
+    callback.Call(sizeof(argv)/sizeof(*argv), argv);
+}
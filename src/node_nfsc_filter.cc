@@ -0,0 +1,187 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <fnmatch.h>
+#include <stdint.h>
+#include <cmath>
+#include "node_nfsc_filter.h"
+#include "node_nfsc_fattr3.h"
+
+static bool
+filter_strings(const v8::Local<v8::Object> &spec, const char *name,
+               std::vector<std::string> *strings, std::string *error)
+{
+    v8::Local<v8::Value> value = spec->Get(Nan::New(name).ToLocalChecked());
+    if (value->IsUndefined())
+        return true;
+    if (!value->IsArray()) {
+        *error = std::string("filter.") + name + " must be an array";
+        return false;
+    }
+    v8::Local<v8::Array> array = value.As<v8::Array>();
+    for (uint32_t i = 0 ; i < array->Length() ; ++i) {
+        v8::Local<v8::Value> item = array->Get(i);
+        if (!item->IsString()) {
+            *error = std::string("filter.") + name +
+                    " must only hold strings";
+            return false;
+        }
+        strings->push_back(*Nan::Utf8String(item));
+    }
+    return true;
+}
+
+static bool
+filter_number(const v8::Local<v8::Object> &spec, const char *name,
+              double *number, std::string *error)
+{
+    v8::Local<v8::Value> value = spec->Get(Nan::New(name).ToLocalChecked());
+    if (value->IsUndefined())
+        return false;
+    if (!value->IsNumber() || std::isnan(value->NumberValue())) {
+        *error = std::string("filter.") + name + " must be a number";
+        return false;
+    }
+    *number = value->NumberValue();
+    return true;
+}
+
+/* a size beyond the range of uint64_t is undefined when converted */
+static bool
+filter_size(const v8::Local<v8::Object> &spec, const char *name,
+            uint64_t *size, std::string *error)
+{
+    double number;
+    if (!filter_number(spec, name, &number, error))
+        return false;
+    if (!std::isfinite(number)) {
+        *error = std::string("filter.") + name + " must be finite";
+        return false;
+    }
+    if (number < 0)
+        *size = 0;
+    else if (number >= 18446744073709551616.0)
+        *size = UINT64_MAX;
+    else
+        *size = uint64_t(number);
+    return true;
+}
+
+NFS::WalkFilter::WalkFilter()
+    : names(),
+      prune(),
+      hasRegex(false),
+      regex(),
+      types(0),
+      hasAttrPredicate(false),
+      minSize(0),
+      maxSize(UINT64_MAX),
+      minMtime(0),
+      maxMtime(1e300)
+{}
+
+NFS::WalkFilter::~WalkFilter()
+{
+    if (hasRegex)
+        regfree(&regex);
+}
+
+bool NFS::WalkFilter::parse(const v8::Local<v8::Value> &spec_,
+                            std::string *error)
+{
+    if (!spec_->IsObject()) {
+        *error = "filter must be an object";
+        return false;
+    }
+    v8::Local<v8::Object> spec = spec_.As<v8::Object>();
+    if (!filter_strings(spec, "names", &names, error) ||
+        !filter_strings(spec, "prune", &prune, error))
+        return false;
+
+    std::vector<std::string> typeNames;
+    if (!filter_strings(spec, "types", &typeNames, error))
+        return false;
+    for (size_t i = 0 ; i < typeNames.size() ; ++i) {
+        ftype3 type;
+        if (!ftype3_value(typeNames[i].c_str(), &type)) {
+            *error = "filter.types: unknown type " + typeNames[i];
+            return false;
+        }
+        types |= 1u << type;
+    }
+
+    v8::Local<v8::Value> pattern =
+            spec->Get(Nan::New("regex").ToLocalChecked());
+    if (!pattern->IsUndefined()) {
+        if (!pattern->IsString()) {
+            *error = "filter.regex must be a string";
+            return false;
+        }
+        if (regcomp(&regex, *Nan::Utf8String(pattern),
+                    REG_EXTENDED | REG_NOSUB)) {
+            *error = "filter.regex is not a valid extended regex";
+            return false;
+        }
+        hasRegex = true;
+    }
+
+    double number;
+    filter_size(spec, "minSize", &minSize, error);
+    filter_size(spec, "maxSize", &maxSize, error);
+    if (filter_number(spec, "minMtime", &number, error))
+        minMtime = number;
+    if (filter_number(spec, "maxMtime", &number, error))
+        maxMtime = number;
+    if (!error->empty())
+        return false;
+    hasAttrPredicate = types || minSize || maxSize != UINT64_MAX ||
+            minMtime > 0 || maxMtime < 1e300;
+    return true;
+}
+
+bool NFS::WalkFilter::matches(const char *name, const std::string &path,
+                              const fattr3 *attrs) const
+{
+    if (hasAttrPredicate) {
+        if (!attrs)
+            return false;
+        if (types && !(types & (1u << attrs->type)))
+            return false;
+        if (attrs->size < minSize || attrs->size > maxSize)
+            return false;
+        double mtime = attrs->mtime.seconds + attrs->mtime.nseconds / 1e9;
+        if (mtime < minMtime || mtime > maxMtime)
+            return false;
+    }
+    if (!names.empty()) {
+        size_t i = 0;
+        while (i < names.size() && fnmatch(names[i].c_str(), name, 0))
+            ++i;
+        if (i == names.size())
+            return false;
+    }
+    return !hasRegex || !regexec(&regex, path.c_str(), 0, NULL, 0);
+}
+
+bool NFS::WalkFilter::prunes(const char *name) const
+{
+    for (size_t i = 0 ; i < prune.size() ; ++i)
+        if (!fnmatch(prune[i].c_str(), name, 0))
+            return true;
+    return false;
+}
@@ -40,17 +40,36 @@ NAN_METHOD(NFS::Client::FsStat3) {
         return;
 
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::FsStat3Worker(obj, info[0], callback));
+    NFS::FsStat3Worker *worker =
+            NFS::WorkerPool<NFS::FsStat3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::FsStat3Worker::FsStat3Worker(NFS::Client *client_,
-                                const v8::Local<v8::Value> &fsroot_,
-                                Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_FSSTAT3res, callback)
+NFS::FsStat3Worker::FsStat3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_FSSTAT3res)
+{}
+
+bool NFS::FsStat3Worker::setup(NFS::Client *client_,
+                               const v8::Local<v8::Value> &fsroot_,
+                               const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
     args.fsroot.data.data_val = node::Buffer::Data(fsroot_);
     args.fsroot.data.data_len = node::Buffer::Length(fsroot_);
+    return true;
+}
+
+void NFS::FsStat3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    if (res.status == NFS3_OK)
+        cache.put(args.fsroot, res.FSSTAT3res_u.resok.obj_attributes);
+    else
+        cache.put(args.fsroot, res.FSSTAT3res_u.resfail.obj_attributes);
 }
 
 void NFS::FsStat3Worker::procSuccess()
@@ -86,7 +105,7 @@ void NFS::FsStat3Worker::procFailure()
         obj_attrs = Nan::Null();
 
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         obj_attrs
     };
     callback->Call(2, argv);
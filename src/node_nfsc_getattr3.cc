@@ -36,17 +36,57 @@ NAN_METHOD(NFS::Client::GetAttr3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::GetAttr3Worker(obj, info[0], callback));
+    NFS::GetAttr3Worker *worker =
+            NFS::WorkerPool<NFS::GetAttr3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
+}
+
+// (object) -> obj_attr || null
+NAN_METHOD(NFS::Client::CachedGetAttr3) {
+    if ( info.Length() != 1) {
+        Nan::ThrowTypeError("Must be called with 1 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array()) {
+        Nan::ThrowTypeError("Parameter 1, object must be a Buffer");
+        return;
+    }
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    nfs_fh3 fh;
+    fattr3 attrs;
+    fh.data.data_val = node::Buffer::Data(info[0]);
+    fh.data.data_len = node::Buffer::Length(info[0]);
+    if (obj->getConnection()->getAttrCache().get(fh, &attrs))
+        info.GetReturnValue().Set(node_nfsc_fattr3(attrs));
+    else
+        info.GetReturnValue().Set(Nan::Null());
 }
 
-NFS::GetAttr3Worker::GetAttr3Worker(NFS::Client *client_,
+NFS::GetAttr3Worker::GetAttr3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_GETATTR3res)
+{}
+
+bool NFS::GetAttr3Worker::setup(NFS::Client *client_,
                                 const v8::Local<v8::Value> &obj_fh_,
-                                Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_GETATTR3res, callback)
+                                const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
     args.object.data.data_val = node::Buffer::Data(obj_fh_);
     args.object.data.data_len = node::Buffer::Length(obj_fh_);
+    return true;
+}
+
+void NFS::GetAttr3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    if (res.status == NFS3_OK)
+        cache.put(args.object, res.GETATTR3res_u.resok.obj_attributes);
+    else
+        cache.invalidate(args.object);
 }
 
 void NFS::GetAttr3Worker::procSuccess()
@@ -63,7 +103,7 @@ void NFS::GetAttr3Worker::procSuccess()
 void NFS::GetAttr3Worker::procFailure()
 {
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked()
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
     };
     callback->Call(1, argv);
 }
@@ -0,0 +1,520 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <string.h>
+#include <algorithm>
+#include "node_nfsc_hash.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define NFSC_HASH_X86
+#endif
+
+static inline uint32_t load_be32(const unsigned char *p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+            (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+static inline void store_be32(unsigned char *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static inline void store_be64(unsigned char *p, uint64_t v)
+{
+    store_be32(p, v >> 32);
+    store_be32(p + 4, v);
+}
+
+static inline uint64_t load_le64(const unsigned char *p)
+{
+    uint64_t v = 0;
+    for (int i = 7 ; i >= 0 ; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static inline uint32_t load_le32(const unsigned char *p)
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+            (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static inline uint32_t rotr32(uint32_t v, int n)
+{
+    return (v >> n) | (v << (32 - n));
+}
+
+static inline uint64_t rotl64(uint64_t v, int n)
+{
+    return (v << n) | (v >> (64 - n));
+}
+
+/* CRC32C */
+
+typedef uint32_t (*crc32c_update_fn)(uint32_t crc, const unsigned char *data,
+                                     size_t len);
+
+static uint32_t crc32c_table[256];
+
+static uint32_t crc32c_soft(uint32_t crc, const unsigned char *data,
+                            size_t len)
+{
+    while (len--)
+        crc = crc32c_table[(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+#ifdef NFSC_HASH_X86
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char *data,
+                             size_t len)
+{
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    for (; len >= 8 ; len -= 8, data += 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = uint32_t(crc64);
+#endif
+    for (; len >= 4 ; len -= 4, data += 4) {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+    }
+    while (len--)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+#endif
+
+static crc32c_update_fn crc32c_select()
+{
+    for (uint32_t i = 0 ; i < 256 ; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0 ; bit < 8 ; ++bit)
+            crc = (crc >> 1) ^ (0x82f63b78 & -(crc & 1));
+        crc32c_table[i] = crc;
+    }
+#ifdef NFSC_HASH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2"))
+        return crc32c_sse42;
+#endif
+    return crc32c_soft;
+}
+
+/* picked once, when the addon is loaded */
+static const crc32c_update_fn crc32c_update = crc32c_select();
+
+void NFS::Crc32c::update(const char *data, size_t len)
+{
+    crc = crc32c_update(crc, (const unsigned char *)data, len);
+}
+
+void NFS::Crc32c::final(unsigned char *out) const
+{
+    store_be32(out, ~crc);
+}
+
+/* SHA-256 */
+
+typedef void (*sha256_blocks_fn)(uint32_t *state, const unsigned char *data,
+                                 size_t blocks);
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static void sha256_blocks_soft(uint32_t *state, const unsigned char *data,
+                               size_t blocks)
+{
+    for (; blocks ; --blocks, data += 64) {
+        uint32_t w[64];
+        for (int i = 0 ; i < 16 ; ++i)
+            w[i] = load_be32(data + 4 * i);
+        for (int i = 16 ; i < 64 ; ++i) {
+            uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^
+                    (w[i - 15] >> 3);
+            uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^
+                    (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0 ; i < 64 ; ++i) {
+            uint32_t s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + s1 + ch + sha256_k[i] + w[i];
+            uint32_t s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#ifdef NFSC_HASH_X86
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha256_blocks_shani(uint32_t *state, const unsigned char *data,
+                                size_t blocks)
+{
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+                                         0x0405060700010203ULL);
+    /* the rounds instructions work on ABEF and CDGH */
+    __m128i tmp = _mm_shuffle_epi32(
+            _mm_loadu_si128((const __m128i *)state), 0xb1);
+    __m128i state1 = _mm_shuffle_epi32(
+            _mm_loadu_si128((const __m128i *)(state + 4)), 0x1b);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    for (; blocks ; --blocks, data += 64) {
+        __m128i abef = state0;
+        __m128i cdgh = state1;
+        __m128i w[4];
+        for (int i = 0 ; i < 4 ; ++i)
+            w[i] = _mm_shuffle_epi8(
+                    _mm_loadu_si128((const __m128i *)(data + 16 * i)),
+                    bswap);
+        /* four rounds per step, w[i & 3] then becomes words 16 ahead */
+        for (int i = 0 ; i < 16 ; ++i) {
+            __m128i msg = _mm_add_epi32(
+                    w[i & 3],
+                    _mm_loadu_si128((const __m128i *)(sha256_k + 4 * i)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            if (i < 12) {
+                __m128i next = _mm_add_epi32(
+                        _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]),
+                        _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+                w[i & 3] = _mm_sha256msg2_epu32(next, w[(i + 3) & 3]);
+            }
+            state0 = _mm_sha256rnds2_epu32(state0, state1,
+                                           _mm_shuffle_epi32(msg, 0x0e));
+        }
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128((__m128i *)state, state0);
+    _mm_storeu_si128((__m128i *)(state + 4), state1);
+}
+#endif
+
+static sha256_blocks_fn sha256_select()
+{
+#ifdef NFSC_HASH_X86
+    unsigned eax, ebx, ecx, edx;
+    __builtin_cpu_init();
+    /* leaf 7, EBX bit 29: SHA extensions */
+    if (__builtin_cpu_supports("sse4.1") &&
+        __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+        (ebx & (1u << 29)))
+        return sha256_blocks_shani;
+#endif
+    return sha256_blocks_soft;
+}
+
+/* picked once, when the addon is loaded */
+static const sha256_blocks_fn sha256_blocks = sha256_select();
+
+NFS::Sha256::Sha256()
+    : length(0),
+      buffered(0)
+{
+    static const uint32_t init[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(state, init, sizeof(state));
+}
+
+void NFS::Sha256::update(const char *data_, size_t len)
+{
+    const unsigned char *data = (const unsigned char *)data_;
+    length += len;
+    if (buffered) {
+        size_t take = std::min(len, sizeof(block) - buffered);
+        memcpy(block + buffered, data, take);
+        buffered += take;
+        data += take;
+        len -= take;
+        if (buffered < sizeof(block))
+            return;
+        sha256_blocks(state, block, 1);
+        buffered = 0;
+    }
+    sha256_blocks(state, data, len / 64);
+    data += len & ~size_t(63);
+    len &= 63;
+    memcpy(block, data, len);
+    buffered = len;
+}
+
+void NFS::Sha256::final(unsigned char *out)
+{
+    uint64_t bits = length * 8;
+    block[buffered++] = 0x80;
+    if (buffered > 56) {
+        memset(block + buffered, 0, 64 - buffered);
+        sha256_blocks(state, block, 1);
+        buffered = 0;
+    }
+    memset(block + buffered, 0, 56 - buffered);
+    store_be64(block + 56, bits);
+    sha256_blocks(state, block, 1);
+    for (int i = 0 ; i < 8 ; ++i)
+        store_be32(out + 4 * i, state[i]);
+}
+
+/* XXH64 */
+
+static const uint64_t xxh_p1 = 0x9e3779b185ebca87ULL;
+static const uint64_t xxh_p2 = 0xc2b2ae3d27d4eb4fULL;
+static const uint64_t xxh_p3 = 0x165667b19e3779f9ULL;
+static const uint64_t xxh_p4 = 0x85ebca77c2b2ae63ULL;
+static const uint64_t xxh_p5 = 0x27d4eb2f165667c5ULL;
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input)
+{
+    acc += input * xxh_p2;
+    acc = rotl64(acc, 31);
+    return acc * xxh_p1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t value)
+{
+    acc ^= xxh_round(0, value);
+    return acc * xxh_p1 + xxh_p4;
+}
+
+static inline void xxh_stripe(uint64_t *acc, const unsigned char *p)
+{
+    acc[0] = xxh_round(acc[0], load_le64(p));
+    acc[1] = xxh_round(acc[1], load_le64(p + 8));
+    acc[2] = xxh_round(acc[2], load_le64(p + 16));
+    acc[3] = xxh_round(acc[3], load_le64(p + 24));
+}
+
+NFS::XxHash64::XxHash64()
+    : length(0),
+      buffered(0)
+{
+    acc[0] = xxh_p1 + xxh_p2;
+    acc[1] = xxh_p2;
+    acc[2] = 0;
+    acc[3] = -xxh_p1;
+}
+
+void NFS::XxHash64::update(const char *data_, size_t len)
+{
+    const unsigned char *data = (const unsigned char *)data_;
+    length += len;
+    if (buffered) {
+        size_t take = std::min(len, sizeof(block) - buffered);
+        memcpy(block + buffered, data, take);
+        buffered += take;
+        data += take;
+        len -= take;
+        if (buffered < sizeof(block))
+            return;
+        xxh_stripe(acc, block);
+        buffered = 0;
+    }
+    /* four independent lanes, the compiler keeps them in registers */
+    uint64_t lanes[4] = { acc[0], acc[1], acc[2], acc[3] };
+    for (; len >= 32 ; len -= 32, data += 32)
+        xxh_stripe(lanes, data);
+    memcpy(acc, lanes, sizeof(acc));
+    memcpy(block, data, len);
+    buffered = len;
+}
+
+void NFS::XxHash64::final(unsigned char *out) const
+{
+    uint64_t h;
+    if (length >= 32) {
+        h = rotl64(acc[0], 1) + rotl64(acc[1], 7) +
+                rotl64(acc[2], 12) + rotl64(acc[3], 18);
+        for (int i = 0 ; i < 4 ; ++i)
+            h = xxh_merge(h, acc[i]);
+    } else {
+        h = xxh_p5;
+    }
+    h += length;
+    const unsigned char *p = block;
+    size_t len = buffered;
+    for (; len >= 8 ; len -= 8, p += 8) {
+        h ^= xxh_round(0, load_le64(p));
+        h = rotl64(h, 27) * xxh_p1 + xxh_p4;
+    }
+    if (len >= 4) {
+        h ^= uint64_t(load_le32(p)) * xxh_p1;
+        h = rotl64(h, 23) * xxh_p2 + xxh_p3;
+        len -= 4;
+        p += 4;
+    }
+    for (; len ; --len, ++p) {
+        h ^= *p * xxh_p5;
+        h = rotl64(h, 11) * xxh_p1;
+    }
+    h ^= h >> 33;
+    h *= xxh_p2;
+    h ^= h >> 29;
+    h *= xxh_p3;
+    h ^= h >> 32;
+    store_be64(out, h);
+}
+
+/* Digest */
+
+NFS::Digest::Digest(unsigned algorithms_, uint64_t offset)
+    : algorithms(algorithms_),
+      crc32c(),
+      sha256(),
+      xxhash64(),
+      lock(),
+      next(offset),
+      ended(false),
+      parked()
+{}
+
+unsigned NFS::Digest::parse(const char *name)
+{
+    if (!strcmp(name, "crc32c"))
+        return NFSC_HASH_CRC32C;
+    if (!strcmp(name, "sha256"))
+        return NFSC_HASH_SHA256;
+    if (!strcmp(name, "xxhash64"))
+        return NFSC_HASH_XXHASH64;
+    return 0;
+}
+
+const char *NFS::Digest::name(unsigned algorithm)
+{
+    switch (algorithm) {
+    case NFSC_HASH_CRC32C:
+        return "crc32c";
+    case NFSC_HASH_SHA256:
+        return "sha256";
+    case NFSC_HASH_XXHASH64:
+        return "xxhash64";
+    }
+    return NULL;
+}
+
+unsigned NFS::Digest::getAlgorithms() const
+{
+    return algorithms;
+}
+
+void NFS::Digest::update(const char *data, size_t len)
+{
+    if (algorithms & NFSC_HASH_CRC32C)
+        crc32c.update(data, len);
+    if (algorithms & NFSC_HASH_SHA256)
+        sha256.update(data, len);
+    if (algorithms & NFSC_HASH_XXHASH64)
+        xxhash64.update(data, len);
+}
+
+void NFS::Digest::add(uint64_t offset, const char *data, uint32_t len,
+                      bool last)
+{
+    std::unique_lock<std::mutex> my(lock);
+    for (;;) {
+        if (ended)
+            return;
+        if (offset != next) {
+            Parked chunk = { data, len, last };
+            parked[offset] = chunk;
+            return;
+        }
+        /* only the thread holding the chunk at next gets here */
+        my.unlock();
+        update(data, len);
+        my.lock();
+        next += len;
+        ended = last;
+        std::map<uint64_t, Parked>::iterator it = parked.find(next);
+        if (it == parked.end())
+            return;
+        offset = it->first;
+        data = it->second.data;
+        len = it->second.len;
+        last = it->second.last;
+        parked.erase(it);
+    }
+}
+
+size_t NFS::Digest::final(unsigned algorithm, unsigned char *out)
+{
+    switch (algorithm) {
+    case NFSC_HASH_CRC32C:
+        crc32c.final(out);
+        return 4;
+    case NFSC_HASH_SHA256:
+        sha256.final(out);
+        return 32;
+    case NFSC_HASH_XXHASH64:
+        xxhash64.final(out);
+        return 8;
+    }
+    return 0;
+}
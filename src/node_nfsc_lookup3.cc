@@ -38,20 +38,101 @@ NAN_METHOD(NFS::Client::Lookup3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::Lookup3Worker(obj, info[0], info[1], callback));
+    NFS::Lookup3Worker *worker =
+            NFS::WorkerPool<NFS::Lookup3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::Lookup3Worker::Lookup3Worker(NFS::Client *client_,
-                                const v8::Local<v8::Value> &parent_fh_,
-                                const v8::Local<v8::Value> &name_,
-                                Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_LOOKUP3res, callback),
-      name(name_)
+NFS::Lookup3Worker::Lookup3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_LOOKUP3res)
+{}
+
+bool NFS::Lookup3Worker::setup(NFS::Client *client_,
+                               const v8::Local<v8::Value> &parent_fh_,
+                               const v8::Local<v8::Value> &name_,
+                               const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
+    if (!name.assign(name_)) {
+        Nan::ThrowError("Out of memory");
+        return false;
+    }
     args.what.dir.data.data_val = node::Buffer::Data(parent_fh_);
     args.what.dir.data.data_len = node::Buffer::Length(parent_fh_);
     args.what.name = *name;
+    return true;
+}
+
+void NFS::lookup3_update_caches(NFS::Connection *connection,
+                                const LOOKUP3args &args,
+                                const LOOKUP3res &res)
+{
+    AttrCache &cache = connection->getAttrCache();
+    NameCache &names = connection->getNameCache();
+    if (res.status == NFS3_OK) {
+        cache.put(res.LOOKUP3res_u.resok.object,
+                  res.LOOKUP3res_u.resok.obj_attributes);
+        cache.put(args.what.dir, res.LOOKUP3res_u.resok.dir_attributes);
+        names.found(args.what.dir, res.LOOKUP3res_u.resok.dir_attributes,
+                    args.what.name, res.LOOKUP3res_u.resok.object);
+    } else {
+        cache.put(args.what.dir, res.LOOKUP3res_u.resfail.dir_attributes);
+        if (res.status == NFS3ERR_NOENT)
+            names.notFound(args.what.dir,
+                           res.LOOKUP3res_u.resfail.dir_attributes,
+                           args.what.name);
+    }
+}
+
+bool NFS::lookup3_from_cache(NFS::Connection *connection,
+                             const LOOKUP3args &args,
+                             LOOKUP3res *res)
+{
+    AttrCache &cache = connection->getAttrCache();
+    NameCache &names = connection->getNameCache();
+    LOOKUP3resok &resok = res->LOOKUP3res_u.resok;
+    fattr3 dir_attrs;
+    FileHandle fh;
+
+    if (!cache.get(args.what.dir, &dir_attrs))
+        return false;
+    switch (names.lookup(args.what.dir, dir_attrs, args.what.name, &fh)) {
+    case NameCache::FOUND:
+        resok.object.data.data_val = (char *)malloc(fh.size());
+        if (!resok.object.data.data_val)
+            return false;
+        memcpy(resok.object.data.data_val, fh.getData(), fh.size());
+        resok.object.data.data_len = fh.size();
+        resok.obj_attributes.attributes_follow =
+                cache.get(resok.object,
+                          &resok.obj_attributes.post_op_attr_u.attributes);
+        resok.dir_attributes.attributes_follow = TRUE;
+        resok.dir_attributes.post_op_attr_u.attributes = dir_attrs;
+        res->status = NFS3_OK;
+        return true;
+    case NameCache::NOT_FOUND:
+        res->LOOKUP3res_u.resfail.dir_attributes.attributes_follow = TRUE;
+        res->LOOKUP3res_u.resfail.dir_attributes.post_op_attr_u.attributes =
+                dir_attrs;
+        res->status = NFS3ERR_NOENT;
+        return true;
+    default:
+        return false;
+    }
+}
+
+void NFS::Lookup3Worker::updateCaches()
+{
+    lookup3_update_caches(client->getConnection(), args, res);
+}
+
+bool NFS::Lookup3Worker::fromCache()
+{
+    return lookup3_from_cache(client->getConnection(), args, &res);
 }
 
 void NFS::Lookup3Worker::procSuccess()
@@ -83,7 +164,7 @@ void NFS::Lookup3Worker::procSuccess()
 void NFS::Lookup3Worker::procFailure()
 {
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked()
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
     };
     callback->Call(1, argv);
 }
@@ -42,23 +42,51 @@ NAN_METHOD(NFS::Client::MkDir3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[3].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::MkDir3Worker(obj, info[0], info[1],
-                                                 info[2], callback));
+    NFS::MkDir3Worker *worker =
+            NFS::WorkerPool<NFS::MkDir3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::MkDir3Worker::MkDir3Worker(NFS::Client *client_,
-                                  const v8::Local<v8::Value> &parent_fh_,
-                                  const v8::Local<v8::Value> &name_,
-                                  const v8::Local<v8::Value> &attrs_,
-                                  Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_MKDIR3res, callback),
-      name(name_)
+NFS::MkDir3Worker::MkDir3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_MKDIR3res)
+{}
+
+bool NFS::MkDir3Worker::setup(NFS::Client *client_,
+                              const v8::Local<v8::Value> &parent_fh_,
+                              const v8::Local<v8::Value> &name_,
+                              const v8::Local<v8::Value> &attrs_,
+                              const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
+    if (!name.assign(name_)) {
+        Nan::ThrowError("Out of memory");
+        return false;
+    }
     args.where.dir.data.data_val = node::Buffer::Data(parent_fh_);
     args.where.dir.data.data_len = node::Buffer::Length(parent_fh_);
     args.where.name = *name;
     args.attributes = node_nfsc_sattr3(v8::Local<v8::Object>::Cast(attrs_));
+    return true;
+}
+
+void NFS::MkDir3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    NameCache &names = client->getConnection()->getNameCache();
+    if (res.status == NFS3_OK) {
+        cache.put(res.MKDIR3res_u.resok.obj,
+                  res.MKDIR3res_u.resok.obj_attributes);
+        cache.put(args.where.dir, res.MKDIR3res_u.resok.dir_wcc);
+        names.added(args.where.dir, res.MKDIR3res_u.resok.dir_wcc,
+                    args.where.name, res.MKDIR3res_u.resok.obj);
+    } else {
+        cache.put(args.where.dir, res.MKDIR3res_u.resfail.dir_wcc);
+        names.modified(args.where.dir, res.MKDIR3res_u.resfail.dir_wcc);
+    }
 }
 
 void NFS::MkDir3Worker::procSuccess()
@@ -123,7 +151,7 @@ void NFS::MkDir3Worker::procFailure()
     wcc->Set(Nan::New("before").ToLocalChecked(), before);
     wcc->Set(Nan::New("after").ToLocalChecked(), after);
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         wcc
     };
     callback->Call(2, argv);
@@ -44,21 +44,32 @@ NAN_METHOD(NFS::Client::MkNod3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[4].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::MkNod3Worker(obj, info[0], info[1],
-                                                info[2], info[3], callback));
+    NFS::MkNod3Worker *worker =
+            NFS::WorkerPool<NFS::MkNod3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3], info[4])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::MkNod3Worker::MkNod3Worker(NFS::Client *client_,
-                                const v8::Local<v8::Value> &parent_fh_,
-                                const v8::Local<v8::Value> &name_,
-                                const v8::Local<v8::Value> &type_,
-                                const v8::Local<v8::Value> &mknodData_,
-                                Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_MKNOD3res, callback),
-      name(name_),
-      type(type_)
+NFS::MkNod3Worker::MkNod3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_MKNOD3res)
+{}
+
+bool NFS::MkNod3Worker::setup(NFS::Client *client_,
+                              const v8::Local<v8::Value> &parent_fh_,
+                              const v8::Local<v8::Value> &name_,
+                              const v8::Local<v8::Value> &type_,
+                              const v8::Local<v8::Value> &mknodData_,
+                              const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
+    if (!name.assign(name_)) {
+        Nan::ThrowError("Out of memory");
+        return false;
+    }
+    Nan::Utf8String type(type_);
     v8::Local<v8::Value> rdev;
     v8::Local<v8::Value> attrs;
     bool is_dev = false;
@@ -69,7 +80,7 @@ NFS::MkNod3Worker::MkNod3Worker(NFS::Client *client_,
     known_type = ftype3_value(*type, &args.what.type);
     if (!known_type) {
         Nan::ThrowTypeError("Unknown type");
-        return;
+        return false;
     }
     switch (args.what.type) {
     default:
@@ -77,7 +88,7 @@ NFS::MkNod3Worker::MkNod3Worker(NFS::Client *client_,
     case NF3DIR:
     case NF3LNK:
         Nan::ThrowTypeError("Invalid creation mode");
-        return;
+        return false;
     case NF3BLK:
     case NF3CHR:
         /* object is composed of {rdev, attrs} */
@@ -86,7 +97,7 @@ NFS::MkNod3Worker::MkNod3Worker(NFS::Client *client_,
         if (!rdev->IsObject()) {
             Nan::ThrowTypeError("Invalid argument in mknodData, "
                                 "rdev is not an object");
-            return;
+            return false;
         }
         is_dev = true;
         //fallthrough
@@ -98,7 +109,7 @@ NFS::MkNod3Worker::MkNod3Worker(NFS::Client *client_,
         if (!attrs->IsObject()) {
             Nan::ThrowTypeError("Invalid argument in mknodData, "
                                 "attrs is not an object");
-            return;
+            return false;
         }
     }
 
@@ -115,6 +126,23 @@ NFS::MkNod3Worker::MkNod3Worker(NFS::Client *client_,
         args.what.mknoddata3_u.pipe_attributes =
                 node_nfsc_sattr3(v8::Local<v8::Object>::Cast(attrs));
     }
+    return true;
+}
+
+void NFS::MkNod3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    NameCache &names = client->getConnection()->getNameCache();
+    if (res.status == NFS3_OK) {
+        cache.put(res.MKNOD3res_u.resok.obj,
+                  res.MKNOD3res_u.resok.obj_attributes);
+        cache.put(args.where.dir, res.MKNOD3res_u.resok.dir_wcc);
+        names.added(args.where.dir, res.MKNOD3res_u.resok.dir_wcc,
+                    args.where.name, res.MKNOD3res_u.resok.obj);
+    } else {
+        cache.put(args.where.dir, res.MKNOD3res_u.resfail.dir_wcc);
+        names.modified(args.where.dir, res.MKNOD3res_u.resfail.dir_wcc);
+    }
 }
 
 void NFS::MkNod3Worker::procSuccess()
@@ -179,7 +207,7 @@ void NFS::MkNod3Worker::procFailure()
     wcc->Set(Nan::New("before").ToLocalChecked(), before);
     wcc->Set(Nan::New("after").ToLocalChecked(), after);
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         wcc
     };
     callback->Call(2, argv);
@@ -43,13 +43,13 @@ NAN_METHOD(NFS::Client::Mount3) {
     Nan::AsyncQueueWorker(new NFS::Mount3Worker(obj, callback));
 }
 
-AUTH *NFS::Mount3Worker::createUnixAuth(int uid, int gid)
+AUTH *NFS::Mount3Worker::createUnixAuth(int uid, int gid, int *error)
 {
     char machname[MAX_MACHINE_NAME +1];
     int gids[1];
 
     if(gethostname(machname, MAX_MACHINE_NAME) == -1) {
-        NFSC_ASPRINTF(&error, NFSC_EGETHOSTNAME);
+        *error = NFSC_EGETHOSTNAME;
         return NULL;
     }
 
@@ -80,7 +80,7 @@ CLIENT *NFS::Mount3Worker::createMountClient()
         ret = gethostbyname_r(host, &hp, hostBuf, sizeof hostBuf, &result, &err);
         if (ret != 0 || result == NULL)
         {
-            NFSC_ASPRINTF(&error, NFSC_EGETHOSTBYNAME": %s: %s", host, strerror(err));
+            error = NFSC_EGETHOSTBYNAME;
             return(NULL);
         }
         memmove(&server_addr.sin_addr.s_addr, hp.h_addr, hp.h_length);
@@ -99,6 +99,7 @@ CLIENT *NFS::Mount3Worker::createMountClient()
                                          &sock)) == (CLIENT *)0)
         {
             clnt_pcreateerror(const_cast<char*>("mnt_clntudp_create"));
+            error = rpc_error_code(rpc_createerr.cf_stat);
             return(NULL);
         }
     }
@@ -111,13 +112,14 @@ CLIENT *NFS::Mount3Worker::createMountClient()
                                          0)) == (CLIENT*)0)
         {
             clnt_pcreateerror(const_cast<char*>("mnt_clnttcp_create"));
+            error = rpc_error_code(rpc_createerr.cf_stat);
             return NULL;
         }
     }
 
     clnt_control(mntclient, CLSET_TIMEOUT, (char *) &timeout);
 
-    mntclient->cl_auth = createUnixAuth(uid, gid);
+    mntclient->cl_auth = createUnixAuth(uid, gid, &error);
     if (mntclient->cl_auth == NULL)
     {
         clnt_destroy(mntclient);
@@ -127,7 +129,7 @@ CLIENT *NFS::Mount3Worker::createMountClient()
     return (mntclient);
 }
 
-CLIENT *NFS::Mount3Worker::createNfsClient()
+CLIENT *NFS::Mount3Worker::createNfsClient(NFS::Client *client, int *error)
 {
     struct sockaddr_in	server_addr, addr;
     int			sock;
@@ -149,7 +151,7 @@ CLIENT *NFS::Mount3Worker::createNfsClient()
         ret = gethostbyname_r(host, &hp, hostBuf, sizeof hostBuf, &result, &err);
         if (ret != 0 || result == NULL)
         {
-            NFSC_ASPRINTF(&error, NFSC_EGETHOSTBYNAME": %s: %s", host, strerror(err));
+            *error = NFSC_EGETHOSTBYNAME;
             return(NULL);
         }
         memmove(&server_addr.sin_addr.s_addr, hp.h_addr, hp.h_length);
@@ -169,6 +171,7 @@ CLIENT *NFS::Mount3Worker::createNfsClient()
                                           NFSC_UDP_PACKET_SIZE)) == (CLIENT *)0)
         {
             clnt_pcreateerror(const_cast<char*>("nfs_clntudp_create"));
+            *error = rpc_error_code(rpc_createerr.cf_stat);
             return(NULL);
         }
     }
@@ -180,6 +183,7 @@ CLIENT *NFS::Mount3Worker::createNfsClient()
                                         0)) == (CLIENT*)0)
         {
             clnt_pcreateerror(const_cast<char*>("nfs_clnttcp_create"));
+            *error = rpc_error_code(rpc_createerr.cf_stat);
             return(NULL);
         }
     }
@@ -190,7 +194,7 @@ CLIENT *NFS::Mount3Worker::createNfsClient()
         nfsclient->cl_auth = authnone_create();
     } else if (0 == strcmp(authMethod, "unix")) {
 
-        nfsclient->cl_auth = createUnixAuth(uid, gid);
+        nfsclient->cl_auth = createUnixAuth(uid, gid, error);
         if(nfsclient->cl_auth == NULL)
         {
             clnt_destroy(nfsclient);
@@ -209,7 +213,7 @@ CLIENT *NFS::Mount3Worker::createNfsClient()
         } else if (0 == strcmp(authMethod, "krb5p")) {
             sec.svc = RPCSEC_GSS_SVC_PRIVACY;
         } else {
-            NFSC_ASPRINTF(&error, "Invalid authentication method");
+            *error = NFSC_EINVALIDAUTH;
             clnt_destroy(nfsclient);
             return(NULL);
         }
@@ -222,6 +226,7 @@ CLIENT *NFS::Mount3Worker::createNfsClient()
         if (nfsclient->cl_auth == NULL)
         {
             clnt_pcreateerror(const_cast<char*>("authgss_create_default"));
+            *error = rpc_error_code(rpc_createerr.cf_stat);
             clnt_destroy(nfsclient);
             return NULL;
         }
@@ -236,6 +241,7 @@ bool NFS::Mount3Worker::mount()
     CLIENT *nfsclient = NULL;
     GETATTR3res attr = {};
     GETATTR3args args = {};
+    fattr3 rootAttrs;
     nfsstat3 status;
     enum clnt_stat state;
     mountres3 mount_point;
@@ -252,21 +258,21 @@ bool NFS::Mount3Worker::mount()
     state = mountproc3_mnt_3(const_cast<char**>(&dir), &mount_point, mntclient);
     if (state != RPC_SUCCESS)
       {
-        NFSC_ASPRINTF(&error, "%s", rpc_error(state));
+        error = rpc_error_code(state);
         goto bad;
       }
 
     freeMountRes = true;
     if (MNT3_OK != mount_point.fhs_status)
       {
-        NFSC_ASPRINTF(&error, "%s", mnt3_error(mount_point.fhs_status));
+        error = mnt3_error_code(mount_point.fhs_status);
         goto bad;
       }
     isMounted = true;
     client->setRootFh(mount_point.mountres3_u.mountinfo.fhandle.fhandle3_val,
                       mount_point.mountres3_u.mountinfo.fhandle.fhandle3_len);
 
-    nfsclient = createNfsClient();
+    nfsclient = createNfsClient(client, &error);
     if (NULL == nfsclient)
      {
        goto bad;
@@ -277,20 +283,39 @@ bool NFS::Mount3Worker::mount()
  }
     if (state != RPC_SUCCESS)
       {
-        NFSC_ASPRINTF(&error, "%s", rpc_error(state));
+        error = rpc_error_code(state);
         goto bad;
       }
     status = attr.status;
+    if (NFS3_OK == status)
+        rootAttrs = attr.GETATTR3res_u.resok.obj_attributes;
     clnt_freeres(nfsclient, (xdrproc_t) xdr_GETATTR3res, (char*) &attr);
     if (NFS3_OK != status)
       {
-        NFSC_ASPRINTF(&error, "%s", nfs3_error(status));
+        error = nfs3_error_code(status);
         goto bad;
       }
+    {
+    /* servers not answering FSINFO get the default transfer sizes */
+    FSINFO3args fsargs;
+    FSINFO3res fsinfo = FSINFO3res();
+    fsargs.fsroot = client->getRootFh();
+    if (nfsproc3_fsinfo_3(&fsargs, &fsinfo, nfsclient) == RPC_SUCCESS) {
+        if (NFS3_OK == fsinfo.status)
+            client->getConnection()->setTransferSizes(
+                    fsinfo.FSINFO3res_u.resok.rtmax,
+                    fsinfo.FSINFO3res_u.resok.wtmax,
+                    !strcmp(client->getProtocol(), "udp"));
+        clnt_freeres(nfsclient, (xdrproc_t) xdr_FSINFO3res, (char*) &fsinfo);
+    }
+    }
     clnt_freeres(mntclient, (xdrproc_t) xdr_mountres3, (char *)&mount_point);
     client->setClient(nfsclient);
     client->setMountClient(mntclient);
-    client->setMounted();
+    /* warm the caches with what a previous process saved */
+    client->getConnection()->getCacheFile().load(client->getConnection(),
+                                                 client->getRootFh(),
+                                                 rootAttrs);
     return true;
 
    bad:
@@ -328,18 +353,24 @@ NFS::Mount3Worker::Mount3Worker(NFS::Client *client_,
 }
 
 NFS::Mount3Worker::~Mount3Worker()
-{
-    free(error);
-}
+{}
 
 void NFS::Mount3Worker::Execute()
 {
     if (client->isMounted()) {
-        NFSC_ASPRINTF(&error, NFSC_ALREADY_MOUNTED);
+        error = NFSC_ALREADY_MOUNTED;
         return;
     }
     Serialize my(client);
-    success = mount();
+    /* a shared connection is only mounted by its first client */
+    if (client->getConnection()->getMounts() == 0)
+        success = mount();
+    else
+        success = true;
+    if (success) {
+        client->getConnection()->addMount();
+        client->setMounted();
+    }
 }
 
 void NFS::Mount3Worker::HandleOKCallback()
@@ -359,7 +390,7 @@ void NFS::Mount3Worker::HandleOKCallback()
     }
     else {
         v8::Local<v8::Value> argv[] = {
-            Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked()
+            Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
         };
         callback->Call(1, argv);
     }
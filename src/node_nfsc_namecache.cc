@@ -0,0 +1,301 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <string.h>
+#include "node_nfsc_namecache.h"
+
+static std::string
+name_key(const NFS::FileHandle &dir, const char *name)
+{
+    std::string key(1, char(dir.size()));
+    key.append(dir.getData(), dir.size());
+    key.append(name);
+    return key;
+}
+
+static bool
+cacheable(const char *name)
+{
+    return strcmp(name, ".") && strcmp(name, "..");
+}
+
+static bool
+same_time(const nfstime3 &a, const nfstime3 &b)
+{
+    return a.seconds == b.seconds && a.nseconds == b.nseconds;
+}
+
+NFS::NameCache::NameCache()
+    : lock(),
+      enabled(true),
+      nextGeneration(1),
+      dirs(NFSC_NAME_CACHE_DIRS),
+      names(NFSC_NAME_CACHE_SIZE),
+      hits(0),
+      negativeHits(0),
+      misses(0)
+{}
+
+void NFS::NameCache::configure(bool enabled_)
+{
+    std::lock_guard<std::mutex> my(lock);
+    enabled = enabled_;
+    dirs.clear();
+    names.clear();
+}
+
+/*
+ * Return the state of dir, checked against its current attributes: when
+ * they changed, or dir is new, its entries are dropped and it is
+ * recorded with attrs.
+ */
+NFS::NameCache::Dir *NFS::NameCache::validate(const FileHandle &dir,
+                                             const fattr3 &attrs)
+{
+    Dir &state = dirs.insert(dir);
+    if (!state.generation ||
+        !same_time(state.mtime, attrs.mtime) ||
+        !same_time(state.ctime, attrs.ctime)) {
+        state.generation = nextGeneration++;
+        state.mtime = attrs.mtime;
+        state.ctime = attrs.ctime;
+    }
+    return &state;
+}
+
+/*
+ * Account for a change we made to dir: when nothing else changed dir
+ * since we last saw it, its entries stay valid.
+ */
+void NFS::NameCache::revalidate(const FileHandle &dir, const wcc_data &wcc)
+{
+    Dir *state = dirs.find(dir);
+    if (!state)
+        return;
+    if (!wcc.after.attributes_follow) {
+        dirs.erase(dir);
+        return;
+    }
+    const fattr3 &after = wcc.after.post_op_attr_u.attributes;
+    if (!wcc.before.attributes_follow ||
+        !same_time(state->mtime,
+                   wcc.before.pre_op_attr_u.attributes.mtime) ||
+        !same_time(state->ctime,
+                   wcc.before.pre_op_attr_u.attributes.ctime))
+        state->generation = nextGeneration++;
+    state->mtime = after.mtime;
+    state->ctime = after.ctime;
+}
+
+void NFS::NameCache::set(const FileHandle &dir, const char *name,
+                         const FileHandle *fh)
+{
+    Dir *state = dirs.find(dir);
+    if (!state || !cacheable(name))
+        return;
+    Name &entry = names.insert(name_key(dir, name));
+    entry.negative = !fh;
+    if (fh)
+        entry.fh = *fh;
+    else
+        entry.fh.clear();
+    entry.generation = state->generation;
+}
+
+void NFS::NameCache::forget(const FileHandle &dir, const char *name)
+{
+    names.erase(name_key(dir, name));
+}
+
+NFS::NameCache::Result NFS::NameCache::lookup(const nfs_fh3 &dir,
+                                              const fattr3 &dirAttrs,
+                                              const char *name,
+                                              FileHandle *fh)
+{
+    FileHandle key(dir);
+    std::lock_guard<std::mutex> my(lock);
+    if (!enabled || !cacheable(name))
+        return MISS;
+    Dir *state = dirs.find(key);
+    Name *entry = NULL;
+    if (state) {
+        state = validate(key, dirAttrs);
+        entry = names.find(name_key(key, name));
+    }
+    if (!entry || entry->generation != state->generation) {
+        ++misses;
+        return MISS;
+    }
+    if (entry->negative) {
+        ++negativeHits;
+        return NOT_FOUND;
+    }
+    ++hits;
+    *fh = entry->fh;
+    return FOUND;
+}
+
+void NFS::NameCache::found(const nfs_fh3 &dir, const post_op_attr &dirAttrs,
+                           const char *name, const nfs_fh3 &fh)
+{
+    FileHandle key(dir);
+    FileHandle object(fh);
+    std::lock_guard<std::mutex> my(lock);
+    if (!enabled || !dirAttrs.attributes_follow)
+        return;
+    validate(key, dirAttrs.post_op_attr_u.attributes);
+    set(key, name, &object);
+}
+
+void NFS::NameCache::notFound(const nfs_fh3 &dir,
+                              const post_op_attr &dirAttrs,
+                              const char *name)
+{
+    FileHandle key(dir);
+    std::lock_guard<std::mutex> my(lock);
+    if (!enabled || !dirAttrs.attributes_follow)
+        return;
+    validate(key, dirAttrs.post_op_attr_u.attributes);
+    set(key, name, NULL);
+}
+
+void NFS::NameCache::modified(const nfs_fh3 &dir, const wcc_data &wcc)
+{
+    FileHandle key(dir);
+    std::lock_guard<std::mutex> my(lock);
+    revalidate(key, wcc);
+}
+
+void NFS::NameCache::added(const nfs_fh3 &dir, const wcc_data &wcc,
+                           const char *name, const post_op_fh3 &fh)
+{
+    FileHandle key(dir);
+    std::lock_guard<std::mutex> my(lock);
+    revalidate(key, wcc);
+    if (fh.handle_follows) {
+        FileHandle object(fh.post_op_fh3_u.handle);
+        set(key, name, &object);
+    } else {
+        forget(key, name);
+    }
+}
+
+void NFS::NameCache::removed(const nfs_fh3 &dir, const wcc_data &wcc,
+                             const char *name)
+{
+    FileHandle key(dir);
+    std::lock_guard<std::mutex> my(lock);
+    revalidate(key, wcc);
+    set(key, name, NULL);
+}
+
+void NFS::NameCache::renamed(const nfs_fh3 &fromDir,
+                             const wcc_data &fromWcc,
+                             const char *fromName,
+                             const nfs_fh3 &toDir,
+                             const wcc_data &toWcc,
+                             const char *toName)
+{
+    FileHandle from(fromDir);
+    FileHandle to(toDir);
+    FileHandle fh;
+    std::lock_guard<std::mutex> my(lock);
+    bool known = false;
+    Name *entry = names.find(name_key(from, fromName));
+    Dir *state = dirs.find(from);
+    if (entry && state && !entry->negative &&
+        entry->generation == state->generation) {
+        fh = entry->fh;
+        known = true;
+    }
+    revalidate(from, fromWcc);
+    if (to != from)
+        revalidate(to, toWcc);
+    set(from, fromName, NULL);
+    if (known)
+        set(to, toName, &fh);
+    else
+        forget(to, toName);
+}
+
+void NFS::NameCache::save(std::vector<SavedDir> *savedDirs,
+                          std::vector<SavedName> *savedNames)
+{
+    std::lock_guard<std::mutex> my(lock);
+    savedDirs->reserve(savedDirs->size() + dirs.size());
+    dirs.forEach([&](const FileHandle &fh, const Dir &state) {
+        SavedDir item;
+        item.fh = fh;
+        item.mtime = state.mtime;
+        item.ctime = state.ctime;
+        savedDirs->push_back(item);
+    });
+    names.forEach([&](const std::string &key, const Name &entry) {
+        size_t len = uint8_t(key[0]);
+        SavedName item;
+        item.dir.assign(key.data() + 1, len);
+        /* not looked up, as that would change the order */
+        const Dir *state = dirs.peek(item.dir);
+        if (!state || entry.generation != state->generation)
+            return;
+        item.name.assign(key, 1 + len, std::string::npos);
+        item.negative = entry.negative;
+        item.fh = entry.fh;
+        savedNames->push_back(item);
+    });
+}
+
+void NFS::NameCache::restore(const SavedDir &saved)
+{
+    std::lock_guard<std::mutex> my(lock);
+    if (!enabled)
+        return;
+    Dir &state = dirs.insert(saved.fh);
+    state.generation = nextGeneration++;
+    state.mtime = saved.mtime;
+    state.ctime = saved.ctime;
+}
+
+void NFS::NameCache::restore(const SavedName &saved)
+{
+    std::lock_guard<std::mutex> my(lock);
+    if (!enabled)
+        return;
+    set(saved.dir, saved.name.c_str(), saved.negative ? NULL : &saved.fh);
+}
+
+double NFS::NameCache::getHits() const
+{
+    return hits;
+}
+
+double NFS::NameCache::getNegativeHits() const
+{
+    return negativeHits;
+}
+
+double NFS::NameCache::getMisses() const
+{
+    return misses;
+}
+
+size_t NFS::NameCache::getSize()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return names.size();
+}
@@ -34,15 +34,26 @@ NAN_METHOD(NFS::Client::Null3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[0].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::Null3Worker(obj, callback));
+    NFS::Null3Worker *worker =
+            NFS::WorkerPool<NFS::Null3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::Null3Worker::Null3Worker(NFS::Client *client_,
-                                Nan::Callback *callback)
-    : Procedure3Worker(client_, 0, callback)
+NFS::Null3Worker::Null3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, 0)
 {}
 
+bool NFS::Null3Worker::setup(NFS::Client *client_,
+                             const v8::Local<v8::Value> &callback_)
+{
+    reset(client_, callback_);
+    return true;
+}
+
 void NFS::Null3Worker::procSuccess()
 {
     v8::Local<v8::Value> argv[] = {
@@ -54,7 +65,7 @@ void NFS::Null3Worker::procSuccess()
 void NFS::Null3Worker::procFailure()
 {
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked()
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
     };
     callback->Call(1, argv);
 }
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <string.h>
+#include <algorithm>
+#include "node_nfsc_pagecache.h"
+
+static bool
+same_time(const nfstime3 &a, const nfstime3 &b)
+{
+    return a.seconds == b.seconds && a.nseconds == b.nseconds;
+}
+
+NFS::PageCache::PageCache()
+    : lock(),
+      enabled(false),
+      nextGeneration(1),
+      files(NFSC_PAGE_CACHE_FILES),
+      pages(0),
+      hits(0),
+      misses(0)
+{}
+
+void NFS::PageCache::configure(size_t budget)
+{
+    std::lock_guard<std::mutex> my(lock);
+    enabled = budget >= NFSC_PAGE_SIZE;
+    files.clear();
+    pages.clear();
+    pages.resize(budget / NFSC_PAGE_SIZE);
+}
+
+bool NFS::PageCache::isEnabled()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return enabled;
+}
+
+/*
+ * Return the state of fh, checked against its current attributes: when
+ * they changed, or fh is new, its pages are dropped and it is recorded
+ * with attrs.
+ */
+NFS::PageCache::File *NFS::PageCache::validate(const FileHandle &fh,
+                                               const fattr3 &attrs)
+{
+    File &file = files.insert(fh);
+    if (!file.generation ||
+        !same_time(file.mtime, attrs.mtime) ||
+        !same_time(file.ctime, attrs.ctime)) {
+        file.generation = nextGeneration++;
+        file.mtime = attrs.mtime;
+        file.ctime = attrs.ctime;
+    }
+    return &file;
+}
+
+bool NFS::PageCache::read(const nfs_fh3 &fh, const fattr3 &attrs,
+                          uint64_t offset, uint32_t count,
+                          char *buf, uint32_t *len, bool *eof)
+{
+    PageKey key = { FileHandle(fh), 0 };
+    std::lock_guard<std::mutex> my(lock);
+    if (!enabled)
+        return false;
+    File *file = files.find(key.fh);
+    if (file)
+        file = validate(key.fh, attrs);
+    if (!file || offset > attrs.size) {
+        ++misses;
+        return false;
+    }
+    uint64_t end = std::min(offset + count, attrs.size);
+    for (uint64_t pos = offset ; pos < end ; ) {
+        uint64_t index = pos / NFSC_PAGE_SIZE;
+        uint64_t start = index * NFSC_PAGE_SIZE;
+        uint64_t stop = std::min(end, start + NFSC_PAGE_SIZE);
+        key.index = index;
+        Page *page = pages.find(key);
+        if (!page || page->generation != file->generation ||
+            page->data.size() < stop - start) {
+            ++misses;
+            return false;
+        }
+        memcpy(buf + (pos - offset), page->data.data() + (pos - start),
+               stop - pos);
+        pos = stop;
+    }
+    ++hits;
+    *len = end - offset;
+    *eof = end == attrs.size;
+    return true;
+}
+
+/*
+ * Only whole pages are kept, except for the last page of the file when
+ * the data reaches its end.
+ */
+void NFS::PageCache::fill(const nfs_fh3 &fh, const post_op_attr &attrs,
+                          uint64_t offset, const char *data, uint32_t len)
+{
+    PageKey key = { FileHandle(fh), 0 };
+    std::lock_guard<std::mutex> my(lock);
+    if (!enabled || !attrs.attributes_follow)
+        return;
+    const fattr3 &fattr = attrs.post_op_attr_u.attributes;
+    File *file = validate(key.fh, fattr);
+    uint64_t end = offset + len;
+    uint64_t index = (offset + NFSC_PAGE_SIZE - 1) / NFSC_PAGE_SIZE;
+    for (; index * NFSC_PAGE_SIZE < end ; ++index) {
+        uint64_t start = index * NFSC_PAGE_SIZE;
+        uint64_t size = std::min<uint64_t>(end - start, NFSC_PAGE_SIZE);
+        if (size < NFSC_PAGE_SIZE && end != fattr.size)
+            break;
+        key.index = index;
+        Page &page = pages.insert(key);
+        page.data.assign(data + (start - offset), size);
+        page.generation = file->generation;
+    }
+}
+
+void NFS::PageCache::written(const nfs_fh3 &fh, const wcc_data &wcc,
+                             uint64_t offset, const char *data, uint32_t len)
+{
+    PageKey key = { FileHandle(fh), 0 };
+    std::lock_guard<std::mutex> my(lock);
+    File *file = files.find(key.fh);
+    if (!file)
+        return;
+    if (!wcc.after.attributes_follow) {
+        files.erase(key.fh);
+        return;
+    }
+    const fattr3 &after = wcc.after.post_op_attr_u.attributes;
+    if (!wcc.before.attributes_follow ||
+        !same_time(file->mtime, wcc.before.pre_op_attr_u.attributes.mtime) ||
+        !same_time(file->ctime, wcc.before.pre_op_attr_u.attributes.ctime))
+        file->generation = nextGeneration++;
+    file->mtime = after.mtime;
+    file->ctime = after.ctime;
+
+    uint64_t end = offset + len;
+    for (uint64_t index = offset / NFSC_PAGE_SIZE ;
+         index * NFSC_PAGE_SIZE < end ;
+         ++index) {
+        uint64_t start = index * NFSC_PAGE_SIZE;
+        key.index = index;
+        Page *page = pages.find(key);
+        if (!page || page->generation != file->generation)
+            continue;
+        uint64_t from = std::max(offset, start);
+        uint64_t to = std::min(end, start + NFSC_PAGE_SIZE);
+        /* a short last page grows when the write is contiguous to it */
+        if (from > start + page->data.size())
+            continue;
+        if (to > start + page->data.size())
+            page->data.resize(to - start);
+        memcpy(&page->data[from - start], data + (from - offset), to - from);
+    }
+}
+
+void NFS::PageCache::invalidate(const nfs_fh3 &fh)
+{
+    FileHandle key(fh);
+    std::lock_guard<std::mutex> my(lock);
+    files.erase(key);
+}
+
+double NFS::PageCache::getHits() const
+{
+    return hits;
+}
+
+double NFS::PageCache::getMisses() const
+{
+    return misses;
+}
+
+size_t NFS::PageCache::getSize()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return pages.size();
+}
@@ -0,0 +1,458 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <algorithm>
+#include <string.h>
+#include "node_nfsc.h"
+#include "node_nfsc_pipeline.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_errors3.h"
+#include "node_nfsc_read3.h"
+#include "node_nfsc_slab.h"
+#include "node_nfsc_write3.h"
+#include "node_nfsc_zero.h"
+
+NFS::PipelineWorker::PipelineWorker(NFS::WorkerPoolBase *pool_)
+    : PooledWorker(pool_, false),
+      pipeline(NULL),
+      chunk(),
+      last(false)
+{}
+
+void NFS::PipelineWorker::setup(NFS::Pipeline *pipeline_,
+                                const NFS::PipelineChunk &chunk_,
+                                bool last_)
+{
+    pipeline = pipeline_;
+    chunk = chunk_;
+    last = last_;
+}
+
+void NFS::PipelineWorker::Execute()
+{
+    if (!pipeline->client->isMounted())
+        chunk.error = NFSC_NOT_MOUNTED;
+    else if (last)
+        chunk.error = pipeline->finish();
+    else
+        pipeline->execute(&chunk);
+}
+
+void NFS::PipelineWorker::WorkComplete()
+{
+    Nan::HandleScope scope;
+    if (last)
+        pipeline->finished(chunk.error);
+    else
+        pipeline->complete(&chunk);
+}
+
+void NFS::PipelineWorker::recycle()
+{
+    pipeline = NULL;
+    chunk = PipelineChunk();
+}
+
+NFS::Pipeline::Pipeline(NFS::Client *client_, uint64_t offset,
+                        uint64_t length, uint32_t chunkSize_,
+                        unsigned depth_,
+                        const v8::Local<v8::Value> &callback_)
+    : client(client_),
+      callback(callback_.As<v8::Function>()),
+      persistent(),
+      start_(offset),
+      next(offset),
+      end(length > NFSC_PIPELINE_TO_EOF - offset ? NFSC_PIPELINE_TO_EOF
+                                                 : offset + length),
+      delivered(offset),
+      chunkSize(std::max<uint32_t>(chunkSize_, 1)),
+      depth(1),
+      inFlight(0),
+      paused(false),
+      finishing(false),
+      ending(false),
+      scheduling(false),
+      error(0),
+      ready()
+{
+    setDepth(depth_);
+    persistent.Reset(Nan::New<v8::Object>());
+    /* nobody else may hold the client while we run */
+    keep("client", client->handle());
+}
+
+NFS::Pipeline::~Pipeline()
+{
+    persistent.Reset();
+}
+
+void NFS::Pipeline::keep(const char *name, const v8::Local<v8::Value> &value)
+{
+    Nan::New(persistent)->Set(Nan::New(name).ToLocalChecked(), value);
+}
+
+uint64_t NFS::Pipeline::getStart() const
+{
+    return start_;
+}
+
+uint64_t NFS::Pipeline::getEnd() const
+{
+    return end;
+}
+
+uint64_t NFS::Pipeline::getDelivered() const
+{
+    return delivered;
+}
+
+/* only ever shrinks, chunks past the new end are dropped */
+void NFS::Pipeline::setEnd(uint64_t end_)
+{
+    if (end_ >= end)
+        return;
+    end = end_;
+    while (!ready.empty() && ready.rbegin()->first >= end) {
+        releaseData(&ready.rbegin()->second);
+        ready.erase(ready.rbegin()->first);
+    }
+}
+
+void NFS::Pipeline::setDepth(unsigned depth_)
+{
+    depth = std::min<unsigned>(std::max<unsigned>(depth_, 1),
+                               NFSC_PIPELINE_MAX_DEPTH);
+}
+
+bool NFS::Pipeline::isPaused() const
+{
+    return paused;
+}
+
+void NFS::Pipeline::start()
+{
+    schedule();
+}
+
+void NFS::Pipeline::pause()
+{
+    paused = true;
+}
+
+void NFS::Pipeline::resume()
+{
+    paused = false;
+    schedule();
+}
+
+void NFS::Pipeline::abort(int error_)
+{
+    if (!error)
+        error = error_ ? error_ : NFSC_UNKNOWN_ERROR;
+    schedule();
+}
+
+void NFS::Pipeline::prepare(NFS::PipelineChunk *)
+{
+}
+
+void NFS::Pipeline::deliver(NFS::PipelineChunk *)
+{
+}
+
+bool NFS::Pipeline::hasFinish() const
+{
+    return false;
+}
+
+int NFS::Pipeline::finish()
+{
+    return 0;
+}
+
+void NFS::Pipeline::releaseData(NFS::PipelineChunk *chunk)
+{
+    if (chunk->capacity)
+        Slab::instance().release(chunk->data, chunk->capacity);
+    chunk->data = NULL;
+    chunk->capacity = 0;
+}
+
+void NFS::Pipeline::complete(NFS::PipelineChunk *chunk)
+{
+    --inFlight;
+    if (chunk->error) {
+        if (!error)
+            error = chunk->error;
+        releaseData(chunk);
+    } else {
+        if (chunk->eof || chunk->len < chunk->count)
+            setEnd(chunk->offset + chunk->len);
+        if (chunk->offset < end)
+            ready[chunk->offset] = *chunk;
+        else
+            releaseData(chunk);
+    }
+    schedule();
+}
+
+/*
+ * Deliver what is in order, then issue what the window allows. deliver()
+ * may pause, resume or abort us: a nested call only updates the state
+ * the outer loops check.
+ */
+void NFS::Pipeline::schedule()
+{
+    if (scheduling || ending)
+        return;
+    scheduling = true;
+    while (!error && !paused && !ready.empty() &&
+           ready.begin()->first == delivered) {
+        PipelineChunk chunk = ready.begin()->second;
+        ready.erase(ready.begin());
+        delivered += chunk.len;
+        deliver(&chunk);
+        releaseData(&chunk);
+    }
+    while (!error && !paused && inFlight < depth && next < end &&
+           next - delivered < uint64_t(depth) * chunkSize) {
+        PipelineChunk chunk = PipelineChunk();
+        chunk.offset = next;
+        chunk.count = std::min<uint64_t>(chunkSize, end - next);
+        prepare(&chunk);
+        next += chunk.count;
+        ++inFlight;
+        PipelineWorker *worker =
+                WorkerPool<PipelineWorker>::instance().acquire();
+        worker->setup(this, chunk, false);
+        Nan::AsyncQueueWorker(worker);
+    }
+    scheduling = false;
+    settle();
+}
+
+void NFS::Pipeline::settle()
+{
+    if (inFlight || finishing)
+        return;
+    if (!error && (paused || next < end || !ready.empty()))
+        return;
+    if (!error && hasFinish()) {
+        finishing = true;
+        PipelineWorker *worker =
+                WorkerPool<PipelineWorker>::instance().acquire();
+        worker->setup(this, PipelineChunk(), true);
+        Nan::AsyncQueueWorker(worker);
+        return;
+    }
+    finished(error);
+}
+
+void NFS::Pipeline::finished(int error_)
+{
+    ending = true;
+    for (std::map<uint64_t, PipelineChunk>::iterator it = ready.begin() ;
+         it != ready.end() ;
+         ++it)
+        releaseData(&it->second);
+    ready.clear();
+    done(error_);
+    delete this;
+}
+
+void NFS::pipeline_read(NFS::Client *client, NFS::Channel &channel,
+                        const NFS::FileHandle &fh,
+                        NFS::PipelineChunk *chunk)
+{
+    Connection *connection = client->getConnection();
+    AttrCache &cache = connection->getAttrCache();
+    uint32_t rtmax = connection->getRtmax();
+    READ3args args;
+
+    if (!chunk->data) {
+        chunk->data = Slab::instance().alloc(chunk->count, &chunk->capacity);
+        if (!chunk->data) {
+            chunk->capacity = 0;
+            chunk->error = NFSC_UNKNOWN_ERROR;
+            return;
+        }
+    }
+    fh.toNfs(&args.file);
+    while (chunk->len < chunk->count && !chunk->eof) {
+        READ3res res = READ3res();
+        READ3resok &resok = res.READ3res_u.resok;
+        args.offset = chunk->offset + chunk->len;
+        args.count = std::min(chunk->count - chunk->len, rtmax);
+        resok.data.data_val = chunk->data + chunk->len;
+        resok.data.data_len = chunk->count - chunk->len;
+        clnt_stat stat = channel.check(
+                clnt_call(channel.get(), NFSPROC3_READ,
+                          (xdrproc_t) xdr_READ3args, (caddr_t) &args,
+                          (xdrproc_t) xdr_READ3res_slab, (caddr_t) &res,
+                          client->getTimeout()));
+        if (stat != RPC_SUCCESS) {
+            chunk->error = rpc_error_code(stat);
+            return;
+        }
+        if (res.status != NFS3_OK) {
+            cache.put(args.file, res.READ3res_u.resfail.file_attributes);
+            chunk->error = nfs3_error_code(res.status);
+            return;
+        }
+        cache.put(args.file, resok.file_attributes);
+        if (resok.file_attributes.attributes_follow) {
+            chunk->hasAttrs = true;
+            chunk->attrs = resok.file_attributes.post_op_attr_u.attributes;
+        }
+        chunk->len += resok.data.data_len;
+        /* short READs are resumed, an empty one can only be the end */
+        chunk->eof = resok.eof || !resok.data.data_len;
+    }
+}
+
+void NFS::pipeline_write(NFS::Client *client, NFS::Channel &channel,
+                         const NFS::FileHandle &fh,
+                         NFS::PipelineChunk *chunk, stable_how stable,
+                         bool sparse)
+{
+    Connection *connection = client->getConnection();
+    uint32_t wtmax = connection->getWtmax();
+    WRITE3args args;
+
+    fh.toNfs(&args.file);
+    args.stable = stable;
+    while (chunk->len < chunk->count) {
+        WRITE3res res = WRITE3res();
+        args.offset = chunk->offset + chunk->len;
+        args.count = std::min(chunk->count - chunk->len, wtmax);
+        args.data.data_val = chunk->data + chunk->len;
+        args.data.data_len = args.count;
+        if (sparse && zero_block(args.data.data_val, args.count)) {
+            chunk->len += args.count;
+            chunk->skipped += args.count;
+            continue;
+        }
+        clnt_stat stat = channel.check(
+                nfsproc3_write_3(&args, &res, channel.get()));
+        if (stat != RPC_SUCCESS) {
+            chunk->error = rpc_error_code(stat);
+            return;
+        }
+        write3_update_caches(connection, args, res);
+        WRITE3resok &resok = res.WRITE3res_u.resok;
+        if (res.status != NFS3_OK || !resok.count) {
+            chunk->error = nfs3_error_code(res.status != NFS3_OK ? res.status
+                                                                 : NFS3ERR_IO);
+            xdr_free((xdrproc_t) xdr_WRITE3res, (char *)&res);
+            return;
+        }
+        chunk->len += std::min(resok.count, args.count);
+        if (resok.committed == UNSTABLE) {
+            /* the server restarted since our first WRITEs, redo them */
+            if (chunk->unstable &&
+                memcmp(chunk->verf, resok.verf, NFS3_WRITEVERFSIZE)) {
+                chunk->len = 0;
+                chunk->skipped = 0;
+            }
+            chunk->unstable = true;
+            memcpy(chunk->verf, resok.verf, NFS3_WRITEVERFSIZE);
+        }
+        xdr_free((xdrproc_t) xdr_WRITE3res, (char *)&res);
+    }
+}
+
+int NFS::pipeline_commit(NFS::Client *client, NFS::Channel &channel,
+                         const NFS::FileHandle &fh, uint64_t offset,
+                         uint64_t count, char *verf)
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    COMMIT3args args;
+    COMMIT3res res = COMMIT3res();
+
+    fh.toNfs(&args.file);
+    args.offset = offset;
+    /* 0 commits up to the end of the file */
+    args.count = count > UINT32_MAX ? 0 : count;
+    clnt_stat stat = channel.check(
+            nfsproc3_commit_3(&args, &res, channel.get()));
+    if (stat != RPC_SUCCESS)
+        return rpc_error_code(stat);
+    int error = 0;
+    if (res.status == NFS3_OK) {
+        cache.put(args.file, res.COMMIT3res_u.resok.file_wcc);
+        memcpy(verf, res.COMMIT3res_u.resok.verf, NFS3_WRITEVERFSIZE);
+    } else {
+        cache.put(args.file, res.COMMIT3res_u.resfail.file_wcc);
+        error = nfs3_error_code(res.status);
+    }
+    xdr_free((xdrproc_t) xdr_COMMIT3res, (char *)&res);
+    return error;
+}
+
+int NFS::pipeline_extend(NFS::Client *client, NFS::Channel &channel,
+                         const NFS::FileHandle &fh, uint64_t size)
+{
+    Connection *connection = client->getConnection();
+    AttrCache &cache = connection->getAttrCache();
+    GETATTR3args args;
+    SETATTR3args sargs = SETATTR3args();
+
+    fh.toNfs(&args.object);
+    fh.toNfs(&sargs.object);
+    sargs.new_attributes.size.set_it = true;
+    sargs.new_attributes.size.set_size3_u.size = size;
+    for (;;) {
+        GETATTR3res res = GETATTR3res();
+        clnt_stat stat = channel.check(
+                nfsproc3_getattr_3(&args, &res, channel.get()));
+        if (stat != RPC_SUCCESS)
+            return rpc_error_code(stat);
+        if (res.status != NFS3_OK) {
+            int error = nfs3_error_code(res.status);
+            xdr_free((xdrproc_t) xdr_GETATTR3res, (char *)&res);
+            return error;
+        }
+        const fattr3 &attrs = res.GETATTR3res_u.resok.obj_attributes;
+        cache.put(args.object, attrs);
+        bool shorter = attrs.size < size;
+        /* never shrink a file another writer made longer meanwhile */
+        sargs.guard.check = true;
+        sargs.guard.sattrguard3_u.obj_ctime = attrs.ctime;
+        xdr_free((xdrproc_t) xdr_GETATTR3res, (char *)&res);
+        if (!shorter)
+            return 0;
+
+        SETATTR3res sres = SETATTR3res();
+        stat = channel.check(
+                nfsproc3_setattr_3(&sargs, &sres, channel.get()));
+        if (stat != RPC_SUCCESS)
+            return rpc_error_code(stat);
+        connection->getPageCache().invalidate(sargs.object);
+        connection->getReadahead().invalidate(sargs.object);
+        int error = 0;
+        if (sres.status == NFS3_OK) {
+            cache.put(sargs.object, sres.SETATTR3res_u.resok.obj_wcc);
+        } else {
+            cache.put(sargs.object, sres.SETATTR3res_u.resfail.obj_wcc);
+            error = nfs3_error_code(sres.status);
+        }
+        xdr_free((xdrproc_t) xdr_SETATTR3res, (char *)&sres);
+        if (sres.status != NFS3ERR_NOT_SYNC)
+            return error;
+    }
+}
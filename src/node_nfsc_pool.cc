@@ -0,0 +1,158 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include "node_nfsc_pool.h"
+
+static __thread NFS::WorkerPoolBase *first_pool = NULL;
+
+NFS::WorkerPoolBase::WorkerPoolBase(const char *name_,
+                                    NFS::WorkerPoolBase **owner_)
+    : allocated(0),
+      reused(0),
+      outstanding(0),
+      name(name_),
+      owner(owner_),
+      next(first_pool),
+      discarded(0),
+      closed(false),
+      idle()
+{
+    /* never grow on the release path */
+    idle.reserve(NFSC_WORKER_POOL_SIZE);
+    first_pool = this;
+    *owner = this;
+    NFSC_ADD_CLEANUP_HOOK(cleanup, this);
+}
+
+NFS::WorkerPoolBase::~WorkerPoolBase()
+{
+    close();
+}
+
+void NFS::WorkerPoolBase::close()
+{
+    if (closed)
+        return;
+    closed = true;
+    for (size_t i = 0 ; i < idle.size() ; ++i)
+        delete idle[i];
+    idle.clear();
+    for (WorkerPoolBase **pool = &first_pool ; *pool ; pool = &(*pool)->next)
+        if (*pool == this) {
+            *pool = next;
+            break;
+        }
+    *owner = NULL;
+}
+
+void NFS::WorkerPoolBase::cleanup(void *pool_)
+{
+    WorkerPoolBase *pool = static_cast<WorkerPoolBase *>(pool_);
+    /* the workers in flight still point at the pool, the last one frees it */
+    pool->close();
+    if (!pool->outstanding)
+        delete pool;
+}
+
+const char *NFS::WorkerPoolBase::getName() const
+{
+    return name;
+}
+
+NFS::WorkerPoolBase *NFS::WorkerPoolBase::getNext() const
+{
+    return next;
+}
+
+NFS::WorkerPoolBase *NFS::WorkerPoolBase::getFirst()
+{
+    return first_pool;
+}
+
+double NFS::WorkerPoolBase::getAllocated() const
+{
+    return allocated;
+}
+
+double NFS::WorkerPoolBase::getReused() const
+{
+    return reused;
+}
+
+double NFS::WorkerPoolBase::getDiscarded() const
+{
+    return discarded;
+}
+
+size_t NFS::WorkerPoolBase::getIdle() const
+{
+    return idle.size();
+}
+
+size_t NFS::WorkerPoolBase::getOutstanding() const
+{
+    return outstanding;
+}
+
+bool NFS::WorkerPoolBase::release(Nan::AsyncWorker *worker)
+{
+    --outstanding;
+    if (closed) {
+        if (!outstanding)
+            delete this;
+        return false;
+    }
+    if (idle.size() >= NFSC_WORKER_POOL_SIZE) {
+        ++discarded;
+        return false;
+    }
+    idle.push_back(worker);
+    return true;
+}
+
+Nan::AsyncWorker *NFS::WorkerPoolBase::pop()
+{
+    if (idle.empty())
+        return NULL;
+    Nan::AsyncWorker *worker = idle.back();
+    idle.pop_back();
+    return worker;
+}
+
+// ( ) -> { procedure: { allocated, reused, discarded, idle, outstanding },
+//          ... }
+NAN_METHOD(NFS::WorkerPoolStats) {
+    v8::Local<v8::Object> stats = Nan::New<v8::Object>();
+    for (WorkerPoolBase *pool = WorkerPoolBase::getFirst() ;
+         pool ;
+         pool = pool->getNext()) {
+        v8::Local<v8::Object> item = Nan::New<v8::Object>();
+        item->Set(Nan::New("allocated").ToLocalChecked(),
+                  Nan::New(pool->getAllocated()));
+        item->Set(Nan::New("reused").ToLocalChecked(),
+                  Nan::New(pool->getReused()));
+        item->Set(Nan::New("discarded").ToLocalChecked(),
+                  Nan::New(pool->getDiscarded()));
+        item->Set(Nan::New("idle").ToLocalChecked(),
+                  Nan::New(double(pool->getIdle())));
+        item->Set(Nan::New("outstanding").ToLocalChecked(),
+                  Nan::New(double(pool->getOutstanding())));
+        stats->Set(Nan::New(pool->getName()).ToLocalChecked(), item);
+    }
+    info.GetReturnValue().Set(stats);
+}
@@ -16,9 +16,44 @@
  * @authors:
  *    Guillaume Gimenez <ggim@scality.com>
  */
+#include <algorithm>
 #include "node_nfsc.h"
 #include "node_nfsc_read3.h"
 #include "node_nfsc_fattr3.h"
+#include "node_nfsc_slab.h"
+#include "node_nfsc_readahead.h"
+
+/*
+ * Decode a READ3res into the buffer preset in resok.data, whose data_len
+ * holds the buffer capacity. Unlike xdr_READ3res, this never allocates
+ * and fails if the server returns more than the buffer can hold. There
+ * is nothing to release on XDR_FREE, the buffer belongs to the worker.
+ */
+bool_t
+xdr_READ3res_slab(XDR *xdrs, READ3res *objp)
+{
+    READ3resok *resok = &objp->READ3res_u.resok;
+    char *buf = resok->data.data_val;
+    u_int capacity = resok->data.data_len;
+    u_int len;
+
+    if (xdrs->x_op != XDR_DECODE)
+        return TRUE;
+    if (!xdr_nfsstat3(xdrs, &objp->status))
+        return FALSE;
+    if (objp->status != NFS3_OK)
+        return xdr_READ3resfail(xdrs, &objp->READ3res_u.resfail);
+    if (!xdr_post_op_attr(xdrs, &resok->file_attributes) ||
+        !xdr_count3(xdrs, &resok->count) ||
+        !xdr_bool(xdrs, &resok->eof) ||
+        !xdr_u_int(xdrs, &len))
+        return FALSE;
+    if (len > capacity)
+        return FALSE;
+    resok->data.data_val = buf;
+    resok->data.data_len = len;
+    return xdr_opaque(xdrs, buf, len);
+}
 
 // (object, count, offset, callback(err, eof, buf, obj_attr) )
 NAN_METHOD(NFS::Client::Read3) {
@@ -40,25 +75,156 @@ NAN_METHOD(NFS::Client::Read3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[3].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::Read3Worker(obj, info[0], info[1],
-                                               info[2], callback));
+    NFS::Read3Worker *worker =
+            NFS::WorkerPool<NFS::Read3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::Read3Worker::Read3Worker(NFS::Client *client_,
-                              const v8::Local<v8::Value> &obj_fh_,
-                              const v8::Local<v8::Value> &count_,
-                              const v8::Local<v8::Value> &offset_,
-                              Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_READ3res, callback)
+NFS::Read3Worker::Read3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, 0),
+      chunk(NULL),
+      chunkSize(0),
+      ahead(false),
+      aheadOffset(0),
+      aheadCount(0),
+      aheadGeneration(0)
+{}
+
+NFS::Read3Worker::~Read3Worker()
 {
+    releaseChunk();
+}
+
+void NFS::Read3Worker::releaseChunk()
+{
+    if (chunk)
+        Slab::instance().release(chunk, chunkSize);
+    chunk = NULL;
+    chunkSize = 0;
+}
+
+void NFS::Read3Worker::Execute()
+{
+    Procedure3Worker::Execute();
+    if (success)
+        ahead = client->getConnection()->getReadahead().access(
+                args.file, args.offset, res.READ3res_u.resok.data.data_len,
+                res.READ3res_u.resok.eof, client->getConnection()->getRtmax(),
+                &aheadOffset, &aheadCount, &aheadGeneration);
+}
+
+/* start the READs ahead before the callback so both overlap */
+void NFS::Read3Worker::WorkComplete()
+{
+    if (ahead) {
+        Nan::HandleScope scope;
+        uint32_t rtmax = client->getConnection()->getRtmax();
+        for (uint64_t done = 0 ; done < aheadCount ; done += rtmax) {
+            NFS::ReadaheadWorker *worker =
+                    NFS::WorkerPool<NFS::ReadaheadWorker>::instance()
+                    .acquire();
+            worker->setup(client, args.file, aheadOffset + done,
+                          std::min<uint64_t>(aheadCount - done, rtmax),
+                          aheadGeneration);
+            Nan::AsyncQueueWorker(worker);
+        }
+        ahead = false;
+    }
+    Procedure3Worker::WorkComplete();
+}
+
+void NFS::Read3Worker::recycle()
+{
+    ahead = false;
+    releaseChunk();
+    Procedure3Worker::recycle();
+}
+
+clnt_stat NFS::Read3Worker::xdrProc(READ3args *a, READ3res *r, CLIENT *c)
+{
+    /* the server sends no more than rtmax, a short READ is still valid */
+    a->count = std::min(a->count, client->getConnection()->getRtmax());
+    chunk = Slab::instance().alloc(a->count, &chunkSize);
+    if (!chunk)
+        return RPC_SYSTEMERROR;
+    r->READ3res_u.resok.data.data_val = chunk;
+    r->READ3res_u.resok.data.data_len = chunkSize;
+    return clnt_call(c, NFSPROC3_READ,
+                     (xdrproc_t) xdr_READ3args, (caddr_t) a,
+                     (xdrproc_t) xdr_READ3res_slab, (caddr_t) r,
+                     client->getTimeout());
+}
+
+bool NFS::Read3Worker::setup(NFS::Client *client_,
+                             const v8::Local<v8::Value> &obj_fh_,
+                             const v8::Local<v8::Value> &count_,
+                             const v8::Local<v8::Value> &offset_,
+                             const v8::Local<v8::Value> &callback_)
+{
+    reset(client_, callback_);
     args.file.data.data_val = node::Buffer::Data(obj_fh_);
     args.file.data.data_len = node::Buffer::Length(obj_fh_);
     args.count = count_->NumberValue();
     args.offset = CheckUDouble(offset_->NumberValue());
     if (args.offset == (uint64_t)-1) {
         Nan::ThrowRangeError("Invalid offset");
+        return false;
+    }
+    return true;
+}
+
+void NFS::Read3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    READ3resok &resok = res.READ3res_u.resok;
+    if (res.status == NFS3_OK) {
+        cache.put(args.file, resok.file_attributes);
+        client->getConnection()->getPageCache().fill(args.file,
+                                                     resok.file_attributes,
+                                                     args.offset,
+                                                     resok.data.data_val,
+                                                     resok.data.data_len);
+    } else {
+        cache.put(args.file, res.READ3res_u.resfail.file_attributes);
+    }
+}
+
+bool NFS::Read3Worker::fromCache()
+{
+    PageCache &pages = client->getConnection()->getPageCache();
+    Readahead &readahead = client->getConnection()->getReadahead();
+    READ3resok &resok = res.READ3res_u.resok;
+    uint32_t count = std::min(args.count,
+                              client->getConnection()->getRtmax());
+    fattr3 attrs;
+    uint32_t len;
+    bool eof;
+
+    if ((!pages.isEnabled() && !readahead.isEnabled()) ||
+        !client->getConnection()->getAttrCache().get(args.file, &attrs))
+        return false;
+    chunk = Slab::instance().alloc(count, &chunkSize);
+    if (!chunk)
+        return false;
+    if (!pages.read(args.file, attrs, args.offset, count,
+                    chunk, &len, &eof) &&
+        !readahead.read(args.file, attrs, args.offset, count,
+                        chunk, &len, &eof)) {
+        releaseChunk();
+        return false;
     }
+    resok.file_attributes.attributes_follow = TRUE;
+    resok.file_attributes.post_op_attr_u.attributes = attrs;
+    resok.count = len;
+    resok.eof = eof;
+    resok.data.data_val = chunk;
+    resok.data.data_len = len;
+    res.status = NFS3_OK;
+    return true;
 }
 
 void NFS::Read3Worker::procSuccess()
@@ -72,11 +238,13 @@ void NFS::Read3Worker::procSuccess()
     v8::Local<v8::Value> argv[] = {
         Nan::Null(),
         Nan::New(!!res.READ3res_u.resok.eof),
-        Nan::NewBuffer(res.READ3res_u.resok.data.data_val,
-        res.READ3res_u.resok.data.data_len).ToLocalChecked(),
+        Slab::instance().newBuffer(chunk,
+                                   res.READ3res_u.resok.data.data_len,
+                                   chunkSize),
         obj_attrs
     };
-    //data stolen by node
+    //chunk stolen by node, given back to the slab on finalization
+    chunk = NULL;
     res.READ3res_u.resok.data.data_val = NULL;
     callback->Call(sizeof(argv)/sizeof(*argv), argv);
 }
@@ -84,7 +252,7 @@ void NFS::Read3Worker::procSuccess()
 void NFS::Read3Worker::procFailure()
 {
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked()
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
     };
     callback->Call(1, argv);
 }
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <string.h>
+#include <algorithm>
+#include "node_nfsc.h"
+#include "node_nfsc_readahead.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_read3.h"
+#include "node_nfsc_slab.h"
+
+static bool
+same_time(const nfstime3 &a, const nfstime3 &b)
+{
+    return a.seconds == b.seconds && a.nseconds == b.nseconds;
+}
+
+NFS::Readahead::Readahead()
+    : lock(),
+      maxWindow(0),
+      nextGeneration(1),
+      streams(NFSC_READAHEAD_STREAMS),
+      hits(0),
+      misses(0),
+      issued(0),
+      filled(0)
+{}
+
+void NFS::Readahead::configure(size_t maxWindow_)
+{
+    std::lock_guard<std::mutex> my(lock);
+    /* a single READ must fit in a count3 */
+    maxWindow = std::min<size_t>(maxWindow_, UINT32_MAX);
+    streams.clear();
+}
+
+bool NFS::Readahead::isEnabled()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return maxWindow != 0;
+}
+
+/* close the window, READs still in flight will be ignored */
+void NFS::Readahead::reset(Stream *stream)
+{
+    stream->window = 0;
+    stream->generation = nextGeneration++;
+    stream->pending = 0;
+    stream->data.clear();
+    stream->eof = false;
+    stream->early.clear();
+}
+
+bool NFS::Readahead::read(const nfs_fh3 &fh, const fattr3 &attrs,
+                          uint64_t offset, uint32_t count,
+                          char *buf, uint32_t *len, bool *eof)
+{
+    FileHandle key(fh);
+    std::lock_guard<std::mutex> my(lock);
+    Stream *stream = streams.find(key);
+    if (!stream || !stream->window)
+        return false;
+    uint64_t end = stream->start + stream->data.size();
+    if (stream->data.empty() ||
+        !same_time(stream->mtime, attrs.mtime) ||
+        !same_time(stream->ctime, attrs.ctime) ||
+        offset < stream->start || offset > end ||
+        (end - offset < count && !stream->eof)) {
+        ++misses;
+        return false;
+    }
+    uint32_t n = std::min<uint64_t>(count, end - offset);
+    memcpy(buf, stream->data.data() + (offset - stream->start), n);
+    ++hits;
+    *len = n;
+    *eof = stream->eof && offset + n == end;
+    return true;
+}
+
+bool NFS::Readahead::access(const nfs_fh3 &fh, uint64_t offset,
+                            uint32_t len, bool eof, uint32_t rtmax,
+                            uint64_t *aheadOffset, uint32_t *aheadCount,
+                            uint64_t *generation)
+{
+    FileHandle key(fh);
+    std::lock_guard<std::mutex> my(lock);
+    if (!maxWindow)
+        return false;
+    Stream &stream = streams.insert(key);
+    if (!stream.generation || offset != stream.next)
+        reset(&stream);
+    else
+        stream.window = std::min<uint64_t>(
+                maxWindow,
+                std::max<uint64_t>(std::max<uint64_t>(stream.window * 2ULL,
+                                                      len * 2ULL),
+                                   NFSC_READAHEAD_MIN_WINDOW));
+    stream.next = offset + len;
+    if (!stream.window || eof || stream.pending)
+        return false;
+
+    uint64_t end = stream.start + stream.data.size();
+    if (stream.data.empty() || end < stream.next ||
+        stream.start > stream.next) {
+        stream.data.clear();
+        stream.eof = false;
+        stream.start = stream.next;
+        end = stream.next;
+    }
+    /* keep at least half a window ahead of the reader */
+    if (stream.eof || end - stream.next >= stream.window / 2)
+        return false;
+    stream.pending = (stream.window + uint64_t(rtmax) - 1) / rtmax;
+    ++issued;
+    *aheadOffset = end;
+    *aheadCount = stream.window;
+    *generation = stream.generation;
+    return true;
+}
+
+bool NFS::Readahead::fill(const FileHandle &fh, uint64_t generation,
+                          uint64_t offset, const post_op_attr &attrs,
+                          const char *data, uint32_t len, bool eof)
+{
+    std::lock_guard<std::mutex> my(lock);
+    Stream *stream = streams.find(fh);
+    if (!stream || stream->generation != generation)
+        return false;
+    if (!attrs.attributes_follow) {
+        /* nothing to check the data against, start over */
+        reset(stream);
+        return true;
+    }
+    --stream->pending;
+    const fattr3 &fattr = attrs.post_op_attr_u.attributes;
+    if (!same_time(stream->mtime, fattr.mtime) ||
+        !same_time(stream->ctime, fattr.ctime)) {
+        stream->data.clear();
+        stream->early.clear();
+        stream->eof = false;
+        stream->start = offset;
+        stream->mtime = fattr.mtime;
+        stream->ctime = fattr.ctime;
+    }
+    /* drop what the reader is done with before growing the buffer */
+    if (stream->next > stream->start) {
+        uint64_t consumed = std::min<uint64_t>(stream->next - stream->start,
+                                               stream->data.size());
+        stream->data.erase(0, consumed);
+        stream->start += consumed;
+    }
+    uint64_t end = stream->start + stream->data.size();
+    if (!stream->eof && offset > end) {
+        Early &early = stream->early[offset];
+        early.data.assign(data, len);
+        early.eof = eof;
+    } else if (!stream->eof && offset == end) {
+        stream->data.append(data, len);
+        stream->eof = eof;
+        std::map<uint64_t, Early>::iterator it;
+        while (!stream->eof &&
+               (it = stream->early.find(stream->start +
+                                        stream->data.size())) !=
+               stream->early.end()) {
+            stream->data.append(it->second.data);
+            stream->eof = it->second.eof;
+            stream->early.erase(it);
+        }
+    }
+    /* what a short READ left out of order will never be contiguous */
+    if (stream->eof || !stream->pending)
+        stream->early.clear();
+    if (!stream->pending)
+        ++filled;
+    return true;
+}
+
+bool NFS::Readahead::failed(const FileHandle &fh, uint64_t generation)
+{
+    std::lock_guard<std::mutex> my(lock);
+    Stream *stream = streams.find(fh);
+    if (!stream || stream->generation != generation)
+        return false;
+    reset(stream);
+    return true;
+}
+
+void NFS::Readahead::invalidate(const nfs_fh3 &fh)
+{
+    FileHandle key(fh);
+    std::lock_guard<std::mutex> my(lock);
+    Stream *stream = streams.find(key);
+    if (stream)
+        reset(stream);
+}
+
+double NFS::Readahead::getHits() const
+{
+    return hits;
+}
+
+double NFS::Readahead::getMisses() const
+{
+    return misses;
+}
+
+double NFS::Readahead::getIssued() const
+{
+    return issued;
+}
+
+double NFS::Readahead::getFilled() const
+{
+    return filled;
+}
+
+NFS::ReadaheadWorker::ReadaheadWorker(NFS::WorkerPoolBase *pool_)
+    : PooledWorker(pool_, false),
+      client(0),
+      fh(),
+      generation(0),
+      args(),
+      res()
+{}
+
+void NFS::ReadaheadWorker::setup(NFS::Client *client_, const nfs_fh3 &fh_,
+                                 uint64_t offset, uint32_t count,
+                                 uint64_t generation_)
+{
+    client = client_;
+    /* nobody waits for us, keep the client alive until we are done */
+    SaveToPersistent("client", client->handle());
+    fh = FileHandle(fh_);
+    generation = generation_;
+    fh.toNfs(&args.file);
+    args.offset = offset;
+    args.count = count;
+}
+
+void NFS::ReadaheadWorker::Execute()
+{
+    Connection *connection = client->getConnection();
+    Readahead &readahead = connection->getReadahead();
+    READ3resok &resok = res.READ3res_u.resok;
+    size_t chunkSize;
+    char *chunk;
+    clnt_stat stat;
+
+    if (!client->isMounted() ||
+        !(chunk = Slab::instance().alloc(args.count, &chunkSize))) {
+        readahead.failed(fh, generation);
+        return;
+    }
+    resok.data.data_val = chunk;
+    resok.data.data_len = chunkSize;
+    {
+        Channel channel(client);
+        stat = channel.check(
+                clnt_call(channel.get(), NFSPROC3_READ,
+                          (xdrproc_t) xdr_READ3args, (caddr_t) &args,
+                          (xdrproc_t) xdr_READ3res_slab, (caddr_t) &res,
+                          client->getTimeout()));
+    }
+    /*
+     * Our own writes invalidate the stream under the client lock: once
+     * we hold it, either one did since the READ and the stream moved on,
+     * or none will until our results are in the caches.
+     */
+    Serialize my(client);
+    if (stat != RPC_SUCCESS || res.status != NFS3_OK) {
+        if (readahead.failed(fh, generation) && stat == RPC_SUCCESS)
+            connection->getAttrCache().put(args.file,
+                                           res.READ3res_u.resfail
+                                           .file_attributes);
+    } else if (readahead.fill(fh, generation, args.offset,
+                              resok.file_attributes, resok.data.data_val,
+                              resok.data.data_len, resok.eof)) {
+        connection->getAttrCache().put(args.file, resok.file_attributes);
+        connection->getPageCache().fill(args.file, resok.file_attributes,
+                                        args.offset, resok.data.data_val,
+                                        resok.data.data_len);
+    }
+    Slab::instance().release(chunk, chunkSize);
+}
+
+void NFS::ReadaheadWorker::WorkComplete()
+{
+}
+
+void NFS::ReadaheadWorker::recycle()
+{
+    Nan::HandleScope scope;
+    SaveToPersistent("client", Nan::Undefined());
+    client = 0;
+    res = READ3res();
+}
@@ -43,9 +43,13 @@ NAN_METHOD(NFS::Client::ReadDir3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[4].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::ReadDir3Worker(obj, info[0], info[1],
-                                                  info[2], info[3], callback));
+    NFS::ReadDir3Worker *worker =
+            NFS::WorkerPool<NFS::ReadDir3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3], info[4])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
 static v8::Local<v8::Array>
@@ -79,21 +83,25 @@ readdir_entries(READDIR3res *res)
     return list;
 }
 
-NFS::ReadDir3Worker::ReadDir3Worker(NFS::Client *client_,
-                                  const v8::Local<v8::Value> &dir_fh_,
-                                  const v8::Local<v8::Value> &cookie_,
-                                  const v8::Local<v8::Value> &cookieverf_,
-                                  const v8::Local<v8::Value> &count_,
-                                  Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_READDIR3res, callback)
+NFS::ReadDir3Worker::ReadDir3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_READDIR3res)
+{}
+
+bool NFS::ReadDir3Worker::setup(NFS::Client *client_,
+                                const v8::Local<v8::Value> &dir_fh_,
+                                const v8::Local<v8::Value> &cookie_,
+                                const v8::Local<v8::Value> &cookieverf_,
+                                const v8::Local<v8::Value> &count_,
+                                const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
     args.dir.data.data_val = node::Buffer::Data(dir_fh_);
     args.dir.data.data_len = node::Buffer::Length(dir_fh_);
     args.count = count_->Uint32Value();
     if (!cookie_->IsNull()) {
         if (node::Buffer::Length(cookie_) != sizeof(args.cookie)) {
             Nan::ThrowRangeError("Invalid cookie size");
-            return;
+            return false;
         }
         memcpy(&args.cookie, node::Buffer::Data(cookie_), sizeof(args.cookie));
     } else {
@@ -102,7 +110,7 @@ NFS::ReadDir3Worker::ReadDir3Worker(NFS::Client *client_,
     if (!cookieverf_->IsNull()) {
         if (node::Buffer::Length(cookieverf_) != sizeof(args.cookieverf)) {
             Nan::ThrowRangeError("Invalid cookiverf size");
-            return;
+            return false;
         }
         memcpy(&args.cookieverf,
                node::Buffer::Data(cookieverf_),
@@ -110,6 +118,16 @@ NFS::ReadDir3Worker::ReadDir3Worker(NFS::Client *client_,
     } else {
         memset(&args.cookieverf, 0, sizeof(args.cookieverf));
     }
+    return true;
+}
+
+void NFS::ReadDir3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    if (res.status == NFS3_OK)
+        cache.put(args.dir, res.READDIR3res_u.resok.dir_attributes);
+    else
+        cache.put(args.dir, res.READDIR3res_u.resfail.dir_attributes);
 }
 
 void NFS::ReadDir3Worker::procSuccess()
@@ -139,7 +157,7 @@ void NFS::ReadDir3Worker::procSuccess()
 void NFS::ReadDir3Worker::procFailure()
 {
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked()
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
     };
     callback->Call(1, argv);
 }
@@ -45,9 +45,14 @@ NAN_METHOD(NFS::Client::ReadDirPlus3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[5].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::ReadDirPlus3Worker(obj, info[0], info[1], info[2],
-            info[3], info[4], callback));
+    NFS::ReadDirPlus3Worker *worker =
+            NFS::WorkerPool<NFS::ReadDirPlus3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3], info[4],
+                       info[5])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
 static v8::Local<v8::Array>
@@ -96,15 +101,19 @@ readdirplus_entries(READDIRPLUS3res *res)
     return list;
 }
 
-NFS::ReadDirPlus3Worker::ReadDirPlus3Worker(NFS::Client *client_,
-                                            const v8::Local<v8::Value> &dir_fh_,
-                                            const v8::Local<v8::Value> &cookie_,
-                                            const v8::Local<v8::Value> &cookieverf_,
-                                            const v8::Local<v8::Value> &dircount_,
-                                            const v8::Local<v8::Value> &maxcount_,
-                                            Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_READDIRPLUS3res, callback)
+NFS::ReadDirPlus3Worker::ReadDirPlus3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_READDIRPLUS3res)
+{}
+
+bool NFS::ReadDirPlus3Worker::setup(NFS::Client *client_,
+                                    const v8::Local<v8::Value> &dir_fh_,
+                                    const v8::Local<v8::Value> &cookie_,
+                                    const v8::Local<v8::Value> &cookieverf_,
+                                    const v8::Local<v8::Value> &dircount_,
+                                    const v8::Local<v8::Value> &maxcount_,
+                                    const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
     args.dir.data.data_val = node::Buffer::Data(dir_fh_);
     args.dir.data.data_len = node::Buffer::Length(dir_fh_);
     args.dircount = dircount_->Uint32Value();
@@ -112,7 +121,7 @@ NFS::ReadDirPlus3Worker::ReadDirPlus3Worker(NFS::Client *client_,
     if (!cookie_->IsNull()) {
         if (node::Buffer::Length(cookie_) != sizeof(args.cookie)) {
             Nan::ThrowRangeError("Invalid cookie size");
-            return;
+            return false;
         }
         memcpy(&args.cookie, node::Buffer::Data(cookie_), sizeof(args.cookie));
     } else {
@@ -121,7 +130,7 @@ NFS::ReadDirPlus3Worker::ReadDirPlus3Worker(NFS::Client *client_,
     if (!cookieverf_->IsNull()) {
         if (node::Buffer::Length(cookieverf_) != sizeof(args.cookieverf)) {
             Nan::ThrowRangeError("Invalid cookiverf size");
-            return;
+            return false;
         }
         memcpy(&args.cookieverf,
                node::Buffer::Data(cookieverf_),
@@ -129,6 +138,21 @@ NFS::ReadDirPlus3Worker::ReadDirPlus3Worker(NFS::Client *client_,
     } else {
         memset(&args.cookieverf, 0, sizeof(args.cookieverf));
     }
+    return true;
+}
+
+void NFS::ReadDirPlus3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    if (res.status != NFS3_OK) {
+        cache.put(args.dir, res.READDIRPLUS3res_u.resfail.dir_attributes);
+        return;
+    }
+    cache.put(args.dir, res.READDIRPLUS3res_u.resok.dir_attributes);
+    for (entryplus3 *entry = res.READDIRPLUS3res_u.resok.reply.entries ;
+         entry ;
+         entry = entry->nextentry)
+        cache.put(entry->name_handle, entry->name_attributes);
 }
 
 void NFS::ReadDirPlus3Worker::procSuccess()
@@ -158,7 +182,7 @@ void NFS::ReadDirPlus3Worker::procSuccess()
 void NFS::ReadDirPlus3Worker::procFailure()
 {
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked()
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
     };
     callback->Call(1, argv);
 }
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "node_nfsc.h"
+#include "node_nfsc_readfile.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_errors3.h"
+#include "node_nfsc_options.h"
+#include "node_nfsc_slab.h"
+
+// (object, options, callback(err, data) )
+NAN_METHOD(NFS::Client::ReadFile) {
+    bool typeError = true;
+    if (info.Length() != 3) {
+        Nan::ThrowTypeError("Must be called with 3 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, object must be a Buffer");
+    else if (!info[1]->IsUndefined() && !info[1]->IsNull() &&
+             !info[1]->IsObject())
+        Nan::ThrowTypeError("Parameter 2, options must be an object");
+    else if (!info[2]->IsFunction())
+        Nan::ThrowTypeError("Parameter 3, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    uint64_t offset = CheckUDouble(option_number(info[1], "offset", 0));
+    double length_ = option_number(info[1], "length", -1);
+    uint64_t length = length_ < 0 ? NFSC_PIPELINE_TO_EOF
+                                  : CheckUDouble(length_);
+    if (offset == (uint64_t)-1 || (length_ >= 0 && length == (uint64_t)-1)) {
+        Nan::ThrowRangeError("Invalid offset or length");
+        return;
+    }
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    uint32_t chunkSize = option_uint(info[1], "chunkSize",
+                                     obj->getConnection()->getRtmax());
+    unsigned depth = option_uint(info[1], "depth", NFSC_PIPELINE_DEPTH);
+    bool chunked = option_bool(info[1], "chunks", false);
+    NFS::ReadFileJob *job = new NFS::ReadFileJob(obj, info[0], offset, length,
+                                                 chunkSize, depth, chunked,
+                                                 info[2]);
+    if (!chunked && length != NFSC_PIPELINE_TO_EOF && !job->allocate(length)) {
+        delete job;
+        Nan::ThrowRangeError("Length too large for a Buffer, use chunks");
+        return;
+    }
+    job->start();
+}
+
+NFS::ReadFileJob::ReadFileJob(NFS::Client *client_,
+                              const v8::Local<v8::Value> &obj_fh_,
+                              uint64_t offset, uint64_t length,
+                              uint32_t chunkSize_, unsigned depth_,
+                              bool chunked_,
+                              const v8::Local<v8::Value> &callback_)
+    : Pipeline(client_, offset, length, chunkSize_,
+               chunked_ || length != NFSC_PIPELINE_TO_EOF ? depth_ : 1,
+               callback_),
+      fh(node::Buffer::Data(obj_fh_), node::Buffer::Length(obj_fh_)),
+      chunked(chunked_),
+      wantedDepth(depth_),
+      dest(NULL),
+      sized(false),
+      spill(),
+      chunks(),
+      chunkCount(0)
+{
+    if (chunked)
+        chunks.Reset(Nan::New<v8::Array>());
+}
+
+NFS::ReadFileJob::~ReadFileJob()
+{
+    free(dest);
+    chunks.Reset();
+}
+
+bool NFS::ReadFileJob::allocate(uint64_t size)
+{
+    if (size > node::Buffer::kMaxLength)
+        return false;
+    /* one more byte, so that an empty file still gets a pointer */
+    dest = static_cast<char *>(malloc(size + 1));
+    sized = dest != NULL;
+    return sized;
+}
+
+void NFS::ReadFileJob::prepare(NFS::PipelineChunk *chunk)
+{
+    if (sized)
+        chunk->data = dest + (chunk->offset - getStart());
+}
+
+void NFS::ReadFileJob::execute(NFS::PipelineChunk *chunk)
+{
+    Channel channel(client);
+    pipeline_read(client, channel, fh, chunk);
+}
+
+void NFS::ReadFileJob::deliver(NFS::PipelineChunk *chunk)
+{
+    if (chunked) {
+        v8::Local<v8::Object> buffer =
+                Slab::instance().newBuffer(chunk->data, chunk->len,
+                                           chunk->capacity);
+        /* the Buffer owns the slab chunk now */
+        chunk->data = NULL;
+        chunk->capacity = 0;
+        Nan::New(chunks)->Set(chunkCount++, buffer);
+        return;
+    }
+    if (sized)
+        return;
+    if (!spill.empty() || !chunk->hasAttrs) {
+        spill.append(chunk->data, chunk->len);
+        return;
+    }
+    /* the first chunk tells the size, read the rest in place */
+    uint64_t end = std::max(chunk->attrs.size, getDelivered());
+    setEnd(end);
+    if (!allocate(getEnd() - getStart())) {
+        abort(nfs3_error_code(NFS3ERR_FBIG));
+        return;
+    }
+    memcpy(dest, chunk->data, chunk->len);
+    setDepth(wantedDepth);
+}
+
+void NFS::ReadFileJob::done(int error_)
+{
+    if (error_) {
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::Integer>(error_)
+        };
+        callback.Call(1, argv);
+        return;
+    }
+    v8::Local<v8::Value> data;
+    if (chunked) {
+        data = Nan::New(chunks);
+    } else if (sized && getDelivered() > getStart()) {
+        data = Nan::NewBuffer(dest, getDelivered() - getStart())
+                .ToLocalChecked();
+        dest = NULL;
+    } else if (sized) {
+        data = Nan::NewBuffer(0).ToLocalChecked();
+    } else {
+        data = Nan::CopyBuffer(spill.data(), spill.size()).ToLocalChecked();
+    }
+    v8::Local<v8::Value> argv[] = {
+        Nan::Null(),
+        data
+    };
+    callback.Call(sizeof(argv)/sizeof(*argv), argv);
+}
@@ -36,17 +36,36 @@ NAN_METHOD(NFS::Client::ReadLink3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::ReadLink3Worker(obj, info[0], callback));
+    NFS::ReadLink3Worker *worker =
+            NFS::WorkerPool<NFS::ReadLink3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::ReadLink3Worker::ReadLink3Worker(NFS::Client *client_,
-                                      const v8::Local<v8::Value> &obj_fh_,
-                                      Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_READLINK3res, callback)
+NFS::ReadLink3Worker::ReadLink3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_READLINK3res)
+{}
+
+bool NFS::ReadLink3Worker::setup(NFS::Client *client_,
+                                 const v8::Local<v8::Value> &obj_fh_,
+                                 const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
     args.symlink.data.data_val = node::Buffer::Data(obj_fh_);
     args.symlink.data.data_len = node::Buffer::Length(obj_fh_);
+    return true;
+}
+
+void NFS::ReadLink3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    if (res.status == NFS3_OK)
+        cache.put(args.symlink, res.READLINK3res_u.resok.symlink_attributes);
+    else
+        cache.put(args.symlink, res.READLINK3res_u.resfail.symlink_attributes);
 }
 
 void NFS::ReadLink3Worker::procSuccess()
@@ -80,7 +99,7 @@ void NFS::ReadLink3Worker::procFailure()
     else
         obj_attrs = Nan::Null();
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         obj_attrs
     };
     callback->Call(sizeof(argv)/sizeof(*argv), argv);
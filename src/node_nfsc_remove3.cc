@@ -39,21 +39,47 @@ NAN_METHOD(NFS::Client::Remove3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::Remove3Worker(obj, info[0], info[1],
-                                                 callback));
+    NFS::Remove3Worker *worker =
+            NFS::WorkerPool<NFS::Remove3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::Remove3Worker::Remove3Worker(NFS::Client *client_,
-                                  const v8::Local<v8::Value> &parent_fh_,
-                                  const v8::Local<v8::Value> &name_,
-                                  Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_REMOVE3res, callback),
-      name(name_)
+NFS::Remove3Worker::Remove3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_REMOVE3res)
+{}
+
+bool NFS::Remove3Worker::setup(NFS::Client *client_,
+                               const v8::Local<v8::Value> &parent_fh_,
+                               const v8::Local<v8::Value> &name_,
+                               const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
+    if (!name.assign(name_)) {
+        Nan::ThrowError("Out of memory");
+        return false;
+    }
     args.object.dir.data.data_val = node::Buffer::Data(parent_fh_);
     args.object.dir.data.data_len = node::Buffer::Length(parent_fh_);
     args.object.name = *name;
+    return true;
+}
+
+void NFS::Remove3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    NameCache &names = client->getConnection()->getNameCache();
+    if (res.status == NFS3_OK) {
+        cache.put(args.object.dir, res.REMOVE3res_u.resok.dir_wcc);
+        names.removed(args.object.dir, res.REMOVE3res_u.resok.dir_wcc,
+                      args.object.name);
+    } else {
+        cache.put(args.object.dir, res.REMOVE3res_u.resfail.dir_wcc);
+        names.modified(args.object.dir, res.REMOVE3res_u.resfail.dir_wcc);
+    }
 }
 
 void NFS::Remove3Worker::procSuccess()
@@ -97,7 +123,7 @@ void NFS::Remove3Worker::procFailure()
     wcc->Set(Nan::New("before").ToLocalChecked(), before);
     wcc->Set(Nan::New("after").ToLocalChecked(), after);
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         wcc
     };
     callback->Call(2, argv);
@@ -0,0 +1,481 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <string.h>
+#include <algorithm>
+#include "node_nfsc.h"
+#include "node_nfsc_removetree.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_errors3.h"
+#include "node_nfsc_options.h"
+#include "node_nfsc_resolve.h"
+#include "node_nfsc_walk.h"
+
+/* the verifier of a listing from the start */
+static const cookieverf3 no_verf = { 0 };
+
+// (dir, name, options, callback(err, files, directories) )
+NAN_METHOD(NFS::Client::RmTree) {
+    bool typeError = true;
+    if (info.Length() != 4) {
+        Nan::ThrowTypeError("Must be called with 4 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, dir must be a Buffer");
+    else if (!info[1]->IsString())
+        Nan::ThrowTypeError("Parameter 2, name must be a string");
+    else if (!info[2]->IsUndefined() && !info[2]->IsNull() &&
+             !info[2]->IsObject())
+        Nan::ThrowTypeError("Parameter 3, options must be an object");
+    else if (!info[3]->IsFunction())
+        Nan::ThrowTypeError("Parameter 4, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    std::string name(*Nan::Utf8String(info[1]));
+    if (name.empty() || name == "." || name == ".." ||
+        name.find('/') != std::string::npos) {
+        Nan::ThrowRangeError("Invalid name");
+        return;
+    }
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    unsigned concurrency = option_uint(info[2], "concurrency",
+                                       NFSC_REMOVE_TREE_CONCURRENCY);
+    NFS::RemoveTree *job = new NFS::RemoveTree(obj, info[0], name,
+                                               concurrency, info[3]);
+    job->start();
+}
+
+NFS::RemoveTreeWorker::RemoveTreeWorker(NFS::WorkerPoolBase *pool_)
+    : PooledWorker(pool_, false),
+      job(NULL),
+      task(),
+      error(0),
+      isDir(false),
+      fh(),
+      files(),
+      subdirs(),
+      more(false),
+      removed(0)
+{}
+
+void NFS::RemoveTreeWorker::setup(NFS::RemoveTree *job_,
+                                  const NFS::RemoveTreeTask &task_)
+{
+    job = job_;
+    task = task_;
+    error = 0;
+    isDir = false;
+    fh.clear();
+    more = false;
+    removed = 0;
+}
+
+void NFS::RemoveTreeWorker::Execute()
+{
+    if (!job->client->isMounted()) {
+        error = NFSC_NOT_MOUNTED;
+        return;
+    }
+    switch (task.kind) {
+    case RemoveTreeTask::LOOKUP: {
+        PathWalker walker;
+        walker.reset(job->client);
+        walker.setFh(task.dir->fh);
+        if (!walker.lookup(task.names.front())) {
+            error = walker.getError();
+            return;
+        }
+        fh = walker.getFh();
+        const fattr3 *attrs = walker.getAttrs();
+        isDir = attrs && attrs->type == NF3DIR;
+        break;
+    }
+    case RemoveTreeTask::LIST:
+        list();
+        break;
+    case RemoveTreeTask::REMOVE:
+        remove();
+        break;
+    case RemoveTreeTask::RMDIR:
+        rmdir();
+        break;
+    }
+}
+
+void NFS::RemoveTreeWorker::list()
+{
+    Client *client = job->client;
+    Channel channel(client);
+    PathWalker walker;
+    READDIRPLUS3args args;
+    uint32_t examined = 0;
+    bool eof = false;
+
+    walker.reset(client);
+    walker.setChannel(&channel);
+    task.dir->fh.toNfs(&args.dir);
+    args.cookie = task.cookie;
+    memcpy(args.cookieverf, task.verf, NFS3_COOKIEVERFSIZE);
+    args.dircount = NFSC_WALK_DIRCOUNT;
+    args.maxcount = NFSC_WALK_MAXCOUNT;
+    while (!eof && examined < NFSC_REMOVE_TREE_BATCH) {
+        READDIRPLUS3res res = READDIRPLUS3res();
+        clnt_stat stat = channel.check(
+                nfsproc3_readdirplus_3(&args, &res, channel.get()));
+        if (stat != RPC_SUCCESS) {
+            error = rpc_error_code(stat);
+            return;
+        }
+        if (res.status == NFS3ERR_BAD_COOKIE && args.cookie) {
+            /* our REMOVEs may void the cookie, what is left starts over */
+            xdr_free((xdrproc_t) xdr_READDIRPLUS3res, (char *)&res);
+            args.cookie = 0;
+            memset(args.cookieverf, 0, NFS3_COOKIEVERFSIZE);
+            continue;
+        }
+        if (res.status != NFS3_OK) {
+            error = nfs3_error_code(res.status);
+            xdr_free((xdrproc_t) xdr_READDIRPLUS3res, (char *)&res);
+            return;
+        }
+        READDIRPLUS3resok &resok = res.READDIRPLUS3res_u.resok;
+        for (entryplus3 *entry = resok.reply.entries ;
+             entry ;
+             entry = entry->nextentry) {
+            args.cookie = entry->cookie;
+            if (!entry->name || !strcmp(entry->name, ".") ||
+                !strcmp(entry->name, ".."))
+                continue;
+            ++examined;
+            if (!classify(&walker, entry->name, entry->name_attributes,
+                          entry->name_handle)) {
+                xdr_free((xdrproc_t) xdr_READDIRPLUS3res, (char *)&res);
+                return;
+            }
+        }
+        memcpy(args.cookieverf, resok.cookieverf, NFS3_COOKIEVERFSIZE);
+        eof = resok.reply.eof;
+        xdr_free((xdrproc_t) xdr_READDIRPLUS3res, (char *)&res);
+    }
+    more = !eof;
+    task.cookie = args.cookie;
+    memcpy(task.verf, args.cookieverf, NFS3_COOKIEVERFSIZE);
+}
+
+/*
+ * File or subdirectory: some servers leave the attributes, or the
+ * handle, out of READDIRPLUS, the entry is then looked up.
+ */
+bool NFS::RemoveTreeWorker::classify(NFS::PathWalker *walker,
+                                     const char *name,
+                                     const post_op_attr &attrs,
+                                     const post_op_fh3 &handle)
+{
+    const fattr3 *fattr;
+    if (attrs.attributes_follow &&
+        attrs.post_op_attr_u.attributes.type != NF3DIR) {
+        files.push_back(name);
+        return true;
+    }
+    if (attrs.attributes_follow && handle.handle_follows) {
+        subdirs.push_back(Subdir());
+        subdirs.back().name = name;
+        subdirs.back().fh = FileHandle(handle.post_op_fh3_u.handle);
+        return true;
+    }
+    walker->setFh(task.dir->fh);
+    if (!walker->lookup(name) || !(fattr = walker->getAttrs())) {
+        /* already gone */
+        if (walker->getError() == NFS3ERR_NOENT)
+            return true;
+        error = walker->getError();
+        return false;
+    }
+    if (fattr->type != NF3DIR) {
+        files.push_back(name);
+        return true;
+    }
+    subdirs.push_back(Subdir());
+    subdirs.back().name = name;
+    subdirs.back().fh = walker->getFh();
+    return true;
+}
+
+void NFS::RemoveTreeWorker::remove()
+{
+    Client *client = job->client;
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    NameCache &names = client->getConnection()->getNameCache();
+    Channel channel(client);
+    REMOVE3args args;
+
+    task.dir->fh.toNfs(&args.object.dir);
+    for (size_t i = 0 ; i < task.names.size() ; ++i) {
+        REMOVE3res res = REMOVE3res();
+        args.object.name = const_cast<char *>(task.names[i].c_str());
+        clnt_stat stat = channel.check(
+                nfsproc3_remove_3(&args, &res, channel.get()));
+        if (stat != RPC_SUCCESS) {
+            error = rpc_error_code(stat);
+            return;
+        }
+        if (res.status == NFS3_OK) {
+            cache.put(args.object.dir, res.REMOVE3res_u.resok.dir_wcc);
+            names.removed(args.object.dir, res.REMOVE3res_u.resok.dir_wcc,
+                          args.object.name);
+            ++removed;
+        } else {
+            cache.put(args.object.dir, res.REMOVE3res_u.resfail.dir_wcc);
+            names.modified(args.object.dir, res.REMOVE3res_u.resfail.dir_wcc);
+            /* already gone is as good as removed */
+            if (res.status != NFS3ERR_NOENT)
+                error = nfs3_error_code(res.status);
+        }
+        xdr_free((xdrproc_t) xdr_REMOVE3res, (char *)&res);
+        if (error)
+            return;
+    }
+}
+
+void NFS::RemoveTreeWorker::rmdir()
+{
+    Client *client = job->client;
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    NameCache &names = client->getConnection()->getNameCache();
+    Channel channel(client);
+    RMDIR3args args;
+    RMDIR3res res = RMDIR3res();
+
+    task.dir->parent->fh.toNfs(&args.object.dir);
+    args.object.name = const_cast<char *>(task.dir->name.c_str());
+    clnt_stat stat = channel.check(
+            nfsproc3_rmdir_3(&args, &res, channel.get()));
+    if (stat != RPC_SUCCESS) {
+        error = rpc_error_code(stat);
+        return;
+    }
+    if (res.status == NFS3_OK) {
+        cache.put(args.object.dir, res.RMDIR3res_u.resok.dir_wcc);
+        names.removed(args.object.dir, res.RMDIR3res_u.resok.dir_wcc,
+                      args.object.name);
+        removed = 1;
+    } else {
+        cache.put(args.object.dir, res.RMDIR3res_u.resfail.dir_wcc);
+        names.modified(args.object.dir, res.RMDIR3res_u.resfail.dir_wcc);
+        if (res.status != NFS3ERR_NOENT)
+            error = nfs3_error_code(res.status);
+    }
+    xdr_free((xdrproc_t) xdr_RMDIR3res, (char *)&res);
+}
+
+void NFS::RemoveTreeWorker::WorkComplete()
+{
+    Nan::HandleScope scope;
+    job->complete(this);
+}
+
+void NFS::RemoveTreeWorker::recycle()
+{
+    job = NULL;
+    task = RemoveTreeTask();
+    files.clear();
+    subdirs.clear();
+}
+
+NFS::RemoveTree::RemoveTree(NFS::Client *client_,
+                            const v8::Local<v8::Value> &dir_fh_,
+                            const std::string &name, unsigned concurrency_,
+                            const v8::Local<v8::Value> &callback_)
+    : client(client_),
+      callback(callback_.As<v8::Function>()),
+      persistent(),
+      concurrency(std::min<unsigned>(std::max<unsigned>(concurrency_, 1),
+                                     NFSC_MAX_CHANNELS)),
+      dirs(),
+      top(NULL),
+      tasks(),
+      inFlight(0),
+      error(0),
+      files(0),
+      directories(0)
+{
+    top = addDir(NULL, std::string(),
+                 FileHandle(node::Buffer::Data(dir_fh_),
+                            node::Buffer::Length(dir_fh_)));
+    /* released once name is gone */
+    top->pending = 1;
+    std::vector<std::string> names(1, name);
+    push(RemoveTreeTask::LOOKUP, top, &names);
+    persistent.Reset(Nan::New<v8::Object>());
+    /* nobody else may hold the client while we run */
+    Nan::New(persistent)->Set(Nan::New("client").ToLocalChecked(),
+                              client->handle());
+}
+
+NFS::RemoveTree::~RemoveTree()
+{
+    persistent.Reset();
+}
+
+void NFS::RemoveTree::start()
+{
+    schedule();
+}
+
+NFS::RemoveTreeDir *NFS::RemoveTree::addDir(NFS::RemoveTreeDir *parent,
+                                            const std::string &name,
+                                            const NFS::FileHandle &fh)
+{
+    dirs.push_back(RemoveTreeDir());
+    RemoveTreeDir *dir = &dirs.back();
+    dir->fh = fh;
+    dir->parent = parent;
+    dir->name = name;
+    dir->pending = 0;
+    dir->relisted = false;
+    dir->self = --dirs.end();
+    return dir;
+}
+
+void NFS::RemoveTree::push(NFS::RemoveTreeTask::Kind kind,
+                           NFS::RemoveTreeDir *dir,
+                           std::vector<std::string> *names)
+{
+    tasks.push_back(RemoveTreeTask());
+    tasks.back().kind = kind;
+    tasks.back().dir = dir;
+    tasks.back().cookie = 0;
+    memset(tasks.back().verf, 0, NFS3_COOKIEVERFSIZE);
+    if (names)
+        tasks.back().names.swap(*names);
+}
+
+void NFS::RemoveTree::pushList(NFS::RemoveTreeDir *dir,
+                               const cookie3 &cookie,
+                               const cookieverf3 verf)
+{
+    ++dir->pending;
+    push(RemoveTreeTask::LIST, dir, NULL);
+    tasks.back().cookie = cookie;
+    memcpy(tasks.back().verf, verf, NFS3_COOKIEVERFSIZE);
+}
+
+void NFS::RemoveTree::release(NFS::RemoveTreeDir *dir)
+{
+    if (--dir->pending || dir == top)
+        return;
+    push(RemoveTreeTask::RMDIR, dir, NULL);
+}
+
+void NFS::RemoveTree::complete(NFS::RemoveTreeWorker *worker)
+{
+    RemoveTreeDir *dir = worker->task.dir;
+    int error_ = worker->error;
+    --inFlight;
+    switch (worker->task.kind) {
+    case RemoveTreeTask::LOOKUP:
+        if (error_)
+            break;
+        if (!worker->isDir) {
+            push(RemoveTreeTask::REMOVE, top, &worker->task.names);
+            break;
+        }
+        pushList(addDir(top, worker->task.names.front(), worker->fh),
+                 0, no_verf);
+        break;
+    case RemoveTreeTask::LIST:
+        if (dir->parent != top &&
+            (error_ == NFS3ERR_NOENT || error_ == NFS3ERR_STALE)) {
+            /* removed under us, its RMDIR will find it gone */
+            error_ = 0;
+            release(dir);
+            break;
+        }
+        if (error_)
+            break;
+        /* the rest of the directory goes under this batch */
+        if (worker->more)
+            pushList(dir, worker->task.cookie, worker->task.verf);
+        for (size_t i = 0 ; i < worker->subdirs.size() ; ++i) {
+            ++dir->pending;
+            pushList(addDir(dir, worker->subdirs[i].name,
+                            worker->subdirs[i].fh),
+                     0, no_verf);
+        }
+        /* files go first, then the subdirectories, depth first */
+        for (size_t i = 0 ; i < worker->files.size() ;
+             i += NFSC_REMOVE_TREE_GROUP) {
+            size_t end = std::min<size_t>(i + NFSC_REMOVE_TREE_GROUP,
+                                          worker->files.size());
+            std::vector<std::string> names(worker->files.begin() + i,
+                                           worker->files.begin() + end);
+            ++dir->pending;
+            push(RemoveTreeTask::REMOVE, dir, &names);
+        }
+        release(dir);
+        break;
+    case RemoveTreeTask::REMOVE:
+        files += worker->removed;
+        if (!error_)
+            release(dir);
+        break;
+    case RemoveTreeTask::RMDIR:
+        directories += worker->removed;
+        if (error_ == NFS3ERR_NOTEMPTY && !dir->relisted) {
+            /* entries the listing missed, while its cookies moved */
+            error_ = 0;
+            dir->relisted = true;
+            pushList(dir, 0, no_verf);
+            break;
+        }
+        if (!error_) {
+            RemoveTreeDir *parent = dir->parent;
+            dirs.erase(dir->self);
+            release(parent);
+        }
+        break;
+    }
+    if (error_ && !error)
+        error = error_;
+    schedule();
+}
+
+void NFS::RemoveTree::schedule()
+{
+    while (!error && inFlight < concurrency && !tasks.empty()) {
+        RemoveTreeWorker *worker =
+                WorkerPool<RemoveTreeWorker>::instance().acquire();
+        worker->setup(this, tasks.back());
+        tasks.pop_back();
+        ++inFlight;
+        Nan::AsyncQueueWorker(worker);
+    }
+    if (inFlight || (!error && !tasks.empty()))
+        return;
+    v8::Local<v8::Value> argv[] = {
+        error ? v8::Local<v8::Value>(Nan::New<v8::Integer>(error))
+              : v8::Local<v8::Value>(Nan::Null()),
+        Nan::New<v8::Number>(files),
+        Nan::New<v8::Number>(directories)
+    };
+    callback.Call(sizeof(argv)/sizeof(*argv), argv);
+    delete this;
+}
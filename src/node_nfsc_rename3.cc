@@ -43,27 +43,61 @@ NAN_METHOD(NFS::Client::Rename3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[4].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::Rename3Worker(obj, info[0], info[1],
-                                                 info[2], info[3], callback));
+    NFS::Rename3Worker *worker =
+            NFS::WorkerPool<NFS::Rename3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3], info[4])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::Rename3Worker::Rename3Worker(NFS::Client *client_,
-                                const v8::Local<v8::Value> &from_fh_,
-                                const v8::Local<v8::Value> &from_name_,
-                                const v8::Local<v8::Value> &to_fh_,
-                                const v8::Local<v8::Value> &to_name_,
-                                Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_RENAME3res, callback),
-      from_name(from_name_),
-      to_name(to_name_)
+NFS::Rename3Worker::Rename3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_RENAME3res)
+{}
+
+bool NFS::Rename3Worker::setup(NFS::Client *client_,
+                               const v8::Local<v8::Value> &from_fh_,
+                               const v8::Local<v8::Value> &from_name_,
+                               const v8::Local<v8::Value> &to_fh_,
+                               const v8::Local<v8::Value> &to_name_,
+                               const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
+    if (!from_name.assign(from_name_)) {
+        Nan::ThrowError("Out of memory");
+        return false;
+    }
+    if (!to_name.assign(to_name_)) {
+        Nan::ThrowError("Out of memory");
+        return false;
+    }
     args.from.dir.data.data_val = node::Buffer::Data(from_fh_);
     args.from.dir.data.data_len = node::Buffer::Length(from_fh_);
     args.to.dir.data.data_val = node::Buffer::Data(to_fh_);
     args.to.dir.data.data_len = node::Buffer::Length(to_fh_);
     args.from.name = *from_name;
     args.to.name = *to_name;
+    return true;
+}
+
+void NFS::Rename3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    NameCache &names = client->getConnection()->getNameCache();
+    if (res.status == NFS3_OK) {
+        cache.put(args.from.dir, res.RENAME3res_u.resok.fromdir_wcc);
+        cache.put(args.to.dir, res.RENAME3res_u.resok.todir_wcc);
+        names.renamed(args.from.dir, res.RENAME3res_u.resok.fromdir_wcc,
+                      args.from.name,
+                      args.to.dir, res.RENAME3res_u.resok.todir_wcc,
+                      args.to.name);
+    } else {
+        cache.put(args.from.dir, res.RENAME3res_u.resfail.fromdir_wcc);
+        cache.put(args.to.dir, res.RENAME3res_u.resfail.todir_wcc);
+        names.modified(args.from.dir, res.RENAME3res_u.resfail.fromdir_wcc);
+        names.modified(args.to.dir, res.RENAME3res_u.resfail.todir_wcc);
+    }
 }
 
 void NFS::Rename3Worker::procSuccess()
@@ -139,7 +173,7 @@ void NFS::Rename3Worker::procFailure()
     to_wcc->Set(Nan::New("after").ToLocalChecked(), to_after);
 
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         from_wcc,
         to_wcc,
     };
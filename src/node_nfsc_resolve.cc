@@ -0,0 +1,350 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <string.h>
+#include "node_nfsc.h"
+#include "node_nfsc_resolve.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_lookup3.h"
+#include "node_nfsc_fattr3.h"
+#include "node_nfsc_options.h"
+
+NFS::PathWalker::PathWalker()
+    : client(0),
+      channel(0),
+      error(0),
+      fh(),
+      attrs(),
+      hasAttrs(false)
+{}
+
+void NFS::PathWalker::reset(NFS::Client *client_)
+{
+    client = client_;
+    channel = 0;
+    error = 0;
+    fh.clear();
+    hasAttrs = false;
+}
+
+void NFS::PathWalker::setChannel(NFS::Channel *channel_)
+{
+    channel = channel_;
+}
+
+void NFS::PathWalker::split(const char *path,
+                            std::vector<std::string> *names)
+{
+    const char *end;
+    for (const char *p = path ; *p ; p = end) {
+        while (*p == '/')
+            ++p;
+        end = strchrnul(p, '/');
+        if (end == p || (end - p == 1 && *p == '.'))
+            continue;
+        names->push_back(std::string(p, end - p));
+    }
+}
+
+int NFS::PathWalker::getError() const
+{
+    return error;
+}
+
+const NFS::FileHandle &NFS::PathWalker::getFh() const
+{
+    return fh;
+}
+
+void NFS::PathWalker::setFh(const FileHandle &fh_)
+{
+    fh = fh_;
+    hasAttrs = false;
+}
+
+bool NFS::PathWalker::setRoot()
+{
+    Serialize my(client);
+    nfs_fh3 &root = client->getRootFh();
+    if (!root.data.data_val) {
+        error = NFSC_NOT_MOUNTED;
+        return false;
+    }
+    fh.assign(root.data.data_val, root.data.data_len);
+    hasAttrs = false;
+    return true;
+}
+
+const fattr3 *NFS::PathWalker::getAttrs()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    GETATTR3args args;
+    GETATTR3res res = GETATTR3res();
+    if (hasAttrs)
+        return &attrs;
+    fh.toNfs(&args.object);
+    if (cache.get(args.object, &attrs)) {
+        hasAttrs = true;
+        return &attrs;
+    }
+    clnt_stat stat;
+    if (channel) {
+        stat = channel->check(nfsproc3_getattr_3(&args, &res,
+                                                 channel->get()));
+    } else {
+        Serialize my(client);
+        stat = nfsproc3_getattr_3(&args, &res, client->getClient());
+    }
+    if (stat != RPC_SUCCESS) {
+        error = rpc_error_code(stat);
+        return NULL;
+    }
+    if (res.status != NFS3_OK) {
+        cache.invalidate(args.object);
+        error = nfs3_error_code(res.status);
+        return NULL;
+    }
+    attrs = res.GETATTR3res_u.resok.obj_attributes;
+    hasAttrs = true;
+    cache.put(args.object, attrs);
+    return &attrs;
+}
+
+bool NFS::PathWalker::lookup(const std::string &name)
+{
+    Connection *connection = client->getConnection();
+    LOOKUP3args args;
+    LOOKUP3res res = LOOKUP3res();
+    fh.toNfs(&args.what.dir);
+    args.what.name = const_cast<char *>(name.c_str());
+    if (!lookup3_from_cache(connection, args, &res)) {
+        clnt_stat stat;
+        if (channel) {
+            stat = channel->check(nfsproc3_lookup_3(&args, &res,
+                                                    channel->get()));
+        } else {
+            Serialize my(client);
+            stat = nfsproc3_lookup_3(&args, &res, client->getClient());
+        }
+        if (stat != RPC_SUCCESS) {
+            error = rpc_error_code(stat);
+            return false;
+        }
+        lookup3_update_caches(connection, args, res);
+    }
+    if (res.status != NFS3_OK) {
+        error = nfs3_error_code(res.status);
+        xdr_free((xdrproc_t) xdr_LOOKUP3res, (char *)&res);
+        return false;
+    }
+    LOOKUP3resok &resok = res.LOOKUP3res_u.resok;
+    hasAttrs = resok.obj_attributes.attributes_follow;
+    if (hasAttrs)
+        attrs = resok.obj_attributes.post_op_attr_u.attributes;
+    fh.assign(resok.object.data.data_val, resok.object.data.data_len);
+    xdr_free((xdrproc_t) xdr_LOOKUP3res, (char *)&res);
+    return true;
+}
+
+bool NFS::PathWalker::readlink(std::string *target)
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    READLINK3args args;
+    READLINK3res res = READLINK3res();
+    fh.toNfs(&args.symlink);
+    Serialize my(client);
+    clnt_stat stat = nfsproc3_readlink_3(&args, &res, client->getClient());
+    if (stat != RPC_SUCCESS) {
+        error = rpc_error_code(stat);
+        return false;
+    }
+    if (res.status != NFS3_OK) {
+        cache.put(args.symlink, res.READLINK3res_u.resfail.symlink_attributes);
+        error = nfs3_error_code(res.status);
+        xdr_free((xdrproc_t) xdr_READLINK3res, (char *)&res);
+        return false;
+    }
+    cache.put(args.symlink, res.READLINK3res_u.resok.symlink_attributes);
+    target->assign(res.READLINK3res_u.resok.data);
+    xdr_free((xdrproc_t) xdr_READLINK3res, (char *)&res);
+    return true;
+}
+
+// (start_fh, path, options, callback(err, fh, attrs, handles) )
+NAN_METHOD(NFS::Client::ResolvePath) {
+    bool typeError = true;
+    if ( info.Length() != 4) {
+        Nan::ThrowTypeError("Must be called with 4 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, start_fh must be a Buffer");
+    else if (!info[1]->IsString())
+        Nan::ThrowTypeError("Parameter 2, path must be a string");
+    else if (!info[2]->IsUndefined() && !info[2]->IsNull() &&
+             !info[2]->IsObject())
+        Nan::ThrowTypeError("Parameter 3, options must be an object");
+    else if (!info[3]->IsFunction())
+        Nan::ThrowTypeError("Parameter 4, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    NFS::ResolvePathWorker *worker =
+            NFS::WorkerPool<NFS::ResolvePathWorker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
+}
+
+NFS::ResolvePathWorker::ResolvePathWorker(NFS::WorkerPoolBase *pool_)
+    : PooledWorker(pool_, true),
+      client(0),
+      success(false),
+      error(0),
+      followSymlinks(false),
+      intermediates(false),
+      path(),
+      start(),
+      walker(),
+      components(),
+      handles()
+{}
+
+bool NFS::ResolvePathWorker::setup(NFS::Client *client_,
+                                   const v8::Local<v8::Value> &start_fh_,
+                                   const v8::Local<v8::Value> &path_,
+                                   const v8::Local<v8::Value> &options_,
+                                   const v8::Local<v8::Value> &callback_)
+{
+    client = client_;
+    callback->Reset(callback_.As<v8::Function>());
+    if (!path.assign(path_)) {
+        Nan::ThrowError("Out of memory");
+        return false;
+    }
+    /* the Buffer may be reused by JS while we walk, keep a copy */
+    start.assign(node::Buffer::Data(start_fh_),
+                 node::Buffer::Length(start_fh_));
+    followSymlinks = option_bool(options_, "followSymlinks", false);
+    intermediates = option_bool(options_, "intermediates", false);
+    return true;
+}
+
+/* queue the components of path_ in front of the ones left */
+void NFS::ResolvePathWorker::push(const char *path_)
+{
+    std::vector<std::string> names;
+    PathWalker::split(path_, &names);
+    components.insert(components.end(), names.rbegin(), names.rend());
+}
+
+bool NFS::ResolvePathWorker::resolve()
+{
+    int links = 0;
+    walker.reset(client);
+    walker.setFh(start);
+    push(*path);
+    while (!components.empty()) {
+        std::string name;
+        FileHandle dir(walker.getFh());
+        const fattr3 *attrs;
+        name.swap(components.back());
+        components.pop_back();
+        if (intermediates)
+            handles.push_back(dir);
+        if (!walker.lookup(name))
+            return false;
+        if (!followSymlinks)
+            continue;
+        if (!(attrs = walker.getAttrs()))
+            return false;
+        if (attrs->type != NF3LNK)
+            continue;
+        if (++links > NFSC_MAX_SYMLINKS) {
+            error = NFSC_ELOOP;
+            return false;
+        }
+        std::string target;
+        if (!walker.readlink(&target))
+            return false;
+        if (target[0] == '/') {
+            if (!walker.setRoot())
+                return false;
+        } else {
+            walker.setFh(dir);
+        }
+        push(target.c_str());
+    }
+    return walker.getAttrs() != NULL;
+}
+
+void NFS::ResolvePathWorker::Execute()
+{
+    if (!client->isMounted()) {
+        error = NFSC_NOT_MOUNTED;
+        return;
+    }
+    success = resolve();
+    if (!success && !error)
+        error = walker.getError();
+}
+
+void NFS::ResolvePathWorker::HandleOKCallback()
+{
+    Nan::HandleScope scope;
+    if (!success) {
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
+        };
+        callback->Call(1, argv);
+        return;
+    }
+    v8::Local<v8::Value> walked;
+    if (intermediates) {
+        v8::Local<v8::Array> array = Nan::New<v8::Array>(handles.size());
+        for (size_t i = 0 ; i < handles.size() ; ++i)
+            array->Set(i, Nan::CopyBuffer(handles[i].getData(),
+                                          handles[i].size())
+                               .ToLocalChecked());
+        walked = array;
+    } else {
+        walked = Nan::Undefined();
+    }
+    const FileHandle &fh = walker.getFh();
+    v8::Local<v8::Value> argv[] = {
+        Nan::Null(),
+        Nan::CopyBuffer(fh.getData(), fh.size()).ToLocalChecked(),
+        node_nfsc_fattr3(*walker.getAttrs()),
+        walked
+    };
+    callback->Call(sizeof(argv)/sizeof(*argv), argv);
+}
+
+void NFS::ResolvePathWorker::recycle()
+{
+    client = 0;
+    success = false;
+    error = 0;
+    walker.reset(0);
+    components.clear();
+    handles.clear();
+}
@@ -42,18 +42,26 @@ NAN_METHOD(NFS::Client::SetAttr3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[3].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::SetAttr3Worker(obj, info[0], info[1],
-                                                 info[2], callback));
+    NFS::SetAttr3Worker *worker =
+            NFS::WorkerPool<NFS::SetAttr3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::SetAttr3Worker::SetAttr3Worker(NFS::Client *client_,
-                                    const v8::Local<v8::Value> &obj_fh_,
-                                    const v8::Local<v8::Value> &attrs_,
-                                    const v8::Local<v8::Value> &guard_,
-                                    Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_SETATTR3res, callback)
+NFS::SetAttr3Worker::SetAttr3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_SETATTR3res)
+{}
+
+bool NFS::SetAttr3Worker::setup(NFS::Client *client_,
+                                const v8::Local<v8::Value> &obj_fh_,
+                                const v8::Local<v8::Value> &attrs_,
+                                const v8::Local<v8::Value> &guard_,
+                                const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
     args.object.data.data_val = node::Buffer::Data(obj_fh_);
     args.object.data.data_len = node::Buffer::Length(obj_fh_);
     if (!guard_->IsNull()) {
@@ -70,6 +78,21 @@ NFS::SetAttr3Worker::SetAttr3Worker(NFS::Client *client_,
         args.guard.sattrguard3_u.obj_ctime = {};
     }
     args.new_attributes = node_nfsc_sattr3(v8::Local<v8::Object>::Cast(attrs_));
+    return true;
+}
+
+void NFS::SetAttr3Worker::updateCaches()
+{
+    AttrCache &cache = client->getConnection()->getAttrCache();
+    /* truncation leaves short pages in the middle of the file */
+    if (args.new_attributes.size.set_it) {
+        client->getConnection()->getPageCache().invalidate(args.object);
+        client->getConnection()->getReadahead().invalidate(args.object);
+    }
+    if (res.status == NFS3_OK)
+        cache.put(args.object, res.SETATTR3res_u.resok.obj_wcc);
+    else
+        cache.put(args.object, res.SETATTR3res_u.resfail.obj_wcc);
 }
 
 void NFS::SetAttr3Worker::procSuccess()
@@ -114,7 +137,7 @@ void NFS::SetAttr3Worker::procFailure()
     wcc->Set(Nan::New("before").ToLocalChecked(), before);
     wcc->Set(Nan::New("after").ToLocalChecked(), after);
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         wcc
     };
     callback->Call(2, argv);
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "node_nfsc_slab.h"
+
+NFS::Slab &NFS::Slab::instance()
+{
+    static Slab my_slab;
+    return my_slab;
+}
+
+NFS::Slab::Slab()
+    : hugePages(getenv("NFSC_SLAB_HUGEPAGES") != NULL)
+{
+    for (int i = 0 ; i < NFSC_SLAB_CLASSES ; ++i) {
+        classes[i].regions = 0;
+        classes[i].inUse = 0;
+    }
+}
+
+int NFS::Slab::classOf(size_t size)
+{
+    int cls = 0;
+    while (cls < NFSC_SLAB_CLASSES &&
+           (size_t(1) << (cls + NFSC_SLAB_MIN_SHIFT)) < size)
+        ++cls;
+    return cls;
+}
+
+char *NFS::Slab::mapRegion()
+{
+    void *region = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (hugePages)
+        region = mmap(NULL, NFSC_SLAB_REGION_SIZE, PROT_READ|PROT_WRITE,
+                      MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+#endif
+    if (region == MAP_FAILED) {
+        region = mmap(NULL, NFSC_SLAB_REGION_SIZE, PROT_READ|PROT_WRITE,
+                      MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED)
+            return NULL;
+#ifdef MADV_HUGEPAGE
+        /* no reserved huge pages, let THP have a go */
+        if (hugePages)
+            madvise(region, NFSC_SLAB_REGION_SIZE, MADV_HUGEPAGE);
+#endif
+    }
+    return (char *)region;
+}
+
+char *NFS::Slab::alloc(size_t size, size_t *capacity)
+{
+    int cls = classOf(size);
+    if (cls == NFSC_SLAB_CLASSES) {
+        *capacity = size;
+        return (char *)malloc(size);
+    }
+    size_t chunkSize = size_t(1) << (cls + NFSC_SLAB_MIN_SHIFT);
+    SizeClass &sc = classes[cls];
+    *capacity = chunkSize;
+
+    std::lock_guard<std::mutex> my(sc.lock);
+    if (sc.free.empty()) {
+        char *region = mapRegion();
+        if (!region)
+            return NULL;
+        size_t count = NFSC_SLAB_REGION_SIZE / chunkSize;
+        sc.free.reserve(sc.free.size() + count);
+        for (size_t i = count ; i > 0 ; --i)
+            sc.free.push_back(region + (i - 1) * chunkSize);
+        ++sc.regions;
+    }
+    char *chunk = sc.free.back();
+    sc.free.pop_back();
+    ++sc.inUse;
+    return chunk;
+}
+
+void NFS::Slab::release(char *chunk, size_t capacity)
+{
+    int cls = classOf(capacity);
+    if (cls == NFSC_SLAB_CLASSES ||
+        capacity != (size_t(1) << (cls + NFSC_SLAB_MIN_SHIFT))) {
+        free(chunk);
+        return;
+    }
+    SizeClass &sc = classes[cls];
+    std::lock_guard<std::mutex> my(sc.lock);
+    sc.free.push_back(chunk);
+    --sc.inUse;
+}
+
+void NFS::Slab::freeCallback(char *chunk, void *hint)
+{
+    size_t capacity = (size_t)hint;
+    instance().release(chunk, capacity);
+    Nan::AdjustExternalMemory(-(int)capacity);
+}
+
+v8::Local<v8::Object> NFS::Slab::newBuffer(char *chunk,
+                                           size_t len,
+                                           size_t capacity)
+{
+    Nan::AdjustExternalMemory((int)capacity);
+    return Nan::NewBuffer(chunk, len, freeCallback, (void *)capacity)
+            .ToLocalChecked();
+}
+
+// ( ) -> { hugePages, classes: { size: { regions, inUse, free }, ... } }
+NAN_METHOD(NFS::SlabStats) {
+    Slab &slab = Slab::instance();
+    v8::Local<v8::Object> stats = Nan::New<v8::Object>();
+    v8::Local<v8::Object> classes = Nan::New<v8::Object>();
+    for (int i = 0 ; i < NFSC_SLAB_CLASSES ; ++i) {
+        Slab::SizeClass &sc = slab.classes[i];
+        std::lock_guard<std::mutex> my(sc.lock);
+        v8::Local<v8::Object> item = Nan::New<v8::Object>();
+        item->Set(Nan::New("regions").ToLocalChecked(),
+                  Nan::New(sc.regions));
+        item->Set(Nan::New("inUse").ToLocalChecked(),
+                  Nan::New(sc.inUse));
+        item->Set(Nan::New("free").ToLocalChecked(),
+                  Nan::New(double(sc.free.size())));
+        classes->Set(Nan::New(double(1 << (i + NFSC_SLAB_MIN_SHIFT))), item);
+    }
+    stats->Set(Nan::New("hugePages").ToLocalChecked(),
+               Nan::New(slab.hugePages));
+    stats->Set(Nan::New("classes").ToLocalChecked(), classes);
+    info.GetReturnValue().Set(stats);
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+#include "node_nfsc.h"
+#include "node_nfsc_statpaths.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_resolve.h"
+#include "node_nfsc_walk.h"
+
+// (start_fh, paths, callback(err, { handles, records }) )
+NAN_METHOD(NFS::Client::StatPaths) {
+    bool typeError = true;
+    if ( info.Length() != 3) {
+        Nan::ThrowTypeError("Must be called with 3 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, start_fh must be a Buffer");
+    else if (!info[1]->IsArray())
+        Nan::ThrowTypeError("Parameter 2, paths must be an array");
+    else if (v8::Local<v8::Array>::Cast(info[1])->Length() >
+             NFSC_STAT_PATHS_MAX)
+        Nan::ThrowRangeError("Parameter 2, too many paths");
+    else if (!info[2]->IsFunction())
+        Nan::ThrowTypeError("Parameter 3, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    NFS::StatPaths *job = new NFS::StatPaths(obj, info[0], info[2]);
+    if (!job->setup(v8::Local<v8::Array>::Cast(info[1]))) {
+        delete job;
+        return;
+    }
+    job->start();
+}
+
+NFS::StatPathsWorker::StatPathsWorker(NFS::WorkerPoolBase *pool_)
+    : PooledWorker(pool_, false),
+      job(NULL),
+      task(),
+      error(0)
+{}
+
+void NFS::StatPathsWorker::setup(NFS::StatPaths *job_,
+                                 NFS::StatPathsTask *task_)
+{
+    job = job_;
+    task.dir.swap(task_->dir);
+    task.names.swap(task_->names);
+    task.indexes.swap(task_->indexes);
+    error = 0;
+}
+
+void NFS::StatPathsWorker::Execute()
+{
+    Client *client = job->client;
+    PathWalker walker;
+    FileHandle dir;
+
+    if (!client->isMounted()) {
+        error = NFSC_NOT_MOUNTED;
+        return;
+    }
+    Channel channel(client);
+    walker.reset(client);
+    walker.setChannel(&channel);
+    walker.setFh(job->start_fh);
+    for (size_t i = 0 ; i < task.dir.size() ; ++i) {
+        if (walker.lookup(task.dir[i]))
+            continue;
+        /* the paths below a parent that failed fail alike */
+        for (size_t j = 0 ; j < task.indexes.size() ; ++j)
+            job->results[task.indexes[j]].error = walker.getError();
+        return;
+    }
+    dir = walker.getFh();
+    for (size_t i = 0 ; i < task.names.size() ; ++i) {
+        StatPaths::Result &result = job->results[task.indexes[i]];
+        const fattr3 *attrs;
+        walker.setFh(dir);
+        if (!task.names[i].empty() && !walker.lookup(task.names[i])) {
+            result.error = walker.getError();
+            continue;
+        }
+        if (!(attrs = walker.getAttrs())) {
+            result.error = walker.getError();
+            continue;
+        }
+        result.error = 0;
+        result.fh = walker.getFh();
+        result.attrs = *attrs;
+    }
+}
+
+void NFS::StatPathsWorker::WorkComplete()
+{
+    Nan::HandleScope scope;
+    job->complete(this);
+}
+
+void NFS::StatPathsWorker::recycle()
+{
+    job = NULL;
+    task.dir.clear();
+    task.names.clear();
+    task.indexes.clear();
+}
+
+NFS::StatPaths::StatPaths(NFS::Client *client_,
+                          const v8::Local<v8::Value> &start_fh_,
+                          const v8::Local<v8::Value> &callback_)
+    : client(client_),
+      callback(callback_.As<v8::Function>()),
+      persistent(),
+      start_fh(node::Buffer::Data(start_fh_),
+               node::Buffer::Length(start_fh_)),
+      pending(),
+      results(),
+      inFlight(0),
+      error(0)
+{
+    persistent.Reset(Nan::New<v8::Object>());
+    /* nobody else may hold the client while we run */
+    Nan::New(persistent)->Set(Nan::New("client").ToLocalChecked(),
+                              client->handle());
+}
+
+NFS::StatPaths::~StatPaths()
+{
+    persistent.Reset();
+}
+
+bool NFS::StatPaths::setup(const v8::Local<v8::Array> &paths)
+{
+    /* 'a/b' -> index in pending of the last task of parent a/b */
+    std::unordered_map<std::string, size_t> parents;
+    std::vector<std::string> names;
+    std::string key;
+
+    results.resize(paths->Length());
+    for (uint32_t i = 0 ; i < paths->Length() ; ++i) {
+        v8::Local<v8::Value> path = paths->Get(i);
+        if (!path->IsString()) {
+            Nan::ThrowTypeError("Parameter 2, paths must be strings");
+            return false;
+        }
+        Nan::Utf8String utf8(path);
+        names.clear();
+        PathWalker::split(*utf8, &names);
+        key.clear();
+        for (size_t j = 0 ; j + 1 < names.size() ; ++j)
+            key.append(names[j]).push_back('/');
+        std::pair<std::unordered_map<std::string, size_t>::iterator, bool>
+                slot = parents.insert(std::make_pair(key, pending.size()));
+        if (!slot.second &&
+            pending[slot.first->second].names.size() >=
+            NFSC_STAT_PATHS_TASK_SIZE)
+            slot.first->second = pending.size();
+        if (slot.first->second == pending.size()) {
+            pending.push_back(StatPathsTask());
+            if (!names.empty())
+                pending.back().dir.assign(names.begin(), names.end() - 1);
+        }
+        StatPathsTask &task = pending[slot.first->second];
+        task.names.push_back(names.empty() ? std::string() : names.back());
+        task.indexes.push_back(i);
+    }
+    return true;
+}
+
+void NFS::StatPaths::start()
+{
+    schedule();
+}
+
+void NFS::StatPaths::complete(NFS::StatPathsWorker *worker)
+{
+    --inFlight;
+    if (worker->error && !error)
+        error = worker->error;
+    schedule();
+}
+
+void NFS::StatPaths::schedule()
+{
+    while (!error && inFlight < NFSC_STAT_PATHS_CONCURRENCY &&
+           !pending.empty()) {
+        StatPathsWorker *worker =
+                WorkerPool<StatPathsWorker>::instance().acquire();
+        worker->setup(this, &pending.back());
+        pending.pop_back();
+        ++inFlight;
+        Nan::AsyncQueueWorker(worker);
+    }
+    if (inFlight || (!error && !pending.empty()))
+        return;
+    if (error) {
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::Integer>(error)
+        };
+        callback.Call(1, argv);
+    } else {
+        v8::Local<v8::Value> argv[] = {
+            Nan::Null(),
+            pack()
+        };
+        callback.Call(sizeof(argv)/sizeof(*argv), argv);
+    }
+    delete this;
+}
+
+v8::Local<v8::Object> NFS::StatPaths::pack()
+{
+    size_t count = results.size();
+    size_t handlesLen = 0;
+    for (size_t i = 0 ; i < count ; ++i)
+        handlesLen += results[i].fh.size();
+    v8::Local<v8::Object> handles =
+            Nan::NewBuffer(handlesLen).ToLocalChecked();
+    char *handlesData = node::Buffer::Data(handles);
+    /* malloc()ed, so that JS can map a Float64Array on it */
+    size_t recordsLen = count * NFSC_WALK_RECORD_SIZE * sizeof(double);
+    double *records = static_cast<double *>(malloc(recordsLen ? recordsLen
+                                                              : 1));
+    size_t offset = 0;
+    for (size_t i = 0 ; i < count ; ++i) {
+        const Result &result = results[i];
+        double *record = records + i * NFSC_WALK_RECORD_SIZE;
+        memcpy(handlesData + offset, result.fh.getData(), result.fh.size());
+        record[0] = offset;
+        record[1] = result.fh.size();
+        record[2] = result.error;
+        offset += result.fh.size();
+        walk_record_attrs(record, result.error ? NULL : &result.attrs);
+    }
+    v8::Local<v8::Object> packed = Nan::New<v8::Object>();
+    packed->Set(Nan::New("handles").ToLocalChecked(), handles);
+    packed->Set(Nan::New("records").ToLocalChecked(),
+                Nan::NewBuffer(reinterpret_cast<char *>(records), recordsLen)
+                .ToLocalChecked());
+    return packed;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include "node_nfsc.h"
+#include "node_nfsc_stream.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_checksum.h"
+#include "node_nfsc_options.h"
+#include "node_nfsc_slab.h"
+
+// (object, options, onData(data) -> boolean, callback(err, digests) ) -> transfer
+NAN_METHOD(NFS::Client::ReadStream) {
+    bool typeError = true;
+    if (info.Length() != 4) {
+        Nan::ThrowTypeError("Must be called with 4 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, object must be a Buffer");
+    else if (!info[1]->IsUndefined() && !info[1]->IsNull() &&
+             !info[1]->IsObject())
+        Nan::ThrowTypeError("Parameter 2, options must be an object");
+    else if (!info[2]->IsFunction())
+        Nan::ThrowTypeError("Parameter 3, onData must be a function");
+    else if (!info[3]->IsFunction())
+        Nan::ThrowTypeError("Parameter 4, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    uint64_t offset = CheckUDouble(option_number(info[1], "offset", 0));
+    double length_ = option_number(info[1], "length", -1);
+    uint64_t length = length_ < 0 ? NFSC_PIPELINE_TO_EOF
+                                  : CheckUDouble(length_);
+    if (offset == (uint64_t)-1 || (length_ >= 0 && length == (uint64_t)-1)) {
+        Nan::ThrowRangeError("Invalid offset or length");
+        return;
+    }
+    unsigned algorithms = 0;
+    if (info[1]->IsObject()) {
+        v8::Local<v8::Value> names = info[1].As<v8::Object>()
+                ->Get(Nan::New("checksum").ToLocalChecked());
+        if (!names->IsUndefined()) {
+            algorithms = checksum_algorithms(names);
+            if (!algorithms) {
+                Nan::ThrowRangeError("Unknown checksum algorithm");
+                return;
+            }
+        }
+    }
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    uint32_t chunkSize = option_uint(info[1], "chunkSize",
+                                     obj->getConnection()->getRtmax());
+    unsigned depth = option_uint(info[1], "depth", NFSC_PIPELINE_DEPTH);
+    NFS::ReadStreamJob *job = new NFS::ReadStreamJob(obj, info[0], offset,
+                                                     length, chunkSize, depth,
+                                                     algorithms, info[2],
+                                                     info[3]);
+    v8::Local<v8::Object> transfer = job->getTransfer();
+    job->start();
+    info.GetReturnValue().Set(transfer);
+}
+
+NFS::ReadStreamJob::ReadStreamJob(NFS::Client *client_,
+                                  const v8::Local<v8::Value> &obj_fh_,
+                                  uint64_t offset, uint64_t length,
+                                  uint32_t chunkSize_, unsigned depth_,
+                                  unsigned algorithms,
+                                  const v8::Local<v8::Value> &onData_,
+                                  const v8::Local<v8::Value> &callback_)
+    : Pipeline(client_, offset, length, chunkSize_, depth_, callback_),
+      fh(node::Buffer::Data(obj_fh_), node::Buffer::Length(obj_fh_)),
+      onData(onData_.As<v8::Function>()),
+      transfer(NULL),
+      digest(algorithms ? new Digest(algorithms, offset) : NULL)
+{
+    v8::Local<v8::Object> handle = Transfer::create(this);
+    transfer = Nan::ObjectWrap::Unwrap<Transfer>(handle);
+    keep("transfer", handle);
+}
+
+NFS::ReadStreamJob::~ReadStreamJob()
+{
+    delete digest;
+}
+
+v8::Local<v8::Object> NFS::ReadStreamJob::getTransfer()
+{
+    return transfer->handle();
+}
+
+void NFS::ReadStreamJob::execute(NFS::PipelineChunk *chunk)
+{
+    Channel channel(client);
+    pipeline_read(client, channel, fh, chunk);
+    if (digest)
+        checksum_add(digest, chunk);
+}
+
+void NFS::ReadStreamJob::deliver(NFS::PipelineChunk *chunk)
+{
+    v8::Local<v8::Value> argv[] = {
+        Slab::instance().newBuffer(chunk->data, chunk->len, chunk->capacity)
+    };
+    /* the Buffer owns the slab chunk now */
+    chunk->data = NULL;
+    chunk->capacity = 0;
+    v8::Local<v8::Value> more = onData.Call(1, argv);
+    if (!more.IsEmpty() && more->IsFalse())
+        pause();
+}
+
+void NFS::ReadStreamJob::done(int error_)
+{
+    transfer->detach();
+    if (error_) {
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::Integer>(error_)
+        };
+        callback.Call(1, argv);
+        return;
+    }
+    v8::Local<v8::Value> argv[] = {
+        Nan::Null(),
+        digest ? v8::Local<v8::Value>(checksum_result(digest))
+               : v8::Local<v8::Value>(Nan::Undefined())
+    };
+    callback.Call(sizeof(argv)/sizeof(*argv), argv);
+}
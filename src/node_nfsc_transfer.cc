@@ -0,0 +1,100 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include "node_nfsc.h"
+#include "node_nfsc_transfer.h"
+
+static __thread Nan::Persistent<v8::Function> *my_constructor = NULL;
+
+static void
+constructor_cleanup(void *)
+{
+    my_constructor->Reset();
+    delete my_constructor;
+    my_constructor = NULL;
+}
+
+Nan::Persistent<v8::Function> &NFS::Transfer::constructor()
+{
+    if (!my_constructor) {
+        my_constructor = new Nan::Persistent<v8::Function>();
+        NFSC_ADD_CLEANUP_HOOK(constructor_cleanup, NULL);
+    }
+    return *my_constructor;
+}
+
+void NFS::Transfer::Init()
+{
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(Nan::New("Transfer").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+    SetPrototypeMethod(tpl, "pause", Pause);
+    SetPrototypeMethod(tpl, "resume", Resume);
+    SetPrototypeMethod(tpl, "abort", Abort);
+
+    constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+}
+
+NFS::Transfer::Transfer(NFS::Transferable *job_)
+    : job(job_)
+{}
+
+v8::Local<v8::Object> NFS::Transfer::create(NFS::Transferable *job_)
+{
+    v8::Local<v8::Object> handle = Nan::NewInstance(
+            Nan::New(constructor())).ToLocalChecked();
+    ObjectWrap::Unwrap<Transfer>(handle)->job = job_;
+    return handle;
+}
+
+void NFS::Transfer::detach()
+{
+    job = NULL;
+}
+
+NAN_METHOD(NFS::Transfer::New) {
+    if (!info.IsConstructCall()) {
+        Nan::ThrowTypeError("Transfer must be called with new");
+        return;
+    }
+    Transfer *obj = new Transfer(NULL);
+    obj->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+}
+
+// ( )
+NAN_METHOD(NFS::Transfer::Pause) {
+    Transfer *obj = ObjectWrap::Unwrap<Transfer>(info.Holder());
+    if (obj->job)
+        obj->job->pause();
+}
+
+// ( )
+NAN_METHOD(NFS::Transfer::Resume) {
+    Transfer *obj = ObjectWrap::Unwrap<Transfer>(info.Holder());
+    if (obj->job)
+        obj->job->resume();
+}
+
+// ( ), the callback of the transfer gets an error
+NAN_METHOD(NFS::Transfer::Abort) {
+    Transfer *obj = ObjectWrap::Unwrap<Transfer>(info.Holder());
+    if (obj->job)
+        obj->job->abort(NFSC_ECANCELED);
+}
@@ -20,6 +20,7 @@
 #include "node_nfsc_unmount3.h"
 #include "node_nfsc_errors3.h"
 #include "node_nfsc_fattr3.h"
+#include "node_nfsc_writebehind.h"
 
 // ( callback(err) )
 NAN_METHOD(NFS::Client::Unmount3) {
@@ -48,24 +49,40 @@ NFS::Unmount3Worker::Unmount3Worker(NFS::Client *client_,
 {}
 
 NFS::Unmount3Worker::~Unmount3Worker()
-{
-    free(error);
-}
+{}
 
 void NFS::Unmount3Worker::Execute()
 {
     if (!client->isMounted()) {
-        NFSC_ASPRINTF(&error, NFSC_NOT_MOUNTED);
+        error = NFSC_NOT_MOUNTED;
         return;
     }
-    Serialize my(client);
     clnt_stat stat;
     const char *dir = client->getExportPath();
-    stat = mountproc3_umnt_3(const_cast<char**>(&dir), NULL,
-                             client->getMountClient());
-    if (stat != RPC_SUCCESS) {
-        NFSC_ASPRINTF(&error, "%s", rpc_error(stat));
-        return;
+    /* a shared connection is only unmounted by its last client */
+    if (client->getConnection()->removeMount() == 0) {
+        /* lost writes are reported, the next unmount goes through */
+        error = write_behind_drain(client);
+        if (error) {
+            client->getConnection()->addMount();
+            return;
+        }
+        {
+            Serialize my(client);
+            stat = mountproc3_umnt_3(const_cast<char**>(&dir), NULL,
+                                     client->getMountClient());
+        }
+        if (stat != RPC_SUCCESS) {
+            client->getConnection()->addMount();
+            error = rpc_error_code(stat);
+            return;
+        }
+        /*
+         * best effort, the export is unmounted anyway; the file is synced
+         * to disk without the client lock held
+         */
+        client->getConnection()->getCacheFile().save(client->getConnection());
+        client->getConnection()->getChannels().clear();
     }
     success = true;
     client->setMounted(false);
@@ -82,7 +99,7 @@ void NFS::Unmount3Worker::HandleOKCallback()
     }
     else {
         v8::Local<v8::Value> argv[] = {
-            Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked()
+            Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR)
         };
         callback->Call(1, argv);
     }
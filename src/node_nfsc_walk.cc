@@ -0,0 +1,399 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "node_nfsc.h"
+#include "node_nfsc_walk.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_errors3.h"
+#include "node_nfsc_options.h"
+
+// (dir, options, onBatch(batch) -> boolean, callback(err, count) ) -> transfer
+NAN_METHOD(NFS::Client::WalkTree) {
+    bool typeError = true;
+    if (info.Length() != 4) {
+        Nan::ThrowTypeError("Must be called with 4 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, dir must be a Buffer");
+    else if (!info[1]->IsUndefined() && !info[1]->IsNull() &&
+             !info[1]->IsObject())
+        Nan::ThrowTypeError("Parameter 2, options must be an object");
+    else if (!info[2]->IsFunction())
+        Nan::ThrowTypeError("Parameter 3, onBatch must be a function");
+    else if (!info[3]->IsFunction())
+        Nan::ThrowTypeError("Parameter 4, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    unsigned concurrency = option_uint(info[1], "concurrency",
+                                       NFSC_WALK_CONCURRENCY);
+    unsigned maxDepth = option_uint(info[1], "maxDepth", UINT32_MAX);
+    uint32_t batchSize = option_uint(info[1], "batchSize",
+                                     NFSC_WALK_BATCH_SIZE);
+    NFS::WalkFilter *filter = NULL;
+    if (info[1]->IsObject()) {
+        v8::Local<v8::Value> spec = v8::Local<v8::Object>::Cast(info[1])
+                ->Get(Nan::New("filter").ToLocalChecked());
+        std::string error;
+        if (!spec->IsUndefined() && !spec->IsNull()) {
+            filter = new NFS::WalkFilter();
+            if (!filter->parse(spec, &error)) {
+                delete filter;
+                Nan::ThrowTypeError(error.c_str());
+                return;
+            }
+        }
+    }
+    NFS::Walk *walk = new NFS::Walk(obj, info[0], concurrency, maxDepth,
+                                    batchSize, filter, info[2], info[3]);
+    v8::Local<v8::Object> transfer = walk->getTransfer();
+    walk->start();
+    info.GetReturnValue().Set(transfer);
+}
+
+NFS::WalkWorker::WalkWorker(NFS::WorkerPoolBase *pool_)
+    : PooledWorker(pool_, false),
+      walk(NULL),
+      dir(),
+      more(false),
+      error(0),
+      entries(),
+      subdirs()
+{}
+
+void NFS::WalkWorker::setup(NFS::Walk *walk_, const NFS::WalkDir &dir_)
+{
+    walk = walk_;
+    dir = dir_;
+    more = false;
+    error = 0;
+}
+
+static std::string
+walk_path(const std::string &dir, const char *name)
+{
+    if (dir.empty())
+        return name;
+    std::string path;
+    path.reserve(dir.size() + 1 + strlen(name));
+    path.append(dir).append(1, '/').append(name);
+    return path;
+}
+
+void NFS::WalkWorker::Execute()
+{
+    Client *client = walk->client;
+    const WalkFilter *filter = walk->filter;
+    READDIRPLUS3args args;
+    uint32_t examined = 0;
+    bool eof = false;
+
+    if (!client->isMounted()) {
+        error = NFSC_NOT_MOUNTED;
+        return;
+    }
+    Channel channel(client);
+    dir.fh.toNfs(&args.dir);
+    args.cookie = dir.cookie;
+    memcpy(args.cookieverf, dir.verf, NFS3_COOKIEVERFSIZE);
+    args.dircount = NFSC_WALK_DIRCOUNT;
+    args.maxcount = NFSC_WALK_MAXCOUNT;
+    /* a filter matching little must not list a whole huge directory */
+    while (!eof && examined < walk->batchSize) {
+        READDIRPLUS3res res = READDIRPLUS3res();
+        clnt_stat stat = channel.check(
+                nfsproc3_readdirplus_3(&args, &res, channel.get()));
+        if (stat != RPC_SUCCESS) {
+            error = rpc_error_code(stat);
+            return;
+        }
+        if (res.status != NFS3_OK) {
+            error = nfs3_error_code(res.status);
+            xdr_free((xdrproc_t) xdr_READDIRPLUS3res, (char *)&res);
+            return;
+        }
+        READDIRPLUS3resok &resok = res.READDIRPLUS3res_u.resok;
+        for (entryplus3 *entry = resok.reply.entries ;
+             entry ;
+             entry = entry->nextentry) {
+            args.cookie = entry->cookie;
+            if (!entry->name || !strcmp(entry->name, ".") ||
+                !strcmp(entry->name, ".."))
+                continue;
+            ++examined;
+            WalkEntry item;
+            item.path = walk_path(dir.path, entry->name);
+            item.depth = dir.depth + 1;
+            if (entry->name_handle.handle_follows)
+                item.fh = FileHandle(entry->name_handle.post_op_fh3_u.handle);
+            item.hasAttrs = entry->name_attributes.attributes_follow;
+            if (item.hasAttrs)
+                item.attrs = entry->name_attributes.post_op_attr_u.attributes;
+            /* without a handle, or attributes, we cannot go down */
+            if (item.hasAttrs && item.attrs.type == NF3DIR &&
+                !item.fh.empty() && item.depth < walk->maxDepth &&
+                !(filter && filter->prunes(entry->name))) {
+                WalkDir subdir = WalkDir();
+                subdir.fh = item.fh;
+                subdir.path = item.path;
+                subdir.depth = item.depth;
+                subdirs.push_back(subdir);
+            }
+            if (!filter ||
+                filter->matches(entry->name, item.path,
+                                item.hasAttrs ? &item.attrs : NULL))
+                entries.push_back(item);
+        }
+        memcpy(args.cookieverf, resok.cookieverf, NFS3_COOKIEVERFSIZE);
+        eof = resok.reply.eof;
+        xdr_free((xdrproc_t) xdr_READDIRPLUS3res, (char *)&res);
+    }
+    more = !eof;
+    dir.cookie = args.cookie;
+    memcpy(dir.verf, args.cookieverf, NFS3_COOKIEVERFSIZE);
+}
+
+void NFS::WalkWorker::WorkComplete()
+{
+    Nan::HandleScope scope;
+    walk->complete(this);
+}
+
+void NFS::WalkWorker::recycle()
+{
+    walk = NULL;
+    dir = WalkDir();
+    entries.clear();
+    subdirs.clear();
+}
+
+NFS::Walk::Walk(NFS::Client *client_, const v8::Local<v8::Value> &root_fh_,
+                unsigned concurrency_, unsigned maxDepth_,
+                uint32_t batchSize_, NFS::WalkFilter *filter_,
+                const v8::Local<v8::Value> &onBatch_,
+                const v8::Local<v8::Value> &callback_)
+    : client(client_),
+      onBatch(onBatch_.As<v8::Function>()),
+      callback(callback_.As<v8::Function>()),
+      persistent(),
+      transfer(NULL),
+      concurrency(std::min<unsigned>(std::max<unsigned>(concurrency_, 1),
+                                     NFSC_WALK_MAX_CONCURRENCY)),
+      maxDepth(maxDepth_),
+      batchSize(std::max<uint32_t>(batchSize_, 1)),
+      filter(filter_),
+      pending(),
+      ready(),
+      inFlight(0),
+      paused(false),
+      scheduling(false),
+      ending(false),
+      error(0),
+      listed(0)
+{
+    WalkDir root = WalkDir();
+    root.fh.assign(node::Buffer::Data(root_fh_),
+                   node::Buffer::Length(root_fh_));
+    if (maxDepth)
+        pending.push_back(root);
+    v8::Local<v8::Object> handle = Transfer::create(this);
+    transfer = Nan::ObjectWrap::Unwrap<Transfer>(handle);
+    persistent.Reset(Nan::New<v8::Object>());
+    v8::Local<v8::Object> keep = Nan::New(persistent);
+    /* nobody else may hold the client while we run */
+    keep->Set(Nan::New("client").ToLocalChecked(), client->handle());
+    keep->Set(Nan::New("transfer").ToLocalChecked(), handle);
+}
+
+NFS::Walk::~Walk()
+{
+    delete filter;
+    persistent.Reset();
+}
+
+v8::Local<v8::Object> NFS::Walk::getTransfer()
+{
+    return transfer->handle();
+}
+
+void NFS::Walk::start()
+{
+    schedule();
+}
+
+void NFS::Walk::pause()
+{
+    paused = true;
+}
+
+void NFS::Walk::resume()
+{
+    paused = false;
+    schedule();
+}
+
+void NFS::Walk::abort(int error_)
+{
+    if (!error)
+        error = error_ ? error_ : NFSC_UNKNOWN_ERROR;
+    schedule();
+}
+
+void NFS::Walk::complete(NFS::WalkWorker *worker)
+{
+    --inFlight;
+    switch (worker->error) {
+    case 0:
+        break;
+    case NFS3ERR_NOENT:
+    case NFS3ERR_STALE:
+        /* removed since it was listed, unless it is the root */
+        if (!worker->dir.path.empty())
+            break;
+        /* fall through */
+    default:
+        if (!error)
+            error = worker->error;
+        break;
+    }
+    if (!error) {
+        /* the rest of the directory goes under its subdirectories */
+        if (worker->more)
+            pending.push_back(worker->dir);
+        for (std::vector<WalkDir>::reverse_iterator it =
+                     worker->subdirs.rbegin() ;
+             it != worker->subdirs.rend() ;
+             ++it)
+            pending.push_back(*it);
+        if (!worker->entries.empty()) {
+            ready.push_back(std::vector<WalkEntry>());
+            ready.back().swap(worker->entries);
+        }
+    }
+    schedule();
+}
+
+/*
+ * Deliver what is ready, then list what the concurrency allows. onBatch
+ * may pause, resume or abort us: a nested call only updates the state
+ * the outer loops check.
+ */
+void NFS::Walk::schedule()
+{
+    if (scheduling || ending)
+        return;
+    scheduling = true;
+    while (!error && !paused && !ready.empty()) {
+        std::vector<WalkEntry> entries;
+        entries.swap(ready.front());
+        ready.pop_front();
+        listed += entries.size();
+        v8::Local<v8::Value> argv[] = {
+            walk_batch(entries)
+        };
+        v8::Local<v8::Value> more = onBatch.Call(1, argv);
+        if (!more.IsEmpty() && more->IsFalse())
+            paused = true;
+    }
+    while (!error && !paused && inFlight < concurrency && !pending.empty()) {
+        WalkWorker *worker = WorkerPool<WalkWorker>::instance().acquire();
+        worker->setup(this, pending.back());
+        pending.pop_back();
+        ++inFlight;
+        Nan::AsyncQueueWorker(worker);
+    }
+    scheduling = false;
+    if (inFlight || (!error && (paused || !pending.empty() || !ready.empty())))
+        return;
+    ending = true;
+    transfer->detach();
+    if (error) {
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::Integer>(error)
+        };
+        callback.Call(1, argv);
+    } else {
+        v8::Local<v8::Value> argv[] = {
+            Nan::Null(),
+            Nan::New<v8::Number>(listed)
+        };
+        callback.Call(sizeof(argv)/sizeof(*argv), argv);
+    }
+    delete this;
+}
+
+void NFS::walk_record_attrs(double *record, const fattr3 *attrs)
+{
+    if (!attrs) {
+        std::fill(record + 3, record + NFSC_WALK_RECORD_SIZE, 0);
+        return;
+    }
+    record[3] = attrs->type;
+    record[4] = attrs->mode;
+    record[5] = attrs->nlink;
+    record[6] = attrs->uid;
+    record[7] = attrs->gid;
+    record[8] = double(attrs->size);
+    record[9] = double(attrs->used);
+    record[10] = double(attrs->fileid);
+    record[11] = attrs->atime.seconds + attrs->atime.nseconds / 1e9;
+    record[12] = attrs->mtime.seconds + attrs->mtime.nseconds / 1e9;
+    record[13] = attrs->ctime.seconds + attrs->ctime.nseconds / 1e9;
+}
+
+v8::Local<v8::Object> NFS::walk_batch(const std::vector<NFS::WalkEntry> &entries)
+{
+    size_t count = entries.size();
+    size_t handlesLen = 0;
+    for (size_t i = 0 ; i < count ; ++i)
+        handlesLen += entries[i].fh.size();
+    v8::Local<v8::Array> paths = Nan::New<v8::Array>(count);
+    v8::Local<v8::Object> handles =
+            Nan::NewBuffer(handlesLen).ToLocalChecked();
+    char *handlesData = node::Buffer::Data(handles);
+    /* malloc()ed, so that JS can map a Float64Array on it */
+    size_t recordsLen = count * NFSC_WALK_RECORD_SIZE * sizeof(double);
+    double *records = static_cast<double *>(malloc(recordsLen ? recordsLen
+                                                              : 1));
+    size_t offset = 0;
+    for (size_t i = 0 ; i < count ; ++i) {
+        const WalkEntry &entry = entries[i];
+        double *record = records + i * NFSC_WALK_RECORD_SIZE;
+        paths->Set(i, Nan::New(entry.path.data(), entry.path.size())
+                   .ToLocalChecked());
+        memcpy(handlesData + offset, entry.fh.getData(), entry.fh.size());
+        record[0] = offset;
+        record[1] = entry.fh.size();
+        record[2] = entry.depth;
+        offset += entry.fh.size();
+        walk_record_attrs(record, entry.hasAttrs ? &entry.attrs : NULL);
+    }
+    v8::Local<v8::Object> batch = Nan::New<v8::Object>();
+    batch->Set(Nan::New("paths").ToLocalChecked(), paths);
+    batch->Set(Nan::New("handles").ToLocalChecked(), handles);
+    batch->Set(Nan::New("records").ToLocalChecked(),
+               Nan::NewBuffer(reinterpret_cast<char *>(records), recordsLen)
+               .ToLocalChecked());
+    return batch;
+}
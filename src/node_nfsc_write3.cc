@@ -16,6 +16,7 @@
  * @authors:
  *    Guillaume Gimenez <ggim@scality.com>
  */
+#include <algorithm>
 #include "node_nfsc.h"
 #include "node_nfsc_write3.h"
 #include "node_nfsc_fattr3.h"
@@ -46,20 +47,29 @@ NAN_METHOD(NFS::Client::Write3) {
     if (typeError)
         return;
     NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
-    Nan::Callback *callback = new Nan::Callback(info[5].As<v8::Function>());
-    Nan::AsyncQueueWorker(new NFS::Write3Worker(obj, info[0], info[1], info[2],
-                                               info[3], info[4], callback));
+    NFS::Write3Worker *worker =
+            NFS::WorkerPool<NFS::Write3Worker>::instance().acquire();
+    if (!worker->setup(obj, info[0], info[1], info[2], info[3], info[4],
+                       info[5])) {
+        worker->abandon();
+        return;
+    }
+    Nan::AsyncQueueWorker(worker);
 }
 
-NFS::Write3Worker::Write3Worker(NFS::Client *client_,
+NFS::Write3Worker::Write3Worker(NFS::WorkerPoolBase *pool_)
+    : Procedure3Worker(pool_, (xdrproc_t) xdr_WRITE3res)
+{}
+
+bool NFS::Write3Worker::setup(NFS::Client *client_,
                               const v8::Local<v8::Value> &obj_fh_,
                               const v8::Local<v8::Value> &count_,
                               const v8::Local<v8::Value> &offset_,
                               const v8::Local<v8::Value> &stable_,
                               const v8::Local<v8::Value> &data_,
-                              Nan::Callback *callback)
-    : Procedure3Worker(client_, (xdrproc_t) xdr_WRITE3res, callback)
+                              const v8::Local<v8::Value> &callback_)
 {
+    reset(client_, callback_);
     args.file.data.data_val = node::Buffer::Data(obj_fh_);
     args.file.data.data_len = node::Buffer::Length(obj_fh_);
     args.count = count_->NumberValue();
@@ -70,11 +80,11 @@ NFS::Write3Worker::Write3Worker(NFS::Client *client_,
 
     if (args.offset == (uint64_t)-1) {
         Nan::ThrowRangeError("Invalid offset");
-        return;
+        return false;
     }
     if (node::Buffer::Length(data_) < args.count) {
         Nan::ThrowRangeError("count greater than buffer size");
-        return;
+        return false;
     }
     switch (args.stable) {
     case UNSTABLE:
@@ -83,8 +93,33 @@ NFS::Write3Worker::Write3Worker(NFS::Client *client_,
         break;
     default:
         Nan::ThrowRangeError("Invalid stable value");
-        return;
+        return false;
     }
+    return true;
+}
+
+void NFS::write3_update_caches(NFS::Connection *connection,
+                               const WRITE3args &args,
+                               const WRITE3res &res)
+{
+    AttrCache &cache = connection->getAttrCache();
+    PageCache &pages = connection->getPageCache();
+    connection->getReadahead().invalidate(args.file);
+    if (res.status == NFS3_OK) {
+        cache.put(args.file, res.WRITE3res_u.resok.file_wcc);
+        pages.written(args.file, res.WRITE3res_u.resok.file_wcc,
+                      args.offset, args.data.data_val,
+                      std::min(res.WRITE3res_u.resok.count,
+                               args.data.data_len));
+    } else {
+        cache.put(args.file, res.WRITE3res_u.resfail.file_wcc);
+        pages.invalidate(args.file);
+    }
+}
+
+void NFS::Write3Worker::updateCaches()
+{
+    write3_update_caches(client->getConnection(), args, res);
 }
 
 void NFS::Write3Worker::procSuccess()
@@ -137,7 +172,7 @@ void NFS::Write3Worker::procFailure()
     obj_attrs->Set(Nan::New("after").ToLocalChecked(),
                    before);
     v8::Local<v8::Value> argv[] = {
-        Nan::New(error?error:NFSC_UNKNOWN_ERROR).ToLocalChecked(),
+        Nan::New<v8::Integer>(error ? error : NFSC_UNKNOWN_ERROR),
         obj_attrs
     };
     callback->Call(2, argv);
@@ -0,0 +1,524 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <string.h>
+#include <algorithm>
+#include "node_nfsc.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_writebehind.h"
+#include "node_nfsc_write3.h"
+
+// (object, offset, data, callback(err) ) -> true when gathered, the
+// callback is not called then
+NAN_METHOD(NFS::Client::WriteBehind3) {
+    bool typeError = true;
+    if ( info.Length() != 4) {
+        Nan::ThrowTypeError("Must be called with 4 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, object must be a Buffer");
+    else if (!info[1]->IsNumber())
+        Nan::ThrowTypeError("Parameter 2, offset must be a unsigned integer");
+    else if (!info[2]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 3, data must be a Buffer");
+    else if (!info[3]->IsFunction())
+        Nan::ThrowTypeError("Parameter 4, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    uint64_t offset = CheckUDouble(info[1]->NumberValue());
+    if (offset == (uint64_t)-1) {
+        Nan::ThrowRangeError("Invalid offset");
+        return;
+    }
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    NFS::FileHandle fh(node::Buffer::Data(info[0]),
+                       node::Buffer::Length(info[0]));
+    const char *data = node::Buffer::Data(info[2]);
+    size_t len = node::Buffer::Length(info[2]);
+    if (obj->isMounted() &&
+        obj->connection->getWriteBehind().absorb(fh, offset, data, len)) {
+        info.GetReturnValue().Set(Nan::True());
+        return;
+    }
+    NFS::WriteBehindWorker *worker =
+            NFS::WorkerPool<NFS::WriteBehindWorker>::instance().acquire();
+    worker->setup(obj, info[0], offset, data, len, info[3]);
+    Nan::AsyncQueueWorker(worker);
+    info.GetReturnValue().Set(Nan::False());
+}
+
+// (object, callback(err) )
+NAN_METHOD(NFS::Client::Flush3) {
+    bool typeError = true;
+    if ( info.Length() != 2) {
+        Nan::ThrowTypeError("Must be called with 2 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, object must be a Buffer");
+    else if (!info[1]->IsFunction())
+        Nan::ThrowTypeError("Parameter 2, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    NFS::WriteBehindWorker *worker =
+            NFS::WorkerPool<NFS::WriteBehindWorker>::instance().acquire();
+    worker->setupFlush(obj, info[0], info[1]);
+    Nan::AsyncQueueWorker(worker);
+}
+
+NFS::WriteBehind::WriteBehind()
+    : lock(),
+      wsize(NFSC_WSIZE),
+      files(),
+      gathered(0),
+      writes(0),
+      commits(0),
+      resent(0)
+{}
+
+void NFS::WriteBehind::configure(size_t wsize_)
+{
+    std::lock_guard<std::mutex> my(lock);
+    wsize = wsize_;
+}
+
+size_t NFS::WriteBehind::getWsize()
+{
+    std::lock_guard<std::mutex> my(lock);
+    return wsize;
+}
+
+/* forget a file once nothing is left to send, commit or report */
+void NFS::WriteBehind::release(Files::iterator file)
+{
+    if (file->second.dirty.empty() && file->second.uncommitted.empty() &&
+        !file->second.error && !file->second.sending)
+        files.erase(file);
+}
+
+bool NFS::WriteBehind::absorb(const FileHandle &fh, uint64_t offset,
+                              const char *data, size_t len)
+{
+    std::lock_guard<std::mutex> my(lock);
+    File &file = files[fh];
+    if (file.dirty.empty())
+        file.start = offset;
+    if (offset != file.start + file.dirty.size() ||
+        file.dirty.size() + len > wsize) {
+        release(files.find(fh));
+        return false;
+    }
+    file.dirty.append(data, len);
+    ++gathered;
+    return true;
+}
+
+bool NFS::WriteBehind::take(const FileHandle &fh, uint64_t *offset,
+                            std::string *data)
+{
+    std::lock_guard<std::mutex> my(lock);
+    Files::iterator file = files.find(fh);
+    if (file == files.end() || file->second.dirty.empty())
+        return false;
+    *offset = file->second.start;
+    data->swap(file->second.dirty);
+    file->second.dirty.clear();
+    release(file);
+    return true;
+}
+
+void NFS::WriteBehind::startSending(const FileHandle &fh)
+{
+    std::lock_guard<std::mutex> my(lock);
+    ++files[fh].sending;
+}
+
+void NFS::WriteBehind::endSending(const FileHandle &fh)
+{
+    std::lock_guard<std::mutex> my(lock);
+    Files::iterator file = files.find(fh);
+    if (--file->second.sending)
+        return;
+    release(file);
+    idle.notify_all();
+}
+
+void NFS::WriteBehind::waitSent(const FileHandle &fh)
+{
+    std::unique_lock<std::mutex> my(lock);
+    NFSC_LOOP_WAIT("waitSent", idle.wait(my, [&]() {
+        Files::iterator file = files.find(fh);
+        return file == files.end() || !file->second.sending;
+    }));
+}
+
+void NFS::WriteBehind::pending(std::vector<FileHandle> *fhs)
+{
+    std::lock_guard<std::mutex> my(lock);
+    for (Files::iterator file = files.begin() ; file != files.end() ; ++file)
+        fhs->push_back(file->first);
+}
+
+void NFS::WriteBehind::sent(const FileHandle &fh, uint64_t offset,
+                            const char *data, size_t len, const char *verf)
+{
+    std::lock_guard<std::mutex> my(lock);
+    File &file = files[fh];
+    file.uncommitted.push_back(Range());
+    Range &range = file.uncommitted.back();
+    range.seq = ++file.nextSeq;
+    range.offset = offset;
+    range.data.assign(data, len);
+    memcpy(range.verf, verf, NFS3_WRITEVERFSIZE);
+    file.uncommittedBytes += len;
+}
+
+size_t NFS::WriteBehind::getUncommitted(const FileHandle &fh)
+{
+    std::lock_guard<std::mutex> my(lock);
+    Files::iterator file = files.find(fh);
+    return file == files.end() ? 0 : file->second.uncommittedBytes;
+}
+
+uint64_t NFS::WriteBehind::snapshot(const FileHandle &fh)
+{
+    std::lock_guard<std::mutex> my(lock);
+    Files::iterator file = files.find(fh);
+    if (file == files.end() || file->second.uncommitted.empty())
+        return 0;
+    return file->second.uncommitted.back().seq;
+}
+
+void NFS::WriteBehind::committed(const FileHandle &fh, uint64_t seq,
+                                 const char *verf, std::vector<Range> *stale)
+{
+    std::lock_guard<std::mutex> my(lock);
+    Files::iterator it = files.find(fh);
+    if (it == files.end())
+        return;
+    File &file = it->second;
+    std::vector<Range> kept;
+    for (size_t i = 0 ; i < file.uncommitted.size() ; ++i) {
+        Range &range = file.uncommitted[i];
+        if (range.seq > seq) {
+            kept.push_back(Range());
+            kept.back() = range;
+            continue;
+        }
+        file.uncommittedBytes -= range.data.size();
+        if (memcmp(range.verf, verf, NFS3_WRITEVERFSIZE)) {
+            stale->push_back(Range());
+            stale->back().seq = range.seq;
+            stale->back().offset = range.offset;
+            stale->back().data.swap(range.data);
+        }
+    }
+    file.uncommitted.swap(kept);
+    release(it);
+}
+
+void NFS::WriteBehind::setError(const FileHandle &fh, int error)
+{
+    std::lock_guard<std::mutex> my(lock);
+    files[fh].error = error;
+}
+
+int NFS::WriteBehind::takeError(const FileHandle &fh)
+{
+    std::lock_guard<std::mutex> my(lock);
+    Files::iterator file = files.find(fh);
+    if (file == files.end())
+        return 0;
+    int error = file->second.error;
+    file->second.error = 0;
+    release(file);
+    return error;
+}
+
+double NFS::WriteBehind::getGathered() const
+{
+    return gathered;
+}
+
+double NFS::WriteBehind::getWrites() const
+{
+    return writes;
+}
+
+double NFS::WriteBehind::getCommits() const
+{
+    return commits;
+}
+
+double NFS::WriteBehind::getResent() const
+{
+    return resent;
+}
+
+void NFS::WriteBehind::countWrite()
+{
+    std::lock_guard<std::mutex> my(lock);
+    ++writes;
+}
+
+void NFS::WriteBehind::countCommit()
+{
+    std::lock_guard<std::mutex> my(lock);
+    ++commits;
+}
+
+void NFS::WriteBehind::countResent()
+{
+    std::lock_guard<std::mutex> my(lock);
+    ++resent;
+}
+
+NFS::WriteBehindWorker::WriteBehindWorker(NFS::WorkerPoolBase *pool_)
+    : PooledWorker(pool_, true),
+      client(0),
+      error(0),
+      flush(false),
+      fh(),
+      offset(0),
+      data()
+{}
+
+void NFS::WriteBehindWorker::setup(NFS::Client *client_,
+                                   const v8::Local<v8::Value> &obj_fh_,
+                                   uint64_t offset_,
+                                   const char *data_, size_t len,
+                                   const v8::Local<v8::Value> &callback_)
+{
+    client = client_;
+    callback->Reset(callback_.As<v8::Function>());
+    fh.assign(node::Buffer::Data(obj_fh_), node::Buffer::Length(obj_fh_));
+    flush = false;
+    offset = offset_;
+    /* the caller may reuse its Buffer as soon as we return */
+    data.assign(data_, len);
+}
+
+void NFS::WriteBehindWorker::setupFlush(NFS::Client *client_,
+                                        const v8::Local<v8::Value> &obj_fh_,
+                                        const v8::Local<v8::Value> &callback_)
+{
+    client = client_;
+    callback->Reset(callback_.As<v8::Function>());
+    fh.assign(node::Buffer::Data(obj_fh_), node::Buffer::Length(obj_fh_));
+    flush = true;
+}
+
+NFS::WriteBehindSender::WriteBehindSender(NFS::Client *client_,
+                                          const NFS::FileHandle &fh_)
+    : client(client_),
+      fh(fh_),
+      error(0)
+{}
+
+int NFS::WriteBehindSender::getError() const
+{
+    return error;
+}
+
+/* errors of gathered data are also reported by the next flush */
+void NFS::WriteBehindSender::fail(int error_)
+{
+    error = error_;
+    client->getConnection()->getWriteBehind().setError(fh, error);
+}
+
+bool NFS::WriteBehindSender::write(uint64_t offset_, const char *data_,
+                                   size_t len, stable_how stable)
+{
+    Connection *connection = client->getConnection();
+    WriteBehind &writeBehind = connection->getWriteBehind();
+    /* a small wsize limits gathering, not the size of the WRITEs */
+    size_t wsize = std::max<size_t>(writeBehind.getWsize(), NFSC_WSIZE);
+    Channel channel(client);
+    WRITE3args args;
+    fh.toNfs(&args.file);
+    args.stable = stable;
+    while (len) {
+        WRITE3res res = WRITE3res();
+        clnt_stat stat;
+        args.offset = offset_;
+        args.count = std::min(len, wsize);
+        args.data.data_val = const_cast<char *>(data_);
+        args.data.data_len = args.count;
+        stat = channel.check(nfsproc3_write_3(&args, &res, channel.get()));
+        if (stat != RPC_SUCCESS) {
+            fail(rpc_error_code(stat));
+            return false;
+        }
+        writeBehind.countWrite();
+        write3_update_caches(connection, args, res);
+        WRITE3resok &resok = res.WRITE3res_u.resok;
+        if (res.status != NFS3_OK || !resok.count) {
+            fail(nfs3_error_code(res.status != NFS3_OK ? res.status
+                                                       : NFS3ERR_IO));
+            xdr_free((xdrproc_t) xdr_WRITE3res, (char *)&res);
+            return false;
+        }
+        size_t done = std::min<size_t>(resok.count, args.count);
+        if (resok.committed == UNSTABLE)
+            writeBehind.sent(fh, offset_, data_, done, resok.verf);
+        xdr_free((xdrproc_t) xdr_WRITE3res, (char *)&res);
+        offset_ += done;
+        data_ += done;
+        len -= done;
+    }
+    return true;
+}
+
+bool NFS::WriteBehindSender::commit()
+{
+    Connection *connection = client->getConnection();
+    WriteBehind &writeBehind = connection->getWriteBehind();
+    uint64_t seq = writeBehind.snapshot(fh);
+    COMMIT3args args;
+    COMMIT3res res = COMMIT3res();
+    clnt_stat stat;
+    if (!seq)
+        return true;
+    fh.toNfs(&args.file);
+    args.offset = 0;
+    args.count = 0;
+    {
+        /* released before the stale ranges are written again */
+        Channel channel(client);
+        stat = channel.check(nfsproc3_commit_3(&args, &res, channel.get()));
+    }
+    if (stat != RPC_SUCCESS) {
+        fail(rpc_error_code(stat));
+        return false;
+    }
+    writeBehind.countCommit();
+    if (res.status != NFS3_OK) {
+        connection->getAttrCache().put(args.file,
+                                       res.COMMIT3res_u.resfail.file_wcc);
+        fail(nfs3_error_code(res.status));
+        xdr_free((xdrproc_t) xdr_COMMIT3res, (char *)&res);
+        return false;
+    }
+    connection->getAttrCache().put(args.file, res.COMMIT3res_u.resok.file_wcc);
+    /* the server restarted since some WRITEs, send them again */
+    std::vector<WriteBehind::Range> stale;
+    writeBehind.committed(fh, seq, res.COMMIT3res_u.resok.verf, &stale);
+    xdr_free((xdrproc_t) xdr_COMMIT3res, (char *)&res);
+    for (size_t i = 0 ; i < stale.size() ; ++i) {
+        writeBehind.countResent();
+        if (!write(stale[i].offset, stale[i].data.data(),
+                   stale[i].data.size(), FILE_SYNC))
+            return false;
+    }
+    return true;
+}
+
+int NFS::WriteBehindSender::flush()
+{
+    WriteBehind &writeBehind = client->getConnection()->getWriteBehind();
+    uint64_t start;
+    std::string dirty;
+
+    if (writeBehind.take(fh, &start, &dirty))
+        write(start, dirty.data(), dirty.size(), UNSTABLE);
+    /* what other workers took is COMMITted with the rest */
+    writeBehind.waitSent(fh);
+    if (!error)
+        commit();
+    /* report, once, the errors of everything sent since the last flush */
+    int sticky = writeBehind.takeError(fh);
+    return error ? error : sticky;
+}
+
+int NFS::write_behind_drain(NFS::Client *client)
+{
+    std::vector<FileHandle> fhs;
+    int error = 0;
+    client->getConnection()->getWriteBehind().pending(&fhs);
+    for (size_t i = 0 ; i < fhs.size() ; ++i) {
+        WriteBehindSender sender(client, fhs[i]);
+        int failed = sender.flush();
+        if (!error)
+            error = failed;
+    }
+    return error;
+}
+
+/* the data gathered before ours goes first */
+void NFS::WriteBehindWorker::send()
+{
+    WriteBehind &writeBehind = client->getConnection()->getWriteBehind();
+    WriteBehindSender sender(client, fh);
+    uint64_t start;
+    std::string dirty;
+
+    if (writeBehind.take(fh, &start, &dirty) &&
+        !sender.write(start, dirty.data(), dirty.size(), UNSTABLE)) {
+        error = sender.getError();
+        return;
+    }
+    if (!writeBehind.absorb(fh, offset, data.data(), data.size()) &&
+        !sender.write(offset, data.data(), data.size(), UNSTABLE)) {
+        error = sender.getError();
+        return;
+    }
+    if (writeBehind.getUncommitted(fh) >= NFSC_WRITE_BEHIND_UNCOMMITTED)
+        sender.commit();
+    error = sender.getError();
+}
+
+void NFS::WriteBehindWorker::Execute()
+{
+    WriteBehind &writeBehind = client->getConnection()->getWriteBehind();
+
+    if (!client->isMounted()) {
+        error = NFSC_NOT_MOUNTED;
+        return;
+    }
+    if (flush) {
+        error = WriteBehindSender(client, fh).flush();
+        return;
+    }
+    writeBehind.startSending(fh);
+    send();
+    writeBehind.endSending(fh);
+}
+
+void NFS::WriteBehindWorker::HandleOKCallback()
+{
+    Nan::HandleScope scope;
+    v8::Local<v8::Value> argv[] = {
+        error ? v8::Local<v8::Value>(Nan::New<v8::Integer>(error))
+              : v8::Local<v8::Value>(Nan::Null())
+    };
+    callback->Call(1, argv);
+}
+
+void NFS::WriteBehindWorker::recycle()
+{
+    client = 0;
+    error = 0;
+    data.clear();
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <string.h>
+#include <algorithm>
+#include "node_nfsc.h"
+#include "node_nfsc_writefile.h"
+#include "node_nfsc_channel.h"
+#include "node_nfsc_errors3.h"
+#include "node_nfsc_options.h"
+
+// (object, data, options, callback(err, count, skipped) )
+NAN_METHOD(NFS::Client::WriteFile) {
+    bool typeError = true;
+    if (info.Length() != 4) {
+        Nan::ThrowTypeError("Must be called with 4 parameters");
+        return;
+    }
+    if (!info[0]->IsUint8Array())
+        Nan::ThrowTypeError("Parameter 1, object must be a Buffer");
+    else if (!info[1]->IsUint8Array() && !info[1]->IsArray())
+        Nan::ThrowTypeError("Parameter 2, data must be a Buffer or an array "
+                            "of Buffers");
+    else if (!info[2]->IsUndefined() && !info[2]->IsNull() &&
+             !info[2]->IsObject())
+        Nan::ThrowTypeError("Parameter 3, options must be an object");
+    else if (!info[3]->IsFunction())
+        Nan::ThrowTypeError("Parameter 4, callback must be a function");
+    else
+        typeError = false;
+    if (typeError)
+        return;
+    std::vector<v8::Local<v8::Value> > buffers;
+    if (info[1]->IsArray()) {
+        v8::Local<v8::Array> array = info[1].As<v8::Array>();
+        for (uint32_t i = 0 ; i < array->Length() ; ++i) {
+            v8::Local<v8::Value> item = array->Get(i);
+            if (!item->IsUint8Array()) {
+                Nan::ThrowTypeError("Parameter 2, data must be a Buffer or "
+                                    "an array of Buffers");
+                return;
+            }
+            buffers.push_back(item);
+        }
+    } else {
+        buffers.push_back(info[1]);
+    }
+    uint64_t length = 0;
+    for (size_t i = 0 ; i < buffers.size() ; ++i)
+        length += node::Buffer::Length(buffers[i]);
+    uint64_t offset = CheckUDouble(option_number(info[2], "offset", 0));
+    if (offset == (uint64_t)-1 ||
+        CheckUDouble(double(offset + length)) == (uint64_t)-1) {
+        Nan::ThrowRangeError("Invalid offset");
+        return;
+    }
+    int stable = option_uint(info[2], "stable", UNSTABLE);
+    switch (stable) {
+    case UNSTABLE:
+    case DATA_SYNC:
+    case FILE_SYNC:
+        break;
+    default:
+        Nan::ThrowRangeError("Invalid stable value");
+        return;
+    }
+    NFS::Client* obj = ObjectWrap::Unwrap<NFS::Client>(info.Holder());
+    uint32_t chunkSize = option_uint(info[2], "chunkSize",
+                                     obj->getConnection()->getWtmax());
+    unsigned depth = option_uint(info[2], "depth", NFSC_PIPELINE_DEPTH);
+    bool sparse = option_bool(info[2], "sparse", false);
+    NFS::WriteFileJob *job = new NFS::WriteFileJob(obj, info[0], info[1],
+                                                   offset, length, chunkSize,
+                                                   depth, stable_how(stable),
+                                                   sparse, info[3]);
+    for (size_t i = 0 ; i < buffers.size() ; ++i)
+        job->add(node::Buffer::Data(buffers[i]),
+                 node::Buffer::Length(buffers[i]));
+    job->start();
+}
+
+NFS::WriteFileJob::WriteFileJob(NFS::Client *client_,
+                                const v8::Local<v8::Value> &obj_fh_,
+                                const v8::Local<v8::Value> &data_,
+                                uint64_t offset, uint64_t length,
+                                uint32_t chunkSize_, unsigned depth_,
+                                stable_how stable_, bool sparse_,
+                                const v8::Local<v8::Value> &callback_)
+    : Pipeline(client_, offset, length, chunkSize_, depth_, callback_),
+      fh(node::Buffer::Data(obj_fh_), node::Buffer::Length(obj_fh_)),
+      stable(stable_),
+      sparse(sparse_),
+      skipped(0),
+      segments(),
+      segment(0),
+      segmentStart(offset),
+      uncommitted()
+{
+    /* WRITEs are sent from the Buffers themselves */
+    keep("data", data_);
+}
+
+void NFS::WriteFileJob::add(const char *data, size_t len)
+{
+    if (!len)
+        return;
+    Segment seg = { data, len };
+    segments.push_back(seg);
+}
+
+void NFS::WriteFileJob::prepare(NFS::PipelineChunk *chunk)
+{
+    /* chunks are prepared in offset order */
+    while (chunk->offset >= segmentStart + segments[segment].len) {
+        segmentStart += segments[segment].len;
+        ++segment;
+    }
+    const Segment &seg = segments[segment];
+    chunk->data = const_cast<char *>(seg.data) +
+            (chunk->offset - segmentStart);
+    chunk->count = std::min<uint64_t>(chunk->count,
+                                      segmentStart + seg.len - chunk->offset);
+}
+
+void NFS::WriteFileJob::execute(NFS::PipelineChunk *chunk)
+{
+    Channel channel(client);
+    pipeline_write(client, channel, fh, chunk, stable, sparse);
+}
+
+void NFS::WriteFileJob::deliver(NFS::PipelineChunk *chunk)
+{
+    skipped += chunk->skipped;
+    if (!chunk->unstable)
+        return;
+    Uncommitted range;
+    range.offset = chunk->offset;
+    range.len = chunk->len;
+    range.data = chunk->data;
+    memcpy(range.verf, chunk->verf, NFS3_WRITEVERFSIZE);
+    uncommitted.push_back(range);
+}
+
+bool NFS::WriteFileJob::hasFinish() const
+{
+    return skipped || !uncommitted.empty();
+}
+
+int NFS::WriteFileJob::finish()
+{
+    Channel channel(client);
+    if (!uncommitted.empty()) {
+        char verf[NFS3_WRITEVERFSIZE];
+        uint64_t offset = uncommitted.front().offset;
+        int error_ = pipeline_commit(client, channel, fh, offset,
+                                     uncommitted.back().offset +
+                                     uncommitted.back().len - offset, verf);
+        if (error_)
+            return error_;
+        /* the server restarted since some WRITEs, send them again */
+        for (size_t i = 0 ; i < uncommitted.size() ; ++i) {
+            const Uncommitted &range = uncommitted[i];
+            if (!memcmp(range.verf, verf, NFS3_WRITEVERFSIZE))
+                continue;
+            PipelineChunk chunk = PipelineChunk();
+            chunk.offset = range.offset;
+            chunk.count = range.len;
+            chunk.data = range.data;
+            pipeline_write(client, channel, fh, &chunk, FILE_SYNC, sparse);
+            if (chunk.error)
+                return chunk.error;
+        }
+    }
+    return skipped ? pipeline_extend(client, channel, fh, getEnd()) : 0;
+}
+
+void NFS::WriteFileJob::done(int error_)
+{
+    if (error_) {
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::Integer>(error_)
+        };
+        callback.Call(1, argv);
+        return;
+    }
+    v8::Local<v8::Value> argv[] = {
+        Nan::Null(),
+        Nan::New<v8::Number>(double(getDelivered() - getStart())),
+        Nan::New<v8::Number>(skipped)
+    };
+    callback.Call(sizeof(argv)/sizeof(*argv), argv);
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2017 Scality
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @authors:
+ *    Guillaume Gimenez <ggim@scality.com>
+ */
+#include <stdint.h>
+#include <string.h>
+#include "node_nfsc_zero.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define NFSC_ZERO_X86
+#endif
+
+typedef bool (*zero_scan)(const char *data, size_t len);
+
+static bool zero_scalar(const char *data, size_t len)
+{
+    const char *end = data + len;
+    for (; data + 32 <= end ; data += 32) {
+        uint64_t w[4];
+        memcpy(w, data, sizeof(w));
+        if (w[0] | w[1] | w[2] | w[3])
+            return false;
+    }
+    for (; data < end ; ++data)
+        if (*data)
+            return false;
+    return true;
+}
+
+#ifdef NFSC_ZERO_X86
+__attribute__((target("sse2")))
+static bool zero_sse2(const char *data, size_t len)
+{
+    const char *end = data + len;
+    const __m128i zero = _mm_setzero_si128();
+    for (; data + 64 <= end ; data += 64) {
+        __m128i acc = _mm_or_si128(
+                _mm_or_si128(_mm_loadu_si128((const __m128i *)data),
+                             _mm_loadu_si128((const __m128i *)(data + 16))),
+                _mm_or_si128(_mm_loadu_si128((const __m128i *)(data + 32)),
+                             _mm_loadu_si128((const __m128i *)(data + 48))));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, zero)) != 0xffff)
+            return false;
+    }
+    return zero_scalar(data, end - data);
+}
+
+__attribute__((target("avx2")))
+static bool zero_avx2(const char *data, size_t len)
+{
+    const char *end = data + len;
+    for (; data + 128 <= end ; data += 128) {
+        __m256i acc = _mm256_or_si256(
+                _mm256_or_si256(
+                        _mm256_loadu_si256((const __m256i *)data),
+                        _mm256_loadu_si256((const __m256i *)(data + 32))),
+                _mm256_or_si256(
+                        _mm256_loadu_si256((const __m256i *)(data + 64)),
+                        _mm256_loadu_si256((const __m256i *)(data + 96))));
+        if (!_mm256_testz_si256(acc, acc))
+            return false;
+    }
+    return zero_sse2(data, end - data);
+}
+#endif
+
+static zero_scan zero_select()
+{
+#ifdef NFSC_ZERO_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return zero_avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return zero_sse2;
+#endif
+    return zero_scalar;
+}
+
+/* picked once, when the addon is loaded */
+static const zero_scan zero_impl = zero_select();
+
+bool NFS::zero_block(const char *data, size_t len)
+{
+    return zero_impl(data, len);
+}
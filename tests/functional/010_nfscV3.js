@@ -4,6 +4,9 @@ var nfsc = require('../../index');
 var config = require('../config.json');
 var assert = require('assert');
 var crypto = require('crypto');
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
 var async = require('async');
 
 var test_dir = 'foo_' + crypto.randomBytes(8).toString('hex');
@@ -99,6 +102,20 @@ async.waterfall([
                 done(next, null, root);
             });
         }),
+    (root, next) =>
+        describeIt('should reuse pooled workers', done => {
+            const getattr = cb => mnt.getattr(root, err => cb(err));
+            async.timesSeries(8, (n, cb) => getattr(cb), err => {
+                assert.ifError(err);
+                /* the last worker goes back to its pool after its callback */
+                setImmediate(() => {
+                    const stats = nfsc.workerPoolStats().getattr3;
+                    assert(stats.reused > 0);
+                    assert.strictEqual(stats.outstanding, 0);
+                    done(next, null, root);
+                });
+            });
+        }),
     (root, next) =>
         describeIt('should lookup the directory', done =>{
             mnt.lookup(root, test_dir, (err, dir, obj_attrs, dir_attrs) => {
@@ -107,6 +124,40 @@ async.waterfall([
                 done(next, null, dir);
             });
         }),
+    (dir, next) =>
+        describeIt('should resolve the directory path', done =>{
+            mnt.resolvePath(root_fh, `./${test_dir}/`, { intermediates: true },
+                            (err, object, obj_attrs, handles) => {
+                                assert.strictEqual(err, null);
+                                assert.deepStrictEqual(object, dir);
+                                assert.strictEqual(obj_attrs.type, mnt.NF3DIR);
+                                assert.deepStrictEqual(handles, [root_fh]);
+                                done(next, null, dir);
+                            });
+        }),
+    (dir, next) =>
+        describeIt('should stat several paths at once', done =>{
+            mnt.statPaths(root_fh, [test_dir, `${test_dir}/missing`,
+                                    `missing_${test_dir}/a`, '.'],
+                          (err, results) => {
+                              assert.strictEqual(err, null);
+                              assert.strictEqual(results.length, 4);
+                              assert.strictEqual(results.err(0), null);
+                              assert.deepStrictEqual(results.handle(0), dir);
+                              assert.strictEqual(results.type(0),
+                                                 mnt.NF3DIR);
+                              assert.strictEqual(results.err(1).status,
+                                                 'NFS3ERR_NOENT');
+                              assert.strictEqual(results.attributes(1),
+                                                 null);
+                              assert.strictEqual(results.err(2).status,
+                                                 'NFS3ERR_NOENT');
+                              assert.strictEqual(results.err(3), null);
+                              assert.deepStrictEqual(results.handle(3),
+                                                     root_fh);
+                              done(next, null, dir);
+                          });
+        }),
     (dir, next) =>
         describeIt('should create a file', done =>{
             var filename = 'bar_' + crypto.randomBytes(8).toString('hex');
@@ -122,6 +173,132 @@ async.waterfall([
             mnt.getattr(object, (err, second_obj_attrs) => {
                 assert.strictEqual(err, null);
                 assert.deepStrictEqual(obj_attrs, second_obj_attrs);
+                done(next, null, object, dir, filename, obj_attrs);
+            });
+        }),
+    (object, dir, filename, obj_attrs, next) =>
+        describeIt('should getattr on file from the cache', done => {
+            const hits = mnt.cacheStats().attributes.hits;
+            mnt.getattr(object, { cached: true }, (err, cached_attrs) => {
+                assert.strictEqual(err, null);
+                assert.deepStrictEqual(obj_attrs, cached_attrs);
+                assert.strictEqual(mnt.cacheStats().attributes.hits,
+                                   hits + 1);
+                done(next, null, object, dir, filename);
+            });
+        }),
+    (object, dir, filename, next) =>
+        describeIt('should check access twice, once on the server', done => {
+            const mask = mnt.ACCESS_READ | mnt.ACCESS_MODIFY;
+            mnt.access(object, mask, (err, access) => {
+                assert.strictEqual(err, null);
+                const hits = mnt.cacheStats().access.hits;
+                mnt.access(object, mnt.ACCESS_READ, (err, cached) => {
+                    assert.strictEqual(err, null);
+                    assert.strictEqual(cached, access & mnt.ACCESS_READ);
+                    assert.strictEqual(mnt.cacheStats().access.hits,
+                                       hits + 1);
+                    done(next, null, object, dir, filename);
+                });
+            });
+        }),
+    (object, dir, filename, next) =>
+        describeIt('should answer a missing name from the cache until created',
+                   done => {
+            const name = 'missing_' + crypto.randomBytes(8).toString('hex');
+            const missing = cb => mnt.lookup(dir, name, err => {
+                assert.strictEqual(err.status, 'NFS3ERR_NOENT');
+                cb();
+            });
+            let negativeHits;
+            async.series([
+                missing,
+                cb => {
+                    negativeHits = mnt.cacheStats().names.negativeHits;
+                    missing(cb);
+                },
+                cb => {
+                    assert.strictEqual(mnt.cacheStats().names.negativeHits,
+                                       negativeHits + 1);
+                    mnt.create(dir, name, mnt.CREATE_GUARDED, { mode: 0o644 },
+                               err => cb(err));
+                },
+                cb => mnt.lookup(dir, name, (err, created) => {
+                    assert.strictEqual(err, null);
+                    assert.strictEqual(typeof(created), 'object');
+                    assert.strictEqual(mnt.cacheStats().names.negativeHits,
+                                       negativeHits + 1);
+                    cb();
+                }),
+                cb => mnt.remove(dir, name, err => cb(err)),
+            ], err => {
+                assert.ifError(err);
+                done(next, null, object, dir, filename);
+            });
+        }),
+    (object, dir, filename, next) =>
+        describeIt('should keep the caches of a shared connection', done => {
+            const options = Object.assign({}, config, { shared: true });
+            const first = new nfsc.V3(options);
+            async.waterfall([
+                cb => first.mount(err => cb(err)),
+                cb => first.getattr(object, err => cb(err)),
+                cb => {
+                    const before = first.cacheStats();
+                    assert.notStrictEqual(before.attributes.entries, 0);
+                    const second = new nfsc.V3(options);
+                    const after = first.cacheStats();
+                    assert.strictEqual(after.attributes.entries,
+                                       before.attributes.entries);
+                    assert.strictEqual(after.names.entries,
+                                       before.names.entries);
+                    assert.strictEqual(second.cacheStats().attributes.entries,
+                                       before.attributes.entries);
+                    first.unmount(cb);
+                },
+            ], err => {
+                assert.ifError(err);
+                done(next, null, object, dir, filename);
+            });
+        }),
+    (object, dir, filename, next) =>
+        describeIt('should save the caches', done => {
+            mnt.saveCache(err => {
+                assert.strictEqual(err, null);
+                done(next, null, object, dir, filename);
+            });
+        }),
+    (object, dir, filename, next) =>
+        describeIt('should start warm from the cache file', done => {
+            const cacheFile = path.join(os.tmpdir(), test_dir + '.cache');
+            const options = Object.assign({}, config, { cacheFile });
+            const first = new nfsc.V3(options);
+            let second;
+            let before;
+            async.series([
+                cb => first.mount(err => cb(err)),
+                cb => first.getattr(object, err => cb(err)),
+                /* the last unmount writes the cache file */
+                cb => first.unmount(cb),
+                cb => {
+                    second = new nfsc.V3(options);
+                    second.mount(err => cb(err));
+                },
+                cb => {
+                    before = second.cacheStats().attributes;
+                    assert.notStrictEqual(before.entries, 0);
+                    second.getattr(object, { cached: true }, err => cb(err));
+                },
+                cb => {
+                    /* a miss would have sent a GETATTR */
+                    const after = second.cacheStats().attributes;
+                    assert.strictEqual(after.hits, before.hits + 1);
+                    assert.strictEqual(after.misses, before.misses);
+                    second.unmount(cb);
+                },
+            ], err => {
+                assert.ifError(err);
+                fs.unlinkSync(cacheFile);
                 done(next, null, object, dir, filename);
             });
         }),
@@ -136,6 +313,381 @@ async.waterfall([
                           done(next, null, object, dir, filename, buffer);
                       });
         }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should gather small writes and flush them', done => {
+            const before = mnt.cacheStats().writeBehind.gathered;
+            const half = buffer.length / 2;
+            async.series([
+                cb => mnt.writeBehind(object, 0, buffer.slice(0, half), cb),
+                cb => mnt.writeBehind(object, half, buffer.slice(half), cb),
+                cb => mnt.flush(object, cb),
+            ], err => {
+                assert.ifError(err);
+                assert.strictEqual(mnt.cacheStats().writeBehind.gathered,
+                                   before + 2);
+                done(next, null, object, dir, filename, buffer);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should flush gathered writes on unmount', done => {
+            const writer = new nfsc.V3(config);
+            const data = crypto.randomBytes(buffer.length);
+            async.series([
+                cb => writer.mount(err => cb(err)),
+                cb => writer.writeBehind(object, 0, data, cb),
+                /* nothing is sent before the unmount */
+                cb => mnt.read(object, data.length, 0, (err, eof, buf) => {
+                    assert.ifError(err);
+                    assert.deepStrictEqual(buf, buffer);
+                    cb();
+                }),
+                cb => writer.unmount(cb),
+                cb => mnt.read(object, data.length, 0, (err, eof, buf) => {
+                    assert.ifError(err);
+                    assert.deepStrictEqual(buf, data);
+                    cb();
+                }),
+            ], err => {
+                assert.ifError(err);
+                done(next, null, object, dir, filename, data);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should write the whole file at once', done => {
+            const data = crypto.randomBytes(buffer.length);
+            const half = data.length / 2;
+            mnt.writeFile(object, [data.slice(0, half), data.slice(half)],
+                          { chunkSize: 1024, depth: 4 }, (err, count) => {
+                              assert.strictEqual(err, null);
+                              assert.strictEqual(count, data.length);
+                              done(next, null, object, dir, filename, data);
+                          });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should read the whole file at once', done => {
+            mnt.readFile(object, { chunkSize: 1024, depth: 4 }, (err, data) => {
+                assert.strictEqual(err, null);
+                assert.deepStrictEqual(data, buffer);
+                done(next, null, object, dir, filename, buffer);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should serve reads from the page cache until changed',
+                   done => {
+            const options = Object.assign({}, config, { pageCache: 1 << 20 });
+            const reader = new nfsc.V3(options);
+            const data = crypto.randomBytes(buffer.length);
+            const read = (expected, cb) =>
+                reader.read(object, expected.length, 0, (err, eof, buf) => {
+                    if (err)
+                        return cb(err);
+                    assert.deepStrictEqual(buf, expected);
+                    return cb();
+                });
+            let hits;
+            async.series([
+                cb => reader.mount(err => cb(err)),
+                cb => read(buffer, cb),
+                cb => {
+                    hits = reader.cacheStats().pages.hits;
+                    read(buffer, cb);
+                },
+                cb => {
+                    assert.strictEqual(reader.cacheStats().pages.hits,
+                                       hits + 1);
+                    mnt.write(object, data.length, 0, mnt.WRITE_FILE_SYNC,
+                              data, err => cb(err));
+                },
+                /* close-to-open: the uncached getattr() sees the change */
+                cb => reader.getattr(object, err => cb(err)),
+                cb => read(data, cb),
+            ], err => {
+                assert.ifError(err);
+                reader.unmount(err => {
+                    assert.ifError(err);
+                    done(next, null, object, dir, filename, data);
+                });
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should reuse slab chunks of collected read buffers',
+                   done => {
+            /* bytes held by live Buffers, and regions mapped, per class */
+            const slab = () => {
+                const classes = nfsc.slabStats().classes;
+                return Object.keys(classes).reduce((acc, size) => {
+                    acc.held += size * classes[size].inUse;
+                    acc.regions += classes[size].regions;
+                    return acc;
+                }, { held: 0, regions: 0 });
+            };
+            let held = [];
+            const reads = cb => async.timesSeries(8, (n, cb) =>
+                mnt.read(object, buffer.length, 0, (err, eof, buf) => {
+                    if (err)
+                        return cb(err);
+                    assert.deepStrictEqual(buf, buffer);
+                    held.push(buf);
+                    return cb();
+                }), err => cb(err));
+            /* chunks go back to the slab once their Buffer is collected */
+            const collect = (limit, cb) => {
+                held = [];
+                global.gc();
+                setTimeout(() => {
+                    if (slab().held <= limit)
+                        return cb();
+                    return collect(limit, cb);
+                }, 10);
+            };
+            const before = slab();
+            let regions;
+            async.series([
+                reads,
+                cb => {
+                    assert(slab().held >= before.held + 8 * buffer.length);
+                    collect(before.held, cb);
+                },
+                cb => {
+                    regions = slab().regions;
+                    reads(cb);
+                },
+                cb => {
+                    assert.strictEqual(slab().regions, regions);
+                    collect(before.held, cb);
+                },
+            ], err => {
+                assert.ifError(err);
+                done(next, null, object, dir, filename, buffer);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should serve sequential reads from the readahead', done => {
+            const options = Object.assign({}, config, { readahead: 1 << 20 });
+            const reader = new nfsc.V3(options);
+            const size = 1024;
+            const read = (offset, cb) =>
+                reader.read(object, size, offset, (err, eof, buf) => {
+                    if (err)
+                        return cb(err);
+                    assert.deepStrictEqual(buf,
+                                           buffer.slice(offset, offset + size));
+                    return cb();
+                });
+            const filled = cb => {
+                const stats = reader.cacheStats().readahead;
+                if (stats.filled === stats.issued)
+                    return cb();
+                return setTimeout(filled, 10, cb);
+            };
+            async.series([
+                cb => reader.mount(err => cb(err)),
+                cb => read(0, cb),
+                /* the second sequential read opens the window */
+                cb => read(size, cb),
+                filled,
+                cb => read(2 * size, cb),
+                cb => read(3 * size, cb),
+            ], err => {
+                assert.ifError(err);
+                const stats = reader.cacheStats().readahead;
+                assert.strictEqual(stats.issued, 1);
+                assert.strictEqual(stats.hits, 2);
+                reader.unmount(err => {
+                    assert.ifError(err);
+                    done(next, null, object, dir, filename, buffer);
+                });
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should stream the file out and back', done => {
+            const half = buffer.length / 2;
+            const output = mnt.createWriteStream(object, { chunkSize: 1024 });
+            output.on('error', err => assert.ifError(err));
+            output.write(buffer.slice(0, half));
+            output.end(buffer.slice(half), () => {
+                const chunks = [];
+                mnt.createReadStream(object, { chunkSize: 1024 })
+                    .on('error', err => assert.ifError(err))
+                    .on('data', chunk => chunks.push(chunk))
+                    .on('end', () => {
+                        assert.deepStrictEqual(Buffer.concat(chunks), buffer);
+                        done(next, null, object, dir, filename, buffer);
+                    });
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should copy the file natively', done => {
+            const copyname = filename + '.copy';
+            async.waterfall([
+                cb => mnt.create(dir, copyname, mnt.CREATE_GUARDED,
+                                 { mode: 0o600 }, cb),
+                (copy, attrs, wcc, cb) =>
+                    mnt.copy(object, mnt, copy,
+                             { chunkSize: 1024, attributes: true },
+                             (err, count) => cb(err, copy, count)),
+                (copy, count, cb) => {
+                    assert.strictEqual(count, buffer.length);
+                    mnt.readFile(copy, cb);
+                },
+                (data, cb) => {
+                    assert.deepStrictEqual(data, buffer);
+                    mnt.remove(dir, copyname, cb);
+                },
+            ], err => {
+                assert.ifError(err);
+                done(next, null, object, dir, filename, buffer);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should hash the file natively', done => {
+            mnt.checksum(object, { algorithms: ['sha256', 'crc32c'],
+                                   chunkSize: 1024 },
+                         (err, digests, count) => {
+                             assert.strictEqual(err, null);
+                             assert.strictEqual(count, buffer.length);
+                             assert.strictEqual(digests.sha256,
+                                 crypto.createHash('sha256')
+                                     .update(buffer).digest('hex'));
+                             assert.strictEqual(digests.crc32c.length, 8);
+                             done(next, null, object, dir, filename, buffer);
+                         });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should hash known content in any chunk order', done => {
+            /* '123456789' then i % 251, digests from reference code */
+            const data = Buffer.alloc(4096);
+            for (let i = 0; i < data.length; ++i)
+                data[i] = i % 251;
+            data.write('123456789');
+            const algorithms = ['crc32c', 'xxhash64', 'sha256'];
+            async.series([
+                cb => mnt.writeFile(object, [data], {}, cb),
+                /* chunks of 4 bytes, several in flight */
+                cb => mnt.checksum(object, { algorithms, length: 9,
+                                             chunkSize: 4, depth: 4 },
+                                   (err, digests, count) => {
+                                       assert.ifError(err);
+                                       assert.strictEqual(count, 9);
+                                       assert.strictEqual(digests.crc32c,
+                                                          'e3069283');
+                                       assert.strictEqual(digests.xxhash64,
+                                                          '8cb841db40e6ae83');
+                                       cb();
+                                   }),
+                /* chunks across the 32 byte stripes of XXH64 */
+                cb => mnt.checksum(object, { algorithms, chunkSize: 1000,
+                                             depth: 4 },
+                                   (err, digests, count) => {
+                                       assert.ifError(err);
+                                       assert.strictEqual(count, data.length);
+                                       assert.deepStrictEqual(digests, {
+                                           crc32c: '2c916e40',
+                                           xxhash64: '869558401f22b984',
+                                           sha256: crypto.createHash('sha256')
+                                               .update(data).digest('hex'),
+                                       });
+                                       cb();
+                                   }),
+            ], err => {
+                assert.ifError(err);
+                done(next, null, object, dir, filename, data);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should download the file to a local fd', done => {
+            const local = path.join(os.tmpdir(), test_dir + '.download');
+            const fd = fs.openSync(local, 'w+');
+            mnt.downloadToFd(object, fd, { chunkSize: 1024 },
+                             (err, count) => {
+                                 fs.closeSync(fd);
+                                 const data = fs.readFileSync(local);
+                                 fs.unlinkSync(local);
+                                 assert.strictEqual(err, null);
+                                 assert.strictEqual(count, buffer.length);
+                                 assert.deepStrictEqual(data, buffer);
+                                 done(next, null, object, dir, filename,
+                                      buffer);
+                             });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should report the errno of a failed local write', done => {
+            const local = path.join(os.tmpdir(), test_dir + '.download');
+            fs.writeFileSync(local, '');
+            const fd = fs.openSync(local, 'r');
+            mnt.downloadToFd(object, fd, { chunkSize: 1024 }, err => {
+                fs.closeSync(fd);
+                fs.unlinkSync(local);
+                assert.strictEqual(err.status, 'NFSC_ELOCALWRITE');
+                assert.strictEqual(err.errno, os.constants.errno.EBADF);
+                done(next, null, object, dir, filename, buffer);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should skip the zero blocks of a sparse write', done => {
+            const sparsename = filename + '.sparse';
+            const data = Buffer.alloc(4096);
+            data.fill('x', 1024, 2048);
+            async.waterfall([
+                cb => mnt.create(dir, sparsename, mnt.CREATE_GUARDED,
+                                 { mode: 0o600 }, cb),
+                (sparse, attrs, wcc, cb) =>
+                    mnt.writeFile(sparse, data,
+                                  { chunkSize: 1024, sparse: true },
+                                  (err, count, skipped) =>
+                                      cb(err, sparse, count, skipped)),
+                (sparse, count, skipped, cb) => {
+                    assert.strictEqual(count, data.length);
+                    assert.strictEqual(skipped, 3072);
+                    mnt.readFile(sparse, cb);
+                },
+                (read, cb) => {
+                    assert.deepStrictEqual(read, data);
+                    mnt.remove(dir, sparsename, cb);
+                },
+            ], err => {
+                assert.ifError(err);
+                done(next, null, object, dir, filename, buffer);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should walk the directory', done => {
+            const found = {};
+            mnt.walk(dir, { maxDepth: 1 }, batch => {
+                for (let i = 0; i < batch.length; ++i)
+                    found[batch.path(i)] = batch.attributes(i);
+            }, (err, count) => {
+                assert.strictEqual(err, null);
+                assert.strictEqual(count, Object.keys(found).length);
+                assert.strictEqual(found[filename].size, buffer.length);
+                done(next, null, object, dir, filename, buffer);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should walk only the entries the filter matches', done => {
+            const found = [];
+            const filter = { names: ['bar_*'], types: ['NF3REG'],
+                             minSize: buffer.length, prune: ['*'] };
+            mnt.walk(dir, { filter }, batch => {
+                for (let i = 0; i < batch.length; ++i)
+                    found.push(batch.path(i));
+            }, (err, count) => {
+                assert.strictEqual(err, null);
+                assert.deepStrictEqual(found, [filename]);
+                assert.strictEqual(count, 1);
+                done(next, null, object, dir, filename, buffer);
+            });
+        }),
+    (object, dir, filename, buffer, next) =>
+        describeIt('should reject a filter size out of range', done => {
+            [Infinity, -Infinity, NaN].forEach(size => {
+                assert.throws(() => mnt.walk(dir,
+                                             { filter: { maxSize: size } },
+                                             () => {}, () => {}),
+                              TypeError);
+            });
+            done(next, null, object, dir, filename, buffer);
+        }),
     (object, dir, filename, buffer, next) =>
         describeIt('should getattr on file', done => {
             mnt.getattr(object, (err, obj_attrs) => {
@@ -178,6 +730,25 @@ async.waterfall([
                 done(next, null);
             });
         }),
+    next =>
+        describeIt('should remove a whole tree', done => {
+            const name = 'tree_' + crypto.randomBytes(8).toString('hex');
+            const file = (dir, cb) => mnt.create(dir, 'file',
+                                                 mnt.CREATE_GUARDED,
+                                                 { mode: 0o644 }, cb);
+            async.waterfall([
+                cb => mnt.mkdir(root_fh, name, { mode: 0o755 }, cb),
+                (top, attrs, wcc, cb) =>
+                    file(top, () => mnt.mkdir(top, 'sub', { mode: 0o755 },
+                                              cb)),
+                (sub, attrs, wcc, cb) => file(sub, () => cb()),
+                cb => mnt.removeTree(root_fh, name, { concurrency: 4 }, cb),
+            ], (err, removed) => {
+                assert.ifError(err);
+                assert.deepStrictEqual(removed, { files: 2, directories: 2 });
+                done(next, null);
+            });
+        }),
     next =>
         describeIt('should create a named pipe', done => {
             var name = 'bar_' + crypto.randomBytes(8).toString('hex');